@@ -0,0 +1,214 @@
+#include "EquityCalculator.h"
+#include "FlopEquity.h"
+#include "HandFeatures.h"
+#include "PreflopEquity.h"
+#include "RangeEquityCalculator.h"
+#include "RiverRanks.h"
+#include "RiverSolver.h"
+#include "TaskScheduler.h"
+#include "AllCards.h"
+
+#include <atomic>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+namespace poker {
+
+void BM_equity_heads_up_preflop(benchmark::State& state) {
+    EquityCalculator calc( { HoleCards(_AC, _KC), HoleCards(_QH, _QS) });
+    calc.setThreads(state.range(0));
+    calc.setMaxTrials(100000);
+    uint64_t trials = 0;
+    for (auto _ : state) {
+        EquityResult result = calc.calculate();
+        trials += result.trials;
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(trials);
+}
+BENCHMARK(BM_equity_heads_up_preflop)->RangeMultiplier(2)->Range(1, 8)
+        ->UseRealTime();
+
+// A default calculation of one million trials, on one thread. Chunks start
+// their own substreams, which must cost next to nothing against the trials.
+void BM_equity_calculate(benchmark::State& state) {
+    EquityCalculator calc( { HoleCards(_AC, _KC), HoleCards(_QH, _QS) },
+            CardSet( { _3D, _9D, _TC }));
+    calc.setThreads(1);
+    calc.setMaxTrials(EquityCalculator::DEFAULT_MAX_TRIALS);
+    uint64_t trials = 0;
+    for (auto _ : state) {
+        EquityResult result = calc.calculate();
+        trials += result.trials;
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(trials);
+}
+BENCHMARK(BM_equity_calculate)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Exact preflop equities from the table, AKs and QQ against AcKc.
+void BM_equity_preflop_lookup(benchmark::State& state) {
+    static const PreflopEquity equity(
+            PreflopEquity::generate( { 1, 28 }));
+    HoleCards hero(_AC, _KC);
+    std::vector<HoleCards> villains;
+    for (size_t c = 0; c < Range::COMBOS; ++c) {
+        HoleCards villain = Range::combo(c);
+        uint32_t hand_class = PreflopEquity::handClass(villain);
+        if ((hand_class == 1 || hand_class == 28)
+                && !(villain.toCardSet().cardBits()
+                        & hero.toCardSet().cardBits())) {
+            villains.push_back(villain);
+        }
+    }
+    for (auto _ : state) {
+        for (const HoleCards& villain : villains) {
+            benchmark::DoNotOptimize(equity.lookup(hero, villain));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * villains.size());
+}
+BENCHMARK(BM_equity_preflop_lookup);
+
+void BM_equity_full_table_flop(benchmark::State& state) {
+    EquityCalculator calc( { HoleCards(_AC, _KC), HoleCards(_QH, _QS),
+            HoleCards(_7D, _8D), HoleCards(_2C, _2S), HoleCards(_JH, _TH),
+            HoleCards(_AD, _5S), HoleCards(_KS, _9C), HoleCards(_4H, _6H) },
+            CardSet( { _3D, _9D, _TC }));
+    calc.setMaxTrials(100000);
+    uint64_t trials = 0;
+    for (auto _ : state) {
+        EquityResult result = calc.calculate();
+        trials += result.trials;
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(trials);
+}
+BENCHMARK(BM_equity_full_table_flop)->UseRealTime();
+
+// Small turn enumerations: 0 on threads started per request, 1 on a shared
+// scheduler, 2 on a shared scheduler busy with preflop enumerations.
+void BM_equity_turn_enumerate(benchmark::State& state) {
+    EquityCalculator calc( { HoleCards(_AS, _KS), HoleCards(_QH, _QD) },
+            CardSet( { _2S, _7S, _QC, _3H }));
+    TaskScheduler scheduler;
+    if (state.range(0) > 0) {
+        calc.setScheduler(&scheduler);
+    }
+    std::atomic<bool> stop { false };
+    std::thread background([&]() {
+        EquityCalculator preflop( { HoleCards(_AC, _AD), HoleCards(_KH,
+                _KS) });
+        preflop.setScheduler(&scheduler);
+        while (state.range(0) == 2 && !stop.load()) {
+            benchmark::DoNotOptimize(preflop.enumerate());
+        }
+    });
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(calc.enumerate());
+    }
+    stop.store(true);
+    background.join();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_equity_turn_enumerate)->DenseRange(0, 2)->UseRealTime();
+
+void BM_range_equity_flop_enumerate(benchmark::State& state) {
+    RangeEquityCalculator calc( { Range::parse("QQ+, AKs, AQs, KQs"),
+            Range::parse("TT-JJ, AQo, KJs+, 98s") },
+            CardSet( { _3D, _9D, _TC }));
+    uint64_t matchups = 0;
+    for (auto _ : state) {
+        EquityResult result = calc.enumerate();
+        matchups += result.trials;
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(matchups);
+}
+BENCHMARK(BM_range_equity_flop_enumerate)->UseRealTime();
+
+// A hand against a range on the flop, 0 by RangeEquityCalculator and 1 from
+// the flop table.
+void BM_equity_hand_vs_range_flop(benchmark::State& state) {
+    CardSet flop( { _3D, _9D, _TC });
+    HoleCards hand(_AD, _KD);
+    Range single;
+    single.setWeight(hand, 1);
+    Range range = Range::parse("TT-JJ, AQo, KJs+, 98s, 77:0.5");
+    RangeEquityCalculator calc( { single, range }, flop);
+    FlopEquity table(flop, FlopEquity::generate(flop));
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            benchmark::DoNotOptimize(calc.enumerate());
+        } else {
+            benchmark::DoNotOptimize(table.equity(hand, range));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_equity_hand_vs_range_flop)->DenseRange(0, 1)->UseRealTime();
+
+// Wide ranges on the river, 0 by RangeEquityCalculator and 1 by the sweep
+// over the sorted combinations, including the ranking.
+void BM_range_equity_river(benchmark::State& state) {
+    CardSet board( { _3D, _9D, _TC, _KS, _4H });
+    Range first = Range::parse("22+, A2s+, K9s+, QTs+, JTs, ATo+, KJo+");
+    Range second = Range::parse("55+, A9s+, KTs+, QJs, AJo+, KQo, 98s, 87s");
+    RangeEquityCalculator calc( { first, second }, board);
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            benchmark::DoNotOptimize(calc.enumerate());
+        } else {
+            benchmark::DoNotOptimize(RiverRanks(board).equity(first, second));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_range_equity_river)->DenseRange(0, 1)->UseRealTime();
+
+// CFR+ iterations of a river subgame with two bet sizes, all-in and a raise.
+void BM_river_solver(benchmark::State& state) {
+    CardSet board( { _3D, _9D, _TC, _KS, _4H });
+    RiverSolver::Config config;
+    config.stack = 2;
+    RiverSolver solver(board,
+            Range::parse("22+, A2s+, K9s+, QTs+, JTs, ATo+, KJo+, 76s"),
+            Range::parse("55+, A9s+, KTs+, QJs, AJo+, KQo, 98s, 87s"), config);
+    for (auto _ : state) {
+        solver.solve(1);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_river_solver);
+
+// EHS, EHS² and potentials of all hands on a flop, exactly over the runouts
+// (0) and on a turn (1).
+void BM_hand_features(benchmark::State& state) {
+    CardSet board( { _3D, _9D, _TC });
+    if (state.range(0) == 1) {
+        board.add(_KS);
+    }
+    TaskScheduler scheduler;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(HandFeatures::compute(board, &scheduler));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_hand_features)->DenseRange(0, 1)->UseRealTime();
+
+void BM_range_equity_preflop(benchmark::State& state) {
+    RangeEquityCalculator calc( { Range::parse("QQ+, AKs, AQs, KQs"),
+            Range::parse("TT-JJ, AQo, KJs+, 98s"), Range::parse("22+") });
+    calc.setMaxTrials(100000);
+    uint64_t trials = 0;
+    for (auto _ : state) {
+        EquityResult result = calc.calculate();
+        trials += result.trials;
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(trials);
+}
+BENCHMARK(BM_range_equity_preflop)->UseRealTime();
+
+}
@@ -1,8 +1,23 @@
 #include "CardSet.h"
+#include "CpuDispatch.h"
+#include "BoardEnumerator.h"
+#include "EquityCalculator.h"
+#include "HandRankIndex.h"
+#include "IncrementalEvaluator.h"
+#include "Numa.h"
+#include "OmahaBoard.h"
+#include "RankTables.h"
+#include "RiverRanks.h"
+#include "Showdown.h"
+#include "TableFile.h"
+#include "TaskScheduler.h"
 
 #include <benchmark/benchmark.h>
 #include <memory>
+#include <stdlib.h>
 #include <string.h>
+#include <thread>
+#include <unistd.h>
 #include <iostream>
 #include <algorithm>
 
@@ -82,6 +97,47 @@ void BM_fast_deck_deal(benchmark::State& state) {
 }
 BENCHMARK(BM_fast_deck_deal);
 
+void BM_fast_deck_deal_n(benchmark::State& state) {
+    FastDeck deck;
+    Card cards[8 * 2 + 5];
+    for (auto _ : state) {
+        deck.shuffle();
+        deck.dealN(cards, 8 * 2 + 5);
+        benchmark::DoNotOptimize(cards);
+    }
+}
+BENCHMARK(BM_fast_deck_deal_n);
+
+void BM_philox_deck_deal_n(benchmark::State& state) {
+    PhiloxDeck deck;
+    Card cards[8 * 2 + 5];
+    for (auto _ : state) {
+        deck.shuffle();
+        deck.dealN(cards, 8 * 2 + 5);
+        benchmark::DoNotOptimize(cards);
+    }
+}
+BENCHMARK(BM_philox_deck_deal_n);
+
+// Positioning a deck on substream k: a pass over the SFMT state per set bit
+// of k (0) against a counter (1).
+void BM_deck_split(benchmark::State& state) {
+    bool philox = state.range(0) != 0;
+    state.SetLabel(philox ? "philox" : "sfmt");
+    FastDeck fast_deck;
+    PhiloxDeck philox_deck;
+    uint64_t k = 0;
+    for (auto _ : state) {
+        ++k;
+        if (philox) {
+            benchmark::DoNotOptimize(philox_deck.split(k));
+        } else {
+            benchmark::DoNotOptimize(fast_deck.split(k));
+        }
+    }
+}
+BENCHMARK(BM_deck_split)->DenseRange(0, 1)->Unit(benchmark::kMicrosecond);
+
 void BM_deal_full_table_th(benchmark::State& state) {
     FastDeck deck;
     for (auto _ : state) {
@@ -133,16 +189,20 @@ void BM_deal_and_rank_full_table_th(benchmark::State& state) {
     RankTable rt;
     for (auto _ : state) {
         deck.shuffle();
+        Card board[5];
+        deck.dealN(board, 5);
         CardSet table;
         for (int i = 0; i < 5; ++i) {
-            table.add(deck.deal());
+            table.add(board[i]);
         }
 
+        HoleCards holes[8];
+        deck.dealHands(holes, 8);
         CardSet player[8];
         for (int i = 0; i < 8; ++i) {
             player[i].addAll(table);
-            player[i].add(deck.deal());
-            player[i].add(deck.deal());
+            player[i].add(holes[i].getFirst());
+            player[i].add(holes[i].getSecond());
         }
         for (int i = 0; i < 8; ++i) {
             benchmark::DoNotOptimize(player[i].rankTexasHoldem());
@@ -153,101 +213,268 @@ void BM_deal_and_rank_full_table_th(benchmark::State& state) {
 }
 BENCHMARK(BM_deal_and_rank_full_table_th);
 
-#define min(x, y) (x<y?x:y)
-#define max(x, y) (x<y?y:x)
-#define SWAP(x,y) {  HandRanking a = min(d[x], d[y]); \
-        HandRanking b = max(d[x], d[y]); d[x] = a; d[y] = b;}
-
-void sort8(HandRanking d[8]) {
-    SWAP(0, 1);
-    SWAP(2, 3);
-    SWAP(0, 2);
-    SWAP(1, 3);
-    SWAP(1, 2);
-    SWAP(4, 5);
-    SWAP(6, 7);
-    SWAP(4, 6);
-    SWAP(5, 7);
-    SWAP(5, 6);
-    SWAP(0, 4);
-    SWAP(1, 5);
-    SWAP(1, 4);
-    SWAP(2, 6);
-    SWAP(3, 7);
-    SWAP(3, 6);
-    SWAP(2, 4);
-    SWAP(3, 5);
-    SWAP(3, 4);
+void BM_showdown_full_table_th(benchmark::State& state) {
+    FastDeck deck;
+    for (auto _ : state) {
+        deck.shuffle();
+        CardSet table;
+        for (int i = 0; i < 5; ++i) {
+            table.add(deck.deal());
+        }
+
+        HoleCards players[8];
+        deck.dealHands(players, 8);
+        uint32_t winners = Showdown::resolve(table, players, 8);
+        benchmark::DoNotOptimize(winners);
+    }
 }
+BENCHMARK(BM_showdown_full_table_th);
 
-template<typename RandIt>
-void insertion_sort(RandIt begin, RandIt end)
-{
-    for (auto i = begin + 1; i != end; ++i)
-    {
-        auto key = *i;
-        auto j = i - 1;
+void BM_rank_full_table_th(benchmark::State& state) {
+    constexpr int tables = 100;
+
+    FastDeck deck;
+    RankTable rt;
+    std::unique_ptr<CardSet[]> hands(new CardSet[8 * tables]);
+
+    for (int t = 0; t < tables; ++t) {
+        deck.shuffle();
+        CardSet table;
+        for (int i = 0; i < 5; ++i) {
+            table.add(deck.deal());
+        }
+
+        CardSet* player = &hands[8 * t];
+        for (int i = 0; i < 8; ++i) {
+            player[i].addAll(table);
+            player[i].add(deck.deal());
+            player[i].add(deck.deal());
+        }
+    }
 
-        while (j >= begin and *j > key)
-        {
-            *(j + 1) = *j;
-            --j;
+    for (auto _ : state) {
+        for (int i = 0; i < 8 * tables; ++i) {
+            HandRanking r = hands[i].rankTexasHoldem();
+            benchmark::DoNotOptimize(r);
+            //rt.add(r);
+            //std::cout << "r = " << r.getRanking() << std::endl;
         }
+    }
+    //rt.print();
+}
+BENCHMARK(BM_rank_full_table_th);
+
+// Flop, turn and river hands with rank<N>().
+void BM_rank_n(benchmark::State& state) {
+    constexpr int hands = 800;
+    const int n = state.range(0);
 
-        *(j + 1) = key;
+    FastDeck deck;
+    std::unique_ptr<CardSet[]> sets(new CardSet[hands]);
+    for (int i = 0; i < hands; ++i) {
+        deck.shuffle();
+        for (int c = 0; c < n; ++c) {
+            sets[i].add(deck.deal());
+        }
+    }
+
+    for (auto _ : state) {
+        for (int i = 0; i < hands; ++i) {
+            HandRanking r = n == 5 ? sets[i].rank<5>() :
+                    n == 6 ? sets[i].rank<6>() : sets[i].rank<7>();
+            benchmark::DoNotOptimize(r);
+        }
     }
+    state.SetItemsProcessed(state.iterations() * hands);
 }
+BENCHMARK(BM_rank_n)->DenseRange(5, 7);
+
+// Short deck hands one by one (0) and in a batch (1).
+void BM_rank_short_deck(benchmark::State& state) {
+    constexpr int hands = 800;
+
+    FastDeck deck = FastDeck::shortDeck();
+    std::unique_ptr<CardSet[]> sets(new CardSet[hands]);
+    std::unique_ptr<ShortDeckRanking[]> ranks(new ShortDeckRanking[hands]);
+    for (int i = 0; i < hands; ++i) {
+        deck.shuffle();
+        for (int c = 0; c < 7; ++c) {
+            sets[i].add(deck.deal());
+        }
+    }
+
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            for (int i = 0; i < hands; ++i) {
+                ShortDeckRanking r = sets[i].rankShortDeck();
+                benchmark::DoNotOptimize(r);
+            }
+        } else {
+            CardSet::rankShortDeckBatch(sets.get(), ranks.get(), hands);
+            benchmark::DoNotOptimize(ranks[hands - 1]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * hands);
+}
+BENCHMARK(BM_rank_short_deck)->DenseRange(0, 1);
+
+// A-5 lows of seven cards (0) and 2-7 lows of five (1).
+void BM_rank_low(benchmark::State& state) {
+    constexpr int hands = 800;
+    const int n = state.range(0) == 0 ? 7 : 5;
 
-void BM_rank_sort_full_table_th(benchmark::State& state) {
     FastDeck deck;
-    RankTable rt;
+    std::unique_ptr<CardSet[]> sets(new CardSet[hands]);
+    for (int i = 0; i < hands; ++i) {
+        deck.shuffle();
+        for (int c = 0; c < n; ++c) {
+            sets[i].add(deck.deal());
+        }
+    }
+
     for (auto _ : state) {
+        for (int i = 0; i < hands; ++i) {
+            LowRanking r = state.range(0) == 0 ? sets[i].rankLowA5() :
+                    sets[i].rankLow27();
+            benchmark::DoNotOptimize(r);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * hands);
+}
+BENCHMARK(BM_rank_low)->DenseRange(0, 1);
+
+void BM_rank_batch_full_table_th(benchmark::State& state) {
+    constexpr int tables = 100;
+
+    SimdLevel previous = getSimdLevel();
+    SimdLevel level = static_cast<SimdLevel>(state.range(0));
+    if (level > detectSimdLevel()) {
+        state.SkipWithError(("No " + toString(level) + " support").c_str());
+        return;
+    }
+    setSimdLevel(level);
+    state.SetLabel(toString(level));
+
+    FastDeck deck;
+    std::unique_ptr<CardSet[]> hands(new CardSet[8 * tables]);
+    std::unique_ptr<HandRanking[]> ranks(new HandRanking[8 * tables]);
+
+    for (int t = 0; t < tables; ++t) {
         deck.shuffle();
         CardSet table;
         for (int i = 0; i < 5; ++i) {
             table.add(deck.deal());
         }
 
-        CardSet player[8];
+        CardSet* player = &hands[8 * t];
         for (int i = 0; i < 8; ++i) {
             player[i].addAll(table);
             player[i].add(deck.deal());
             player[i].add(deck.deal());
         }
+    }
 
-        HandRanking rank[8];
-        for (int i = 0; i < 8; ++i) {
-            rank[i] = player[i].rankTexasHoldem();
+    for (auto _ : state) {
+        CardSet::rankTexasHoldemBatch(hands.get(), ranks.get(), 8 * tables);
+        benchmark::DoNotOptimize(ranks[8 * tables - 1]);
+    }
+    setSimdLevel(previous);
+}
+BENCHMARK(BM_rank_batch_full_table_th)->DenseRange(
+        static_cast<int>(SimdLevel::SSE2), static_cast<int>(SimdLevel::AVX512));
+
+// Converts 800 seven card rankings to their 16-bit index (0) or back (1).
+void BM_hand_rank_index(benchmark::State& state) {
+    constexpr int hands = 800;
+    FastDeck deck;
+    std::unique_ptr<HandRanking[]> ranks(new HandRanking[hands]);
+    std::unique_ptr<HandRankIndex[]> indexes(new HandRankIndex[hands]);
+    for (int i = 0; i < hands; ++i) {
+        deck.shuffle();
+        Card cards[7];
+        deck.dealN(cards, 7);
+        ranks[i] = CardSet(cards).rankTexasHoldem();
+    }
+    HandRankIndex::fromHandRankings(ranks.get(), indexes.get(), hands);
+
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            HandRankIndex::fromHandRankings(ranks.get(), indexes.get(),
+                    hands);
+            benchmark::DoNotOptimize(indexes[hands - 1]);
+        } else {
+            HandRankIndex::toHandRankings(indexes.get(), ranks.get(), hands);
+            benchmark::DoNotOptimize(ranks[hands - 1]);
         }
-        /*for (int i = 1; i < 8; ++i) {
-            HandRanking r = rank[i];
-            std::sort(r)
-            int j = 0;
-            while (j < i && rank[j] < r) {
-                j++;
-            }
-            std::swap(rank[i], rank[j]);
-        }*/
-        //insertion_sort(rank, rank+8);
-        sort8(rank);
-        //std::sort(rank, rank+8);
-/*        for(int i= 0; i<7; ++i) {
-            if (rank[i] > rank[i+1]) {
-                throw new std::runtime_error("invalid sorting");
+    }
+    state.SetItemsProcessed(state.iterations() * hands);
+}
+BENCHMARK(BM_hand_rank_index)->DenseRange(0, 1);
+
+// Omaha on the river with 4, 5 and 6 hole cards, by ranking the five card
+// hands one by one (0), with OmahaBoard (1) and Omaha Hi-Lo (2).
+void BM_omaha(benchmark::State& state) {
+    constexpr int hands = 100;
+    const uint32_t hole_size = state.range(0);
+
+    FastDeck deck;
+    std::vector<std::vector<Card>> boards(hands);
+    std::vector<std::vector<Card>> holes(hands);
+    for (int i = 0; i < hands; ++i) {
+        deck.shuffle();
+        boards[i].resize(5);
+        holes[i].resize(hole_size);
+        deck.dealN(boards[i].data(), 5);
+        deck.dealN(holes[i].data(), hole_size);
+    }
+
+    for (auto _ : state) {
+        for (int i = 0; i < hands; ++i) {
+            const std::vector<Card>& b = boards[i];
+            const std::vector<Card>& h = holes[i];
+            HandRanking best;
+            if (state.range(1) == 0) {
+                for (int j = 0; j < 5; ++j) {
+                    for (int k = j + 1; k < 5; ++k) {
+                        for (int l = k + 1; l < 5; ++l) {
+                            IncrementalEvaluator three(
+                                    CardSet( { b[j], b[k], b[l] }));
+                            for (size_t m = 0; m < h.size(); ++m) {
+                                three.push(h[m]);
+                                for (size_t n = m + 1; n < h.size(); ++n) {
+                                    best = std::max(best,
+                                            three.rankWith(h[n]));
+                                }
+                                three.pop();
+                            }
+                        }
+                    }
+                }
+            } else if (state.range(1) == 1) {
+                best = rankOmaha(CardSet(h), CardSet(b));
+            } else {
+                HiLoRanking hand = rankOmahaHiLo(CardSet(h), CardSet(b));
+                benchmark::DoNotOptimize(hand.low);
+                best = hand.high;
             }
-        }*/
-        benchmark::DoNotOptimize(rank[0]);
+            benchmark::DoNotOptimize(best);
+        }
     }
-    //rt.print();
+    state.SetItemsProcessed(state.iterations() * hands);
 }
-BENCHMARK(BM_rank_sort_full_table_th);
+BENCHMARK(BM_omaha)->ArgsProduct( { { 4, 5, 6 }, { 0, 1, 2 } });
 
-void BM_rank_full_table_th(benchmark::State& state) {
+void BM_rank_backend_full_table_th(benchmark::State& state) {
     constexpr int tables = 100;
 
+    RankBackend previous = getRankBackend();
+    RankBackend backend = static_cast<RankBackend>(state.range(0));
+    setRankBackend(backend);
+    state.SetLabel(toString(backend));
+
     FastDeck deck;
-    RankTable rt;
     std::unique_ptr<CardSet[]> hands(new CardSet[8 * tables]);
+    std::unique_ptr<HandRanking[]> ranks(new HandRanking[8 * tables]);
 
     for (int t = 0; t < tables; ++t) {
         deck.shuffle();
@@ -265,16 +492,206 @@ void BM_rank_full_table_th(benchmark::State& state) {
     }
 
     for (auto _ : state) {
-        for (int i = 0; i < 8 * tables; ++i) {
-            HandRanking r = hands[i].rankTexasHoldem();
-            benchmark::DoNotOptimize(r);
-            //rt.add(r);
-            //std::cout << "r = " << r.getRanking() << std::endl;
+        CardSet::rankTexasHoldemBatch(hands.get(), ranks.get(), 8 * tables);
+        benchmark::DoNotOptimize(ranks[8 * tables - 1]);
+    }
+    state.SetItemsProcessed(state.iterations() * 8 * tables);
+    setRankBackend(previous);
+}
+BENCHMARK(BM_rank_backend_full_table_th)->DenseRange(
+        static_cast<int>(RankBackend::COMPUTED),
+        static_cast<int>(RankBackend::TABLE));
+
+// Scaling of the table backend over NUMA pinned workers, on shared tables
+// (0) or on a copy per node (1). Replication lasts for the process, so the
+// shared runs come first.
+void BM_rank_backend_numa(benchmark::State& state) {
+    constexpr int hands_per_task = 8 * 100;
+    constexpr int tasks_per_thread = 64;
+
+    RankBackend previous = getRankBackend();
+    if (state.range(0)) {
+        replicateRankTables();
+    }
+    setRankBackend(RankBackend::TABLE);
+    uint32_t threads = state.range(1);
+    TaskScheduler scheduler(threads, true);
+    state.SetLabel(std::string(state.range(0) ? "replicated" : "shared")
+            + ", " + std::to_string(getNumaNodeCount()) + " nodes");
+
+    FastDeck deck;
+    std::vector<CardSet> hands(hands_per_task);
+    for (CardSet& hand : hands) {
+        deck.shuffle();
+        Card cards[7];
+        deck.dealN(cards, 7);
+        hand = CardSet(cards);
+    }
+
+    for (auto _ : state) {
+        scheduler.parallelFor(0, threads * tasks_per_thread, 1,
+                [&](uint64_t, uint64_t, ScratchArena& arena) {
+            HandRanking* ranks = arena.allocate<HandRanking>(hands.size());
+            CardSet::rankTexasHoldemBatch(hands.data(), ranks, hands.size());
+            benchmark::DoNotOptimize(ranks[hands.size() - 1]);
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * threads * tasks_per_thread
+            * hands_per_task);
+    setRankBackend(previous);
+}
+BENCHMARK(BM_rank_backend_numa)->ArgsProduct( { { 0, 1 },
+        benchmark::CreateRange(1,
+                std::max(1u, std::thread::hardware_concurrency()), 2) })
+        ->UseRealTime();
+
+// Start-up cost of the rank tables: generated in memory (0) or mapped from a
+// table file written before the loop (1), in the table directory if one is
+// set ($POKER_TABLE_DIR) and else in a temporary one removed afterwards.
+void BM_load_rank_tables(benchmark::State& state) {
+    std::string previous = getTableDirectory();
+    bool mapped = state.range(0) != 0;
+    std::string dir;
+    bool temporary = mapped && previous.empty();
+    if (temporary) {
+        char path[] = "/tmp/rank_tables_benchXXXXXX";
+        if (!mkdtemp(path)) {
+            state.SkipWithError("Cannot create a temporary directory");
+            return;
         }
+        dir = path;
+    } else if (mapped) {
+        dir = previous;
+    }
+    setTableDirectory(dir);
+    state.SetLabel(mapped ? "mapped" : "generated");
+    {
+        // Writes the table file.
+        detail::RankTables tables(detail::rankKernels().rankTexasHoldem);
+    }
+    for (auto _ : state) {
+        detail::RankTables tables(detail::rankKernels().rankTexasHoldem);
+        benchmark::DoNotOptimize(tables.getClassCount());
+    }
+    setTableDirectory(previous);
+    if (temporary) {
+        unlink((dir + "/rank_tables.tbl").c_str());
+        rmdir(dir.c_str());
     }
-    //rt.print();
 }
-BENCHMARK(BM_rank_full_table_th);
+BENCHMARK(BM_load_rank_tables)->DenseRange(0, 1)->Unit(
+        benchmark::kMicrosecond);
+
+// All turn and river cards for one hand on the flop: rebuilding every seven
+// card set and ranking it (0) against the incremental evaluator (1).
+void BM_runouts_th(benchmark::State& state) {
+    bool incremental = state.range(0) != 0;
+    state.SetLabel(incremental ? "incremental" : "rebuild");
+    CardSet hole( { Card(Rank::A, Color::SPADES),
+            Card(Rank::K, Color::SPADES) });
+    CardSet flop( { Card(Rank::_2, Color::CLUBS), Card(Rank::_7, Color::SPADES),
+            Card(Rank::Q, Color::HEARTS) });
+    CardSet known = hole;
+    known.addAll(flop);
+    std::vector<Card> deck;
+    for (uint8_t c = 0; c < 4; ++c) {
+        for (uint8_t r = 0; r < 13; ++r) {
+            Card card(static_cast<Rank>(r), static_cast<Color>(c));
+            if (!known.contains(card)) {
+                deck.push_back(card);
+            }
+        }
+    }
+
+    IncrementalEvaluator evaluator(known);
+    std::vector<Card> rivers;
+    std::vector<HandRanking> rankings;
+    for (auto _ : state) {
+        HandRanking best;
+        for (size_t t = 0; t < deck.size(); ++t) {
+            if (incremental) {
+                evaluator.push(deck[t]);
+                evaluator.rankWithRemaining(CardSet(), rivers, rankings);
+                HandRanking ranking = *std::max_element(rankings.begin(),
+                        rankings.end());
+                best = std::max(best, ranking);
+                evaluator.pop();
+                continue;
+            }
+            for (size_t r = 0; r < deck.size(); ++r) {
+                if (r == t) {
+                    continue;
+                }
+                CardSet hand;
+                hand.addAll(flop);
+                hand.addAll(hole);
+                hand.add(deck[t]);
+                hand.add(deck[r]);
+                HandRanking ranking = hand.rankTexasHoldem();
+                best = std::max(best, ranking);
+            }
+        }
+        benchmark::DoNotOptimize(best);
+    }
+    state.SetItemsProcessed(state.iterations() * 47 * 46);
+}
+BENCHMARK(BM_runouts_th)->DenseRange(0, 1);
+
+void BM_canonicalize_th(benchmark::State& state) {
+    FastDeck deck;
+    std::vector<CardSet> hands(800);
+    for (CardSet& hand : hands) {
+        deck.shuffle();
+        for (int i = 0; i < 7; ++i) {
+            hand.add(deck.deal());
+        }
+    }
+    for (auto _ : state) {
+        for (const CardSet& hand : hands) {
+            benchmark::DoNotOptimize(hand.canonicalize());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * hands.size());
+}
+BENCHMARK(BM_canonicalize_th);
+
+void BM_rank_all_combos_th(benchmark::State& state) {
+    CardSet board( { _3D, _9D, _QC, _KS, _4H });
+    for (auto _ : state) {
+        RiverRanks ranks(board);
+        benchmark::DoNotOptimize(ranks.getGroups().data());
+    }
+    state.SetItemsProcessed(state.iterations() * RiverRanks::COMBOS);
+}
+BENCHMARK(BM_rank_all_combos_th);
+
+void BM_enumerate_boards_th(benchmark::State& state) {
+    CardSet hole( { _AC, _AD, _KH, _KS });
+    BoardEnumerator boards(CardSet(), hole, 5);
+    for (auto _ : state) {
+        boards.forEach([](const CardSet& board) {
+            benchmark::DoNotOptimize(board);
+        });
+    }
+    state.SetItemsProcessed(state.iterations() * boards.size());
+    state.SetLabel("boards");
+}
+BENCHMARK(BM_enumerate_boards_th)->Unit(benchmark::kMillisecond);
+
+void BM_enumerate_rank_heads_up_th(benchmark::State& state) {
+    EquityCalculator calc( { HoleCards(_AC, _AD), HoleCards(_KH, _KS) });
+    calc.setThreads(state.range(0));
+    uint64_t boards = 0;
+    for (auto _ : state) {
+        EquityResult result = calc.enumerate();
+        boards += result.trials;
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(boards);
+    state.SetLabel("boards");
+}
+BENCHMARK(BM_enumerate_rank_heads_up_th)->RangeMultiplier(2)->Range(1, 8)
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
 
 void BM_rank_th_high_card(benchmark::State& state) {
     CardSet cards = CardSet( { _2H, _4H, _6D, _7D, _8H, _9S, _JC });
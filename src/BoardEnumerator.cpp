@@ -0,0 +1,52 @@
+#include "BoardEnumerator.h"
+
+#include <stdexcept>
+
+namespace poker {
+
+BoardEnumerator::BoardEnumerator(const CardSet& board,
+        const CardSet& excluded, uint32_t count) :
+        board(board), count(count) {
+    if (count > MAX_CARDS) {
+        throw new std::runtime_error(
+                "Too many cards to enumerate: " + std::to_string(count));
+    }
+    for (uint8_t c = 0; c < 4; ++c) {
+        for (uint8_t r = 0; r < 13; ++r) {
+            Card card(static_cast<Rank>(r), static_cast<Color>(c));
+            if (!excluded.contains(card)) {
+                cards.push_back(card);
+            }
+        }
+    }
+}
+
+uint64_t BoardEnumerator::binomial(uint32_t n, uint32_t k) {
+    if (k > n) {
+        return 0;
+    }
+    uint64_t result = 1;
+    for (uint32_t i = 1; i <= k; ++i) {
+        // Exact, as the product of i consecutive numbers is divisible by i!.
+        result = result * (n - k + i) / i;
+    }
+    return result;
+}
+
+void BoardEnumerator::unrank(uint64_t index, uint32_t* positions) const {
+    const uint32_t n = cards.size();
+    uint32_t position = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        // Skip all combinations that start with a smaller position here.
+        for (;; ++position) {
+            uint64_t skipped = binomial(n - 1 - position, count - 1 - i);
+            if (index < skipped) {
+                break;
+            }
+            index -= skipped;
+        }
+        positions[i] = position++;
+    }
+}
+
+} /* namespace poker */
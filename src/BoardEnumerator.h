@@ -0,0 +1,94 @@
+#ifndef BOARDENUMERATOR_H_
+#define BOARDENUMERATOR_H_
+
+#include "CardSet.h"
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace poker {
+
+// Enumerates all ways to complete a partial board with the remaining cards.
+//
+// The combinations are numbered in lexicographic order of the remaining deck
+// positions, so any index range can be unranked and walked on its own, e.g.
+// to split the enumeration evenly over threads. While walking, the card sets
+// for the leading cards of a combination are kept per depth, so moving to the
+// next board only adds the cards that changed.
+class BoardEnumerator {
+public:
+    constexpr static uint32_t MAX_CARDS = 5;
+
+    // Adds count cards not in excluded to board. The board itself must be
+    // part of excluded.
+    BoardEnumerator(const CardSet& board, const CardSet& excluded,
+            uint32_t count);
+
+    // Number of combinations.
+    uint64_t size() const {
+        return binomial(cards.size(), count);
+    }
+
+    // Calls f(const CardSet&) for every completed board with index in
+    // [begin, end).
+    template<typename F>
+    void forEach(uint64_t begin, uint64_t end, F f) const;
+
+    template<typename F>
+    void forEach(F f) const {
+        forEach(0, size(), f);
+    }
+
+    static uint64_t binomial(uint32_t n, uint32_t k);
+
+private:
+    void unrank(uint64_t index, uint32_t* positions) const;
+
+    CardSet board;
+    std::vector<Card> cards;
+    uint32_t count;
+};
+
+template<typename F>
+void BoardEnumerator::forEach(uint64_t begin, uint64_t end, F f) const {
+    if (begin >= end) {
+        return;
+    }
+    const uint32_t n = cards.size();
+    uint32_t positions[MAX_CARDS];
+    unrank(begin, positions);
+
+    // partial[i] holds the board plus the first i chosen cards.
+    CardSet partial[MAX_CARDS + 1];
+    partial[0] = board;
+    for (uint32_t i = 0; i < count; ++i) {
+        partial[i + 1] = partial[i];
+        partial[i + 1].add(cards[positions[i]]);
+    }
+
+    for (uint64_t index = begin;;) {
+        f(static_cast<const CardSet&>(partial[count]));
+        if (++index == end) {
+            return;
+        }
+        // Advance the rightmost position that can still move and reset
+        // those behind it; only their partial sets need to be rebuilt.
+        uint32_t i = count - 1;
+        while (positions[i] == n - count + i) {
+            --i;
+        }
+        positions[i]++;
+        for (uint32_t j = i + 1; j < count; ++j) {
+            positions[j] = positions[j - 1] + 1;
+        }
+        for (uint32_t j = i; j < count; ++j) {
+            partial[j + 1] = partial[j];
+            partial[j + 1].add(cards[positions[j]]);
+        }
+    }
+}
+
+} /* namespace poker */
+
+#endif /* BOARDENUMERATOR_H_ */
@@ -1,6 +1,9 @@
 #include "CardSet.h"
 #include "AllCards.h"
+#include "CpuDispatch.h"
+#include "TableFile.h"
 
+#include <algorithm>
 #include <iostream>
 #include <string.h>
 
@@ -61,233 +64,347 @@ std::string Card::toString() const {
 }
 
 std::vector<Card> CardSet::toCardVector() const {
-    // TODO this could be optimized more
-    std::vector<Card> result;
-    for (uint8_t c = 0; c < 4; ++c) {
-        for (uint8_t r = 0; r < 13; ++r) {
-            Card card(static_cast<Rank>(r), static_cast<Color>(c));
-            if (contains(card)) {
-                result.push_back(card);
-            }
-        }
+    Card cards[Card::COUNT];
+    return std::vector<Card>(cards, cards + toCards(cards));
+}
+
+std::string CardSet::toString() const {
+    Card cards[Card::COUNT];
+    size_t n = toCards(cards);
+    std::string result;
+    result.reserve(2 * n);
+    for (size_t i = 0; i < n; ++i) {
+        result += cards[i].toString();
     }
     return result;
 }
 
-namespace {
+size_t CardSet::toCards(uint64_t card_bits, Card* out) {
+    size_t n = 0;
+    while (card_bits) {
+        // Bit 16 * color + rank + 1, one above the card value.
+        uint32_t bit = __builtin_ctzll(card_bits);
+        out[n++] = Card(static_cast<Rank>((bit & 15) - 1),
+                static_cast<Color>(bit >> 4));
+        card_bits &= card_bits - 1;
+    }
+    return n;
+}
 
-template<typename T>
-T unlikely(T t) {
-    return __builtin_expect(t, 0);
+HandRanking CardSet::rankTexasHoldem() const {
+    return rank<7>();
 }
 
-template<typename T>
-T likely(T t) {
-    return __builtin_expect(t, 1);
+void CardSet::rankTexasHoldemBatch(const CardSet* in, HandRanking* out,
+        size_t n) {
+    rankBatch<7>(in, out, n);
 }
 
-bool multiple_bits_set(uint32_t v) {
-    return v & (v - 1);
+#ifdef CARD_CHECKS
+namespace {
+
+void checkSize(const CardSet& cards, uint32_t count) {
+    if (cards.size() != count) {
+        throw new std::runtime_error(
+                "Invalid CardSet size: " + std::to_string(cards.size()));
+    }
 }
 
-uint32_t lowest_bit(uint32_t v) {
-    return v & (-v);
+void checkBatchSize(uint32_t count) {
+    if (count < 5 || count > 7) {
+        throw new std::runtime_error(
+                "Invalid CardSet size: " + std::to_string(count));
+    }
 }
 
-template<typename T>
-T erase_lowest_bit(T v) {
-    return v & (v - 1);
 }
+#endif
 
-uint32_t erase_lowest_two_bits(uint32_t v) {
-    v &= (v - 1);
-    v &= (v - 1);
-    return v;
+template<>
+HandRanking CardSet::rank<5>() const {
+#ifdef CARD_CHECKS
+    checkSize(*this, 5);
+#endif
+    return HandRanking(detail::rankKernels().rankFewerCards[0](cv));
 }
 
-uint32_t highest_bit_ranking(uint32_t v) {
-	return -__builtin_clz(v);
+template<>
+HandRanking CardSet::rank<6>() const {
+#ifdef CARD_CHECKS
+    checkSize(*this, 6);
+#endif
+    return HandRanking(detail::rankKernels().rankFewerCards[1](cv));
 }
 
-uint32_t trailing_zeros(uint32_t v) {
-    return __builtin_ctz(v);
+template<>
+HandRanking CardSet::rank<7>() const {
+#ifdef CARD_CHECKS
+    checkSize(*this, 7);
+#endif
+    return HandRanking(detail::rankKernels().rankTexasHoldem(cv));
 }
 
-#if CARD_CHECKS
-bool has_upper_bit_set(uint64_t v, uint32_t lower_bit_count) {
-    return (v >> lower_bit_count) != 0;
+static_assert(sizeof(CardSet) == sizeof(__m128i), "CardSet layout");
+static_assert(sizeof(HandRanking) == sizeof(uint64_t), "HandRanking layout");
+
+template<>
+void CardSet::rankBatch<5>(const CardSet* in, HandRanking* out, size_t n) {
+    detail::rankKernels().rankFewerCardsBatch[0](
+            reinterpret_cast<const __m128i*>(in),
+            reinterpret_cast<uint64_t*>(out), n);
 }
-#endif
 
-template<typename F>
-inline __m128i combine4(__m128i v, F f) {
-    __m128i r = f(v, _mm_shufflehi_epi16(v, _MM_SHUFFLE(2,3,0,1)));
-    return f(r, _mm_shufflehi_epi16(r, _MM_SHUFFLE(1,0,3,2)));
+template<>
+void CardSet::rankBatch<6>(const CardSet* in, HandRanking* out, size_t n) {
+    detail::rankKernels().rankFewerCardsBatch[1](
+            reinterpret_cast<const __m128i*>(in),
+            reinterpret_cast<uint64_t*>(out), n);
 }
 
-inline __m128i and4(__m128i v) {
-    return combine4(v, [](__m128i a, __m128i b) {return _mm_and_si128(a,b);});
+template<>
+void CardSet::rankBatch<7>(const CardSet* in, HandRanking* out, size_t n) {
+    detail::rankKernels().rankTexasHoldemBatch(
+            reinterpret_cast<const __m128i*>(in),
+            reinterpret_cast<uint64_t*>(out), n);
 }
 
-inline __m128i vand(__m128i a, __m128i b) {
-    return _mm_and_si128(a, b);
+HandRanking CardSet::rankCards(uint32_t count) const {
+#ifdef CARD_CHECKS
+    checkBatchSize(count);
+#endif
+    return count == 5 ? rank<5>() : count == 6 ? rank<6>() : rank<7>();
 }
-inline __m128i vor(__m128i a, __m128i b) {
-    return _mm_or_si128(a, b);
+
+void CardSet::rankCardsBatch(const CardSet* in, HandRanking* out, size_t n,
+        uint32_t count) {
+#ifdef CARD_CHECKS
+    checkBatchSize(count);
+#endif
+    if (count == 5) {
+        rankBatch<5>(in, out, n);
+    } else if (count == 6) {
+        rankBatch<6>(in, out, n);
+    } else {
+        rankBatch<7>(in, out, n);
+    }
 }
-inline __m128i vadd(__m128i a, __m128i b) {
-    return _mm_add_epi32(a, b);
+
+void CardSet::rankCardsBatchPadded(CardSet* in, HandRanking* out,
+        size_t n, uint32_t count) {
+    size_t padded = paddedBatchSize(n);
+    std::fill(in + n, in + padded, in[0]);
+    rankCardsBatch(in, out, padded, count);
 }
 
+ShortDeckRanking CardSet::rankShortDeck() const {
+#ifdef CARD_CHECKS
+    checkSize(*this, 7);
+#endif
+    return ShortDeckRanking(detail::rankKernels().rankShortDeck(cv));
 }
- // namespace
 
-HandRanking HandRanking::create(Ranking ranking, uint32_t height,
-    uint32_t side_cards) {
-#if CARD_CHECKS
-if (has_upper_bit_set(height, 28)) {
-    throw new std::runtime_error("Invalid height");
+void CardSet::rankShortDeckBatch(const CardSet* in, ShortDeckRanking* out,
+        size_t n) {
+    static_assert(sizeof(ShortDeckRanking) == sizeof(uint64_t),
+            "ShortDeckRanking layout");
+    detail::rankKernels().rankShortDeckBatch(
+            reinterpret_cast<const __m128i*>(in),
+            reinterpret_cast<uint64_t*>(out), n);
 }
-#endif
-    return HandRanking((static_cast<uint64_t>(ranking) << RANKING_SHIFT) | (static_cast<uint64_t>(height) << 32) | side_cards);
+
+namespace {
+
+// Bits rank + 1 of a color word, with the ace moved from the top to bit 0.
+inline uint32_t aceLow(uint64_t word) {
+    return (word & 0x1ffe) | ((word >> 13) & 1);
 }
 
-HandRanking HandRanking::create(Ranking ranking, uint32_t height) {
-    return HandRanking((static_cast<uint64_t>(ranking) << RANKING_SHIFT) | height);
+inline bool multipleBits(uint32_t v) {
+    return v & (v - 1);
 }
 
-HandRanking CardSet::rankTexasHoldem() const {
+}
+
+LowRanking CardSet::rankLowA5() const {
 #ifdef CARD_CHECKS
-  if (size() != 7) {
-      throw new std::runtime_error("Invalid CardSet size: " + size());
-  }
+    if (size() < 5 || size() > 7) {
+        throw new std::runtime_error(
+                "Invalid CardSet size: " + std::to_string(size()));
+    }
 #endif
-    __m128i flush = _mm_cmpgt_epi8(cv, _mm_set1_epi8(4));
-    if (unlikely(!all_zeros(flush, _mm_set_epi32(0, 0, -1, 0)))) {
-        uint32_t color = trailing_zeros(_mm_movemask_epi8(flush) >> 4);
-        uint16_t flush_cards = _mm_extract_epi64(cv, 1) >> (color * 16);
-
-        uint32_t flush_cards_dup = flush_cards | (flush_cards >> 13);
-        uint32_t straight_flush = flush_cards & (flush_cards_dup << 1);
-        straight_flush &= (straight_flush << 2);
-        straight_flush &= (flush_cards_dup << 4);
-        if (unlikely(straight_flush != 0)) {
-            return HandRanking::create(HandRanking::STRAIGHT_FLUSH,
-                    highest_bit_ranking(straight_flush));
-        }
-        uint32_t flush_card_count = (color_cnts() >> (8 * color)) & 0xff;
-        if (flush_card_count > 5) {
-            flush_cards = erase_lowest_bit(flush_cards);
-        }
-        if (flush_card_count > 6) {
-            flush_cards = erase_lowest_bit(flush_cards);
+    uint64_t bits = cardBits();
+    uint32_t w0 = aceLow(bits), w1 = aceLow(bits >> 16);
+    uint32_t w2 = aceLow(bits >> 32), w3 = aceLow(bits >> 48);
+    // Ranks held at least once, twice, three and four times.
+    uint32_t held[4] = { w0 | w1 | w2 | w3,
+            (w0 & w1) | (w2 & w3) | ((w0 | w1) & (w2 | w3)),
+            (w0 & w1 & (w2 | w3)) | (w2 & w3 & (w0 | w1)),
+            w0 & w1 & w2 & w3 };
+    // Mostly there are five distinct ranks, the lowest of them make the low.
+    uint32_t distinct = held[0];
+    uint32_t lowest = 0;
+    for (int i = 0; i < 4; ++i) {
+        lowest |= distinct & -distinct;
+        distinct &= distinct - 1;
+    }
+    if (__builtin_expect(distinct != 0, 1)) {
+        return LowRanking::fromA5Ranks(HandRanking::HIGH_CARD,
+                lowest | (distinct & -distinct));
+    }
+    // Otherwise all distinct ranks, then second cards of the lowest ranks
+    // and so on: fewer and lower pairs make the better low.
+    uint32_t picked[4] = { };
+    uint32_t left = 5;
+    for (int k = 0; k < 4 && left; ++k) {
+        for (uint32_t v = held[k]; left && v; --left) {
+            picked[k] |= v & -v;
+            v &= v - 1;
         }
-        return HandRanking::create(HandRanking::FLUSH, flush_cards);
     }
+    HandRanking::Ranking category =
+            picked[3] ? HandRanking::FOUR_OF_A_KIND :
+            picked[2] ? (multipleBits(picked[1]) ? HandRanking::FULL_HOUSE :
+                    HandRanking::THREE_OF_A_KIND) :
+            picked[1] ? (multipleBits(picked[1]) ? HandRanking::TWO_PAIRS :
+                    HandRanking::ONE_PAIR) : HandRanking::HIGH_CARD;
+    return LowRanking::fromA5Ranks(category, picked[0] & ~picked[1],
+            picked[1] & ~picked[2], picked[2] & ~picked[3], picked[3]);
+}
 
-    uint32_t sum_bits = _mm_cvtsi128_si64(cv);
-
-    // Check for four of a kind:
-    __m128i four_of_a_kind = combine4(cv, vand);
-    if (unlikely(!all_zeros(four_of_a_kind, _mm_set_epi64x(-1, 0)))) {
-        // Congratulations! You have a four of a kind!
-        // Note that this makes straight flush impossible at the same time.
-        // Now need the highest card not part of the poker as side card.
-        uint32_t fok = _mm_extract_epi16(four_of_a_kind, 5);
-        uint32_t fok_bit = (4 << (trailing_zeros(fok) * 2));
-        sum_bits -= fok_bit;
-        uint32_t side_cards = (sum_bits | (sum_bits << 1)) & 0x2aaaaaaa;
-
-        return HandRanking::create(HandRanking::FOUR_OF_A_KIND, fok,
-                highest_bit_ranking(side_cards));
+LowRanking CardSet::rankLow27() const {
+    uint64_t high = rank<5>().value;
+    uint64_t bits = cardBits();
+    uint32_t ranks = (bits | bits >> 16 | bits >> 32 | bits >> 48) & 0x3ffe;
+    // A-2-3-4-5 as ace high: a flush, or a high card with the rank bits at
+    // 2 * rank + 3.
+    constexpr uint32_t WHEEL = 0x201e;
+    constexpr uint32_t WHEEL_COUNTS = 0x080002a8;
+    if (ranks == WHEEL) {
+        bool flush = high >> HandRanking::RANKING_SHIFT
+                == HandRanking::STRAIGHT_FLUSH;
+        high = flush ? static_cast<uint64_t>(HandRanking::FLUSH)
+                << HandRanking::RANKING_SHIFT | WHEEL : WHEEL_COUNTS;
     }
+    return LowRanking(~high);
+}
+
+namespace {
+
+inline __m128i select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// One stage of a sorting network on four 32-bit keys: every lane is compared
+// with the lane SHUFFLE moves onto it, the lanes in take_min keep the smaller
+// key and the others the larger one.
+template<int SHUFFLE>
+inline __m128i compare_exchange(__m128i v, __m128i take_min) {
+    __m128i s = _mm_shuffle_epi32(v, SHUFFLE);
+    __m128i greater = _mm_cmpgt_epi32(v, s);
+    __m128i high = select(greater, v, s);
+    __m128i low = select(greater, s, v);
+    return select(take_min, low, high);
+}
 
-    uint32_t one_of_a_kind = (sum_bits << 1) & 0x2aaaaaaa;
-    uint32_t two_of_a_kind = sum_bits & 0x2aaaaaaa;
-    uint32_t colorless = one_of_a_kind | two_of_a_kind;
-
-    // Straight:
-    uint32_t straight_bits = colorless | (colorless >> 26);
-    uint32_t straight = colorless & (straight_bits << 2);
-    straight = straight & (straight << 4);
-    straight = straight & (straight_bits << 8);
-    if (unlikely(straight != 0)) {
-        return HandRanking::create(HandRanking::STRAIGHT,
-                highest_bit_ranking(straight));
+// The four 16-bit color words of a card vector in 32-bit lanes.
+inline __m128i color_words(__m128i cv) {
+    return _mm_unpacklo_epi16(_mm_unpackhi_epi64(cv, cv),
+            _mm_setzero_si128());
+}
+
+}
+
+SuitPermutation CardSet::sortColors(__m128i primary, __m128i secondary,
+        uint32_t* multiplicity) {
+    // Key per color: primary word, secondary word and the color itself in
+    // the lowest bits. The words use bits 1 to 13, so the keys stay positive.
+    __m128i keys = _mm_or_si128(
+            _mm_or_si128(_mm_slli_epi32(color_words(primary), 14),
+                    _mm_slli_epi32(color_words(secondary), 1)),
+            _mm_set_epi32(3, 2, 1, 0));
+
+    // Sorts descending: (0,1) (2,3), then (0,2) (1,3), then (1,2).
+    keys = compare_exchange<_MM_SHUFFLE(2, 3, 0, 1)>(keys,
+            _mm_set_epi32(-1, 0, -1, 0));
+    keys = compare_exchange<_MM_SHUFFLE(1, 0, 3, 2)>(keys,
+            _mm_set_epi32(-1, -1, 0, 0));
+    keys = compare_exchange<_MM_SHUFFLE(3, 1, 2, 0)>(keys,
+            _mm_set_epi32(0, -1, 0, 0));
+
+    uint32_t sorted[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(sorted), keys);
+    SuitPermutation permutation;
+    for (uint8_t c = 0; c < 4; ++c) {
+        permutation.colors[sorted[c] & 3] = c;
     }
 
-    // Three of a kind:
-    uint32_t three_of_a_kind = one_of_a_kind & two_of_a_kind;
-    if (unlikely(three_of_a_kind != 0)) {
-        two_of_a_kind ^= three_of_a_kind;
-        if (multiple_bits_set(three_of_a_kind)) {
-            // Two three-of-a-kind. The lower one is our pair for the full house.
-            two_of_a_kind = lowest_bit(three_of_a_kind);
-            three_of_a_kind ^= two_of_a_kind;
+    if (multiplicity) {
+        // Colors with equal keys can be swapped without changing anything.
+        uint32_t stabilizer = 1;
+        uint32_t run = 1;
+        for (int c = 1; c < 4; ++c) {
+            run = (sorted[c] >> 2) == (sorted[c - 1] >> 2) ? run + 1 : 1;
+            stabilizer *= run;
         }
-        if (two_of_a_kind != 0) {
-            // Full house!
-            // There could still be multiple two-of-a-kind. Keep highest only.
-            return HandRanking::create(HandRanking::FULL_HOUSE, three_of_a_kind,
-                    highest_bit_ranking(two_of_a_kind));
-        }
-        uint32_t side_cards = erase_lowest_two_bits(colorless ^ three_of_a_kind);
-        return HandRanking::create(HandRanking::THREE_OF_A_KIND, three_of_a_kind,
-                side_cards);
+        *multiplicity = 24 / stabilizer;
     }
+    return permutation;
+}
 
-#ifdef __POPCNT__
-    uint32_t pairs = _mm_popcnt_u32(two_of_a_kind);
-    bool has_three_pairs = (pairs == 3);
-#else
-    // Emulate popcnt for 0-2 bits:
-    uint32_t remaining_pairs = two_of_a_kind;
-    uint32_t pairs = (remaining_pairs == 0) ? 0 : 1;
-    remaining_pairs = erase_lowest_bit(remaining_pairs);
-    pairs += (remaining_pairs == 0) ? 0 : 1;
-    remaining_pairs = erase_lowest_bit(remaining_pairs);
-    bool has_three_pairs = (remaining_pairs != 0);
-#endif
-    if (unlikely(has_three_pairs)) {
-        // Three pairs, only keep highest two.
-        uint32_t tok3 = lowest_bit(two_of_a_kind);
-        // Kicker is either highest card not part of any pairs or one of the lowest pair cards.
-        uint32_t side_cards = std::max(colorless ^ two_of_a_kind, tok3);
-        return HandRanking::create(HandRanking::TWO_PAIRS, two_of_a_kind ^ tok3,
-                side_cards);
+CardSet CardSet::permute(const SuitPermutation& permutation) const {
+    uint64_t low = _mm_cvtsi128_si64x(cv);
+    uint64_t words = cardBits();
+    uint64_t card_cnts = low & 0xffffffff;
+    uint64_t colors = 0;
+    uint64_t permuted_words = 0;
+    for (uint32_t c = 0; c < 4; ++c) {
+        uint32_t to = permutation.colors[c];
+        colors |= ((low >> (32 + 8 * c)) & 0xff) << (32 + 8 * to);
+        permuted_words |= ((words >> (16 * c)) & 0xffff) << (16 * to);
     }
+    return _mm_set_epi64x(permuted_words, card_cnts | colors);
+}
 
-    // Zero to two pairs. Kicker are those cards that remain after removing the pairs and the lowest two cards.
-    uint32_t side_cards = erase_lowest_two_bits(colorless ^ two_of_a_kind);
-    return HandRanking::create(static_cast<HandRanking::Ranking>(pairs),
-            two_of_a_kind, side_cards);
+std::tuple<CardSet, SuitPermutation> CardSet::canonicalize() const {
+    SuitPermutation permutation = sortColors(cv, _mm_setzero_si128(),
+            nullptr);
+    return std::make_tuple(permute(permutation), permutation);
 }
 
-CardSet::Table::Table() {
-    for (uint8_t c = 0; c < 4; ++c) {
-        for (uint8_t r = 0; r < 13; ++r) {
-            Card card(static_cast<Rank>(r), static_cast<Color>(c));
-            cv[card.getValue()] = internalToCardVec(card);
-        }
-    }
+std::tuple<CardSet, CardSet, SuitPermutation> CardSet::canonicalize(
+        const CardSet& secondary) const {
+    SuitPermutation permutation = sortColors(cv, secondary.cv, nullptr);
+    return std::make_tuple(permute(permutation),
+            secondary.permute(permutation), permutation);
 }
 
-CardSet::Table CardSet::card_table;
+uint32_t CardSet::multiplicity() const {
+    uint32_t result;
+    sortColors(cv, _mm_setzero_si128(), &result);
+    return result;
+}
 
-FastDeck::FastDeck() {
-sfmt_init_gen_rand(&sfmt, 12345);
-__m128i* cv= reinterpret_cast<__m128i*>(cards);
-cv[0] = _mm_setr_epi8(_2C.value, _3C.value, _4C.value, _5C.value, _6C.value,
-        _7C.value, _8C.value, _9C.value, _TC.value, _JC.value, _QC.value,
-        _KC.value, _AC.value, _2D.value, _3D.value, _4D.value);
-cv[1] = _mm_setr_epi8(_5D.value, _6D.value, _7D.value, _8D.value, _9D.value,
-        _TD.value, _JD.value, _QD.value, _KD.value, _AD.value, _2H.value,
-        _3H.value, _4H.value, _5H.value, _6H.value, _7H.value);
-cv[2] = _mm_setr_epi8(_8H.value, _9H.value, _TH.value, _JH.value, _QH.value,
-        _KH.value, _AH.value, _2S.value, _3S.value, _4S.value, _5S.value,
-        _6S.value, _7S.value, _8S.value, _9S.value, _TS.value);
-cv[3] = _mm_setr_epi8(_JS.value, _QS.value, _KS.value, _AS.value, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0);
+uint32_t CardSet::multiplicity(const CardSet& secondary) const {
+    uint32_t result;
+    sortColors(cv, secondary.cv, &result);
+    return result;
+}
+
+const __m128i* CardSet::loadCardTable() {
+    // A single kilobyte, not worth a table file.
+    static const TableData table = TableData::generate(64 * sizeof(__m128i),
+            [](void* payload) {
+                __m128i* cv = static_cast<__m128i*>(payload);
+                for (uint8_t c = 0; c < 4; ++c) {
+                    for (uint8_t r = 0; r < 13; ++r) {
+                        Card card(static_cast<Rank>(r), static_cast<Color>(c));
+                        cv[card.getValue()] = internalToCardVec(card);
+                    }
+                }
+            });
+    return table.as<__m128i>();
 }
 
+const __m128i* CardSet::card_table = loadCardTable();
+
 } /* namespace poker */
@@ -1,7 +1,7 @@
 #ifndef CARDSET_H_
 #define CARDSET_H_
 
-#include "SFMT.h"
+#include "Random.h"
 
 #include <string>
 #include <tuple>
@@ -10,6 +10,7 @@
 #include <functional>
 
 #include <stdint.h>
+#include <stddef.h>
 
 #include <emmintrin.h>
 #include <nmmintrin.h>
@@ -72,6 +73,8 @@ public:
      #endif
      }*/
 
+    // Unspecified card, e.g. for arrays filled by FastDeck::dealN().
+    Card() = default;
     Card(const Card&) = default;
     Card& operator=(const Card&) = default;
     bool operator==(const Card& o) const {
@@ -104,9 +107,9 @@ public:
 private:
     explicit Card(uint8_t value) : value(value) {}
 
-    friend class FastDeck;
+    template<typename Random> friend class BasicFastDeck;
 
-    const uint8_t value;
+    uint8_t value;
 };
 
 inline void PrintTo(const Card &c, ::std::ostream* os) {
@@ -150,29 +153,191 @@ public:
         return !(a < b);
     }
 
-    Ranking getRanking() const {
+    constexpr Ranking getRanking() const {
         return static_cast<Ranking>(value >> RANKING_SHIFT);
     }
 
+    // The category is stored in the topmost bits, followed by the height
+    // (pairs, three or four of a kind) at bit 32 and the side cards.
+    constexpr static int RANKING_SHIFT = 60;
+
 private:
     friend class CardSet;
+    friend class HandRankIndex;
 
-    constexpr static int RANKING_SHIFT = 60;
+    constexpr HandRanking(uint64_t value): value(value) {}
+
+    uint64_t value = 0;
+};
+
+// Ranking of a short deck (six plus) Hold'em hand, of the 36 cards from sixes
+// to aces. The ace also plays below the six, A-6-7-8-9 being the lowest
+// straight, and a flush beats a full house. Otherwise it compares like a
+// HandRanking; rankings of the two games do not compare with each other.
+class ShortDeckRanking {
+public:
+    ShortDeckRanking() = default;
 
-    HandRanking(uint64_t value): value(value) {}
+    bool operator<(const ShortDeckRanking& other) const {
+        return value < other.value;
+    }
 
-    static HandRanking create(Ranking ranking, uint32_t height, uint32_t side_cards);
-    static HandRanking create(Ranking ranking, uint32_t height);
+    bool operator==(const ShortDeckRanking& other) const {
+        return value == other.value;
+    }
+
+    friend bool operator<=(const ShortDeckRanking& a,
+            const ShortDeckRanking& b) {
+        return a < b || a == b;
+    }
+    friend bool operator>(const ShortDeckRanking& a,
+            const ShortDeckRanking& b) {
+        return !(a <= b);
+    }
+    friend bool operator!=(const ShortDeckRanking& a,
+            const ShortDeckRanking& b) {
+        return !(a == b);
+    }
+    friend bool operator>=(const ShortDeckRanking& a,
+            const ShortDeckRanking& b) {
+        return !(a < b);
+    }
+
+    // The value has the categories FLUSH and FULL_HOUSE swapped, so that
+    // they compare in short deck order.
+    HandRanking::Ranking getRanking() const {
+        uint32_t category = value >> HandRanking::RANKING_SHIFT;
+        return static_cast<HandRanking::Ranking>(
+                category == HandRanking::FLUSH ? HandRanking::FULL_HOUSE :
+                category == HandRanking::FULL_HOUSE ? HandRanking::FLUSH :
+                category);
+    }
+
+private:
+    friend class CardSet;
+
+    explicit ShortDeckRanking(uint64_t value) :
+            value(value) {
+    }
 
     uint64_t value = 0;
 };
 
+// Ranking of a low hand, for lowball games and the low half of hi-lo games.
+// As with HandRanking the better hand has the higher ranking, and the default
+// ranking, no low at all, is below every other. A-5 and 2-7 lows do not
+// compare with each other.
+class LowRanking {
+public:
+    LowRanking() = default;
+
+    bool operator<(const LowRanking& other) const {
+        return value < other.value;
+    }
+
+    bool operator==(const LowRanking& other) const {
+        return value == other.value;
+    }
+
+    friend bool operator<=(const LowRanking& a, const LowRanking& b) {
+        return a < b || a == b;
+    }
+    friend bool operator>(const LowRanking& a, const LowRanking& b) {
+        return !(a <= b);
+    }
+    friend bool operator!=(const LowRanking& a, const LowRanking& b) {
+        return !(a == b);
+    }
+    friend bool operator>=(const LowRanking& a, const LowRanking& b) {
+        return !(a < b);
+    }
+
+    // Whether this is an A-5 low of five distinct ranks, none above the
+    // eight: the qualifier of the low half of Omaha and Stud Hi-Lo.
+    bool isEightOrBetter() const {
+        return value != 0 && ~value < (1u << 8);
+    }
+
+    // The category of the five cards as a high hand, without straights and
+    // flushes for A-5 lows.
+    HandRanking::Ranking getRanking() const {
+        return static_cast<HandRanking::Ranking>(
+                ~value >> HandRanking::RANKING_SHIFT);
+    }
+
+private:
+    friend class CardSet;
+    friend class OmahaBoard;
+
+    // The complement of the five cards ranked as a high hand. For 2-7 that
+    // is a HandRanking value. For A-5 the aces are rank 0, and below the
+    // category come four 13-bit masks, of the ranks held four, three, two
+    // times and once.
+    explicit LowRanking(uint64_t value) :
+            value(value) {
+    }
+
+    constexpr static uint32_t RANK_MASK_BITS = 13;
+
+    static LowRanking fromA5Ranks(uint32_t category, uint32_t once,
+            uint32_t twice = 0, uint32_t three_times = 0,
+            uint32_t four_times = 0) {
+        return LowRanking(~(static_cast<uint64_t>(category)
+                << HandRanking::RANKING_SHIFT
+                | static_cast<uint64_t>(four_times) << (3 * RANK_MASK_BITS)
+                | static_cast<uint64_t>(three_times) << (2 * RANK_MASK_BITS)
+                | static_cast<uint64_t>(twice) << RANK_MASK_BITS | once));
+    }
+
+    uint64_t value = 0;
+};
+
+// A bijection of the colors, e.g. the one turning a card set into its
+// canonical form.
+class SuitPermutation {
+public:
+    SuitPermutation() :
+            colors { 0, 1, 2, 3 } {
+    }
+
+    Color apply(Color color) const {
+        return static_cast<Color>(colors[static_cast<int>(color)]);
+    }
+
+    Card apply(Card card) const {
+        return Card(card.getRank(), apply(card.getColor()));
+    }
+
+    SuitPermutation inverse() const {
+        SuitPermutation result;
+        for (uint8_t c = 0; c < 4; ++c) {
+            result.colors[colors[c]] = c;
+        }
+        return result;
+    }
+
+    bool operator==(const SuitPermutation& o) const {
+        return colors[0] == o.colors[0] && colors[1] == o.colors[1]
+                && colors[2] == o.colors[2] && colors[3] == o.colors[3];
+    }
+
+private:
+    friend class CardSet;
+
+    uint8_t colors[4];
+};
+
 class CardSet {
 public:
     static CardSet fullDeck() {
         return _mm_set_epi64x(0x3ffe3ffe3ffe3ffe, 0x0d0d0d0d24924940);
     }
 
+    // The 36 cards of short deck Hold'em, sixes to aces.
+    static CardSet shortDeck() {
+        return _mm_set_epi64x(0x3fe03fe03fe03fe0, 0x0909090915555000);
+    }
+
     CardSet() {
         cv = _mm_setzero_si128();
     }
@@ -225,7 +390,7 @@ public:
         }
 #endif
         __m128i cv = toCardVec(c);
-        this->cv = _mm_sub_epi64(cv, this->cv);
+        this->cv = _mm_sub_epi64(this->cv, cv);
     }
 
     void addAll(const CardSet& cs) {
@@ -238,26 +403,121 @@ public:
         this->cv = _mm_add_epi64(cs.cv, this->cv);
     }
 
+    // One bit per contained card, bit 16 * color + rank + 1. Convenient to
+    // test many card sets for overlaps at once.
+    uint64_t cardBits() const {
+        return _mm_cvtsi128_si64x(_mm_unpackhi_epi64(cv, cv));
+    }
+
     HandRanking rankTexasHoldem() const;
 
+    // Best five of exactly N cards, N being five, six or seven, e.g. a hand
+    // on the flop or turn. Each count has its own kernel, which drops the
+    // N - 5 lowest spare cards without branching on the count, so this
+    // costs no more than rankTexasHoldem(), which is rank<7>(). Throws with
+    // CARD_CHECKS unless the set has N cards. Only the specializations for
+    // five to seven cards are defined, other counts fail to link.
+    template<uint32_t N>
+    HandRanking rank() const;
+
+    // Ranks n sets of N cards each, like rankTexasHoldemBatch().
+    template<uint32_t N>
+    static void rankBatch(const CardSet* in, HandRanking* out, size_t n);
+
+    // The same cards with every color replaced according to the permutation.
+    CardSet permute(const SuitPermutation& permutation) const;
+
+    // Representative of all card sets that are equal up to a permutation of
+    // the colors, together with the permutation that maps this set to it. The
+    // colors are ordered by descending color word, so the canonical set has
+    // its most (and highest) cards in clubs.
+    std::tuple<CardSet, SuitPermutation> canonicalize() const;
+
+    // Canonicalizes this set and the secondary set (e.g. board and hole
+    // cards) with the same permutation. Colors this set uses the same way are
+    // ordered by the secondary set.
+    std::tuple<CardSet, CardSet, SuitPermutation> canonicalize(
+            const CardSet& secondary) const;
+
+    // Number of distinct card sets sharing the canonical form of this set,
+    // 24 divided by the number of color permutations leaving it unchanged.
+    // Exact enumerations can visit canonical forms only and weight by it.
+    uint32_t multiplicity() const;
+
+    uint32_t multiplicity(const CardSet& secondary) const;
+
+    // Best five of seven short deck cards, on the vectorized kernels of
+    // rankTexasHoldem(). Cards below the six give undefined results.
+    ShortDeckRanking rankShortDeck() const;
+
+    static void rankShortDeckBatch(const CardSet* in, ShortDeckRanking* out,
+            size_t n);
+
+    // Best A-5 low of five to seven cards: aces are low and straights and
+    // flushes do not count, so it is the lowest five distinct ranks, or
+    // the lowest pairs if there are fewer, e.g. in Razz.
+    LowRanking rankLowA5() const;
+
+    // 2-7 low of exactly five cards, as in 2-7 triple draw: the reverse of
+    // the high hand, with straights and flushes against it and aces high
+    // only, so A-2-3-4-5 is no straight.
+    LowRanking rankLow27() const;
+
+    // Ranks n seven card sets at once. Equivalent to calling rankTexasHoldem()
+    // on each input, but evaluates 8 (AVX2) or 16 (AVX-512) hands per step
+    // without branching on the hand category.
+    static void rankTexasHoldemBatch(const CardSet* in, HandRanking* out,
+            size_t n);
+
     std::vector<Card> toCardVector() const;
 
+    // The cards in ascending order of Card::getValue(), e.g. "QCAC3H".
+    std::string toString() const;
+
+    // Writes the cards in ascending order of Card::getValue(), without
+    // allocating, and returns their number. Out must hold size() cards.
+    size_t toCards(Card* out) const {
+        return toCards(cardBits(), out);
+    }
+
 private:
-    class Table {
-    public:
-        Table();
-        __m128i operator[](uint8_t idx) {
-            return cv[idx];
-        }
-    private:
-        __m128i cv[64];
-    };
+    friend class IncrementalEvaluator;
+    friend class OmahaBoard;
+
+    // Hands per step of the widest batch kernel (AVX-512).
+    constexpr static size_t BATCH_WIDTH = 16;
+
+    // The cards of the bits of cardBits().
+    static size_t toCards(uint64_t card_bits, Card* out);
+
+    // Best five cards of count cards, five to seven.
+    HandRanking rankCards(uint32_t count) const;
+
+    static void rankCardsBatch(const CardSet* in, HandRanking* out, size_t n,
+            uint32_t count);
+
+    // Room for n hands padded to whole steps of the widest batch kernel.
+    constexpr static size_t paddedBatchSize(size_t n) {
+        return (n + BATCH_WIDTH - 1) / BATCH_WIDTH * BATCH_WIDTH;
+    }
+
+    // Like rankCardsBatch(), but first fills in and out up to
+    // paddedBatchSize(n) with copies of the first hand, which the kernels
+    // would otherwise rank one by one.
+    static void rankCardsBatchPadded(CardSet* in, HandRanking* out, size_t n,
+            uint32_t count);
+
+    static SuitPermutation sortColors(__m128i primary, __m128i secondary,
+            uint32_t* multiplicity);
 
     uint32_t color_cnts() const {
         return _mm_cvtsi128_si64x(cv) >> 32;
     }
 
-    static Table card_table;
+    // Card vectors by Card::value.
+    static const __m128i* card_table;
+
+    static const __m128i* loadCardTable();
 
     static __m128i toCardVec(Card c) {
 #ifdef NO_CARD_TABLE
@@ -288,35 +548,215 @@ private:
     __m128i cv;
 };
 
-class FastDeck {
+template<> HandRanking CardSet::rank<5>() const;
+template<> HandRanking CardSet::rank<6>() const;
+template<> HandRanking CardSet::rank<7>() const;
+
+template<> void CardSet::rankBatch<5>(const CardSet* in, HandRanking* out,
+        size_t n);
+template<> void CardSet::rankBatch<6>(const CardSet* in, HandRanking* out,
+        size_t n);
+template<> void CardSet::rankBatch<7>(const CardSet* in, HandRanking* out,
+        size_t n);
+
+// The two private cards of a Texas Hold'em player.
+class HoleCards {
+public:
+    // Unspecified cards, e.g. for arrays filled by FastDeck::dealHands().
+    HoleCards() = default;
+
+    HoleCards(Card first, Card second) :
+            first(first), second(second) {
+#ifdef CARD_CHECKS
+        if (first == second) {
+            throw new std::runtime_error(
+                    "Duplicate hole card " + first.toString());
+        }
+#endif
+    }
+
+    Card getFirst() const {
+        return first;
+    }
+
+    Card getSecond() const {
+        return second;
+    }
+
+    CardSet toCardSet() const {
+        return CardSet( { first, second });
+    }
+
+    std::string toString() const {
+        return first.toString() + second.toString();
+    }
+
+private:
+    Card first;
+    Card second;
+};
+
+// Deck dealing from the random words of Random, see Random.h.
+template<typename Random>
+class BasicFastDeck {
 public:
-    FastDeck();
+    constexpr static uint32_t DEFAULT_SEED = 12345;
+
+    BasicFastDeck() :
+            BasicFastDeck(CardSet(), DEFAULT_SEED) {
+    }
+
+    explicit BasicFastDeck(uint32_t seed) :
+            BasicFastDeck(CardSet(), seed) {
+    }
+
+    // A deck of the 36 short deck cards, sixes to aces.
+    static BasicFastDeck shortDeck(uint32_t seed = DEFAULT_SEED) {
+        CardSet excluded;
+        for (uint8_t c = 0; c < 4; ++c) {
+            for (uint8_t r = 0; r < 4; ++r) {
+                excluded.add(Card(static_cast<Rank>(r), static_cast<Color>(c)));
+            }
+        }
+        return BasicFastDeck(excluded, seed);
+    }
+
+    // A deck without the excluded cards, e.g. those already known to be out.
+    BasicFastDeck(const CardSet& excluded, uint32_t seed) :
+            random(seed) {
+        for (uint8_t c = 0; c < 4; ++c) {
+            for (uint8_t r = 0; r < 13; ++r) {
+                Card card(static_cast<Rank>(r), static_cast<Color>(c));
+                if (!excluded.contains(card)) {
+                    cards[count++] = card.getValue();
+                }
+            }
+        }
+    }
 
     void shuffle() {
-        remaining = 52;
+        remaining = count;
+    }
+
+    // Moves on to the next substream of the generator, 2^64 steps ahead.
+    // Random words buffered already are dropped.
+    void jump() {
+        random.jump(1);
+        position = BUFFER_SIZE;
+    }
+
+    // Copy of the deck dealing from substream k of this one, as after k
+    // jumps. Workers each splitting off their own k of one seed deal the
+    // same cards whichever thread, or host, runs them. With PhiloxRandom this
+    // is constant time, so every trial can have a substream of its own.
+    BasicFastDeck split(uint64_t k) const {
+        BasicFastDeck deck = *this;
+        deck.random.jump(k);
+        deck.position = BUFFER_SIZE;
+        return deck;
+    }
+
+    uint32_t size() const {
+        return count;
     }
 
+    // Every remaining card is equally likely.
     Card deal() {
+        Card card;
+        dealN(&card, 1);
+        return card;
+    }
+
+    // Deals n cards into out, the steps of a partial Fisher-Yates shuffle.
+    void dealN(Card* out, int n) {
+#ifdef CARD_CHECKS
+        if (n < 0 || n > remaining) {
+            throw new std::runtime_error("No remaining cards!");
+        }
+#endif
+        draw(n, [out](int i, uint8_t card) {
+            out[i] = Card(card);
+        });
+    }
+
+    // Deals two cards each into n hole cards.
+    void dealHands(HoleCards* out, int n) {
 #ifdef CARD_CHECKS
-        if (remaining == 0) {
+        if (n < 0 || 2 * n > remaining) {
             throw new std::runtime_error("No remaining cards!");
         }
 #endif
-        // Note: This has a slight bias towards lower indices.
-        uint32_t random = sfmt_genrand_uint32(&sfmt);
-        uint32_t index = (static_cast<uint64_t>(random) * remaining) >> 32;
-        uint32_t card = cards[index];
-        remaining--;
-        std::swap(cards[remaining], cards[index]);
-        return Card(card);
+        uint8_t first = 0;
+        draw(2 * n, [out, &first](int i, uint8_t card) {
+            if (i & 1) {
+                out[i / 2] = HoleCards(Card(first), Card(card));
+            } else {
+                first = card;
+            }
+        });
     }
 
 private:
+    // Random words are generated in bulk.
+    constexpr static int32_t BUFFER_SIZE = Random::BUFFER_SIZE;
+
+    void refill() {
+        random.fill(buffer);
+        position = 0;
+    }
+
+    // Lemire's multiply-shift mapping of a random word onto [0, range). The
+    // products whose lower half falls below 2^32 mod range would favor the
+    // lower indices, they are rejected. For a deck that happens with a
+    // probability below 2^-26.
+    uint64_t reject(uint64_t product, uint32_t range) {
+        uint32_t threshold = -range % range;
+        while (static_cast<uint32_t>(product) < threshold) {
+            if (position == BUFFER_SIZE) {
+                refill();
+            }
+            product = static_cast<uint64_t>(buffer[position++]) * range;
+        }
+        return product;
+    }
+
+    // Draws n cards and passes them to f(i, card). The loop state is kept in
+    // locals, as the card stores could alias the members.
+    template<typename F>
+    void draw(int n, F f) {
+        uint32_t left = remaining;
+        for (int i = 0; i < n; ++i) {
+            if (__builtin_expect(position == BUFFER_SIZE, 0)) {
+                refill();
+            }
+            uint64_t product = static_cast<uint64_t>(buffer[position++])
+                    * left;
+            if (__builtin_expect(static_cast<uint32_t>(product) < left, 0)) {
+                product = reject(product, left);
+            }
+            uint32_t index = product >> 32;
+            left--;
+            uint8_t card = cards[index];
+            cards[index] = cards[left];
+            cards[left] = card;
+            f(i, card);
+        }
+        remaining = left;
+    }
+
+    Random random;
+    alignas(16) uint32_t buffer[BUFFER_SIZE];
+    int32_t position = BUFFER_SIZE;
     uint8_t cards[64];
+    int32_t count = 0;
     int32_t remaining = 0;
-    sfmt_t sfmt;
 };
 
+typedef BasicFastDeck<SfmtRandom> FastDeck;
+
+// Small state and free substreams, e.g. for a deck per simulated table.
+typedef BasicFastDeck<PhiloxRandom> PhiloxDeck;
+
 }
 /* namespace poker */
 
@@ -0,0 +1,296 @@
+#include "CpuDispatch.h"
+#include "CardSet.h"
+#include "RankTables.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+#include <immintrin.h>
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#define RANK_KERNEL_NAMESPACE sse2
+#include "RankKernels.h"
+#undef RANK_KERNEL_NAMESPACE
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("sse4.2,popcnt")
+#define RANK_KERNEL_NAMESPACE sse4_2
+#define RANK_KERNEL_SSE4
+#include "RankKernels.h"
+#undef RANK_KERNEL_SSE4
+#undef RANK_KERNEL_NAMESPACE
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2,bmi,bmi2,popcnt")
+#define RANK_KERNEL_NAMESPACE avx2
+#define RANK_KERNEL_SSE4
+#define RANK_KERNEL_AVX2
+#include "RankKernels.h"
+#undef RANK_KERNEL_AVX2
+#undef RANK_KERNEL_SSE4
+#undef RANK_KERNEL_NAMESPACE
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512cd,avx2,bmi,bmi2,popcnt")
+// GCC's avx512fintrin.h seeds results with _mm512_undefined_epi32(), which
+// -Wuninitialized and -Wmaybe-uninitialized report depending on the
+// optimization level.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#define RANK_KERNEL_NAMESPACE avx512
+#define RANK_KERNEL_SSE4
+#define RANK_KERNEL_AVX512
+#include "RankKernels.h"
+#undef RANK_KERNEL_AVX512
+#undef RANK_KERNEL_SSE4
+#undef RANK_KERNEL_NAMESPACE
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+
+namespace poker {
+
+namespace {
+
+#define RANK_KERNELS(NAMESPACE, RANK, RANK_BATCH, SHOWDOWN) \
+    { RANK, RANK_BATCH, \
+      { NAMESPACE::rankFiveCards, NAMESPACE::rankSixCards }, \
+      { NAMESPACE::rankFiveCardsBatch, NAMESPACE::rankSixCardsBatch }, \
+      NAMESPACE::rankShortDeck, NAMESPACE::rankShortDeckBatch, SHOWDOWN }
+
+#define COMPUTED_KERNELS(NAMESPACE) \
+    RANK_KERNELS(NAMESPACE, NAMESPACE::rankTexasHoldem, \
+            NAMESPACE::rankTexasHoldemBatch, NAMESPACE::showdown)
+
+const detail::RankKernels kernels[] = {
+    COMPUTED_KERNELS(sse2),
+    COMPUTED_KERNELS(sse4_2),
+    COMPUTED_KERNELS(avx2),
+    COMPUTED_KERNELS(avx512),
+};
+
+bool isSupported(SimdLevel level) {
+    __builtin_cpu_init();
+    switch (level) {
+    case SimdLevel::SSE2:
+        return true;
+    case SimdLevel::SSE4_2:
+        return __builtin_cpu_supports("sse4.2")
+                && __builtin_cpu_supports("popcnt");
+    case SimdLevel::AVX2:
+        return isSupported(SimdLevel::SSE4_2) && __builtin_cpu_supports("avx2")
+                && __builtin_cpu_supports("bmi")
+                && __builtin_cpu_supports("bmi2");
+    case SimdLevel::AVX512:
+        return isSupported(SimdLevel::AVX2)
+                && __builtin_cpu_supports("avx512f")
+                && __builtin_cpu_supports("avx512cd");
+    default:
+        return false;
+    }
+}
+
+detail::RankTables* rank_tables = nullptr;
+
+uint64_t tableRankTexasHoldem(__m128i cv) {
+    return rank_tables->rankTexasHoldem(cv);
+}
+
+void tableRankTexasHoldemBatch(const __m128i* in, uint64_t* out, size_t n) {
+    rank_tables->rankTexasHoldem(in, out, n);
+}
+
+uint32_t tableShowdown(const __m128i* in, size_t n, uint64_t* out) {
+    const detail::RankTables& tables = *rank_tables;
+    // Classes are ordered like the rankings, so the winners are found on them.
+    uint16_t classes[detail::MAX_SHOWDOWN];
+    tables.getClasses(in, classes, n);
+    uint16_t best = 0;
+    for (size_t i = 0; i < n; ++i) {
+        best = std::max(best, classes[i]);
+    }
+    uint32_t winners = 0;
+    for (size_t i = 0; i < n; ++i) {
+        winners |= classes[i] == best ? 1u << i : 0;
+        if (out) {
+            out[i] = tables.getValue(classes[i]);
+        }
+    }
+    return winners;
+}
+
+// The tables cover seven card Hold'em only, fewer cards and short deck are
+// computed at the level.
+#define TABLE_KERNELS(NAMESPACE) \
+    RANK_KERNELS(NAMESPACE, tableRankTexasHoldem, tableRankTexasHoldemBatch, \
+            tableShowdown)
+
+const detail::RankKernels table_kernels[] = {
+    TABLE_KERNELS(sse2),
+    TABLE_KERNELS(sse4_2),
+    TABLE_KERNELS(avx2),
+    TABLE_KERNELS(avx512),
+};
+
+#undef TABLE_KERNELS
+#undef COMPUTED_KERNELS
+#undef RANK_KERNELS
+
+std::mutex selection_mutex;
+SimdLevel selected_level;
+RankBackend selected_backend = RankBackend::COMPUTED;
+bool resolved = false;
+bool replicate_tables = false;
+
+// Installs the kernels for the selected level and backend. Expects the
+// selection mutex to be held.
+const detail::RankKernels& install() {
+    if (!resolved) {
+        selected_level = detectSimdLevel();
+        resolved = true;
+    }
+    const detail::RankKernels* selected =
+            selected_backend == RankBackend::TABLE ?
+                    &table_kernels[static_cast<int>(selected_level)] :
+                    &kernels[static_cast<int>(selected_level)];
+    detail::active_rank_kernels.store(selected, std::memory_order_release);
+    return *selected;
+}
+
+const detail::RankKernels& resolve() {
+    std::lock_guard<std::mutex> lock(selection_mutex);
+    return install();
+}
+
+// Installed until the first call, so that ranking works even from static
+// initializers that run before the CPU was inspected.
+uint64_t resolveRankTexasHoldem(__m128i cv) {
+    return resolve().rankTexasHoldem(cv);
+}
+
+void resolveRankTexasHoldemBatch(const __m128i* in, uint64_t* out, size_t n) {
+    resolve().rankTexasHoldemBatch(in, out, n);
+}
+
+template<int INDEX>
+uint64_t resolveRankFewerCards(__m128i cv) {
+    return resolve().rankFewerCards[INDEX](cv);
+}
+
+template<int INDEX>
+void resolveRankFewerCardsBatch(const __m128i* in, uint64_t* out, size_t n) {
+    resolve().rankFewerCardsBatch[INDEX](in, out, n);
+}
+
+uint64_t resolveRankShortDeck(__m128i cv) {
+    return resolve().rankShortDeck(cv);
+}
+
+void resolveRankShortDeckBatch(const __m128i* in, uint64_t* out, size_t n) {
+    resolve().rankShortDeckBatch(in, out, n);
+}
+
+uint32_t resolveShowdown(const __m128i* in, size_t n, uint64_t* out) {
+    return resolve().showdown(in, n, out);
+}
+
+const detail::RankKernels resolving_kernels = {
+    resolveRankTexasHoldem, resolveRankTexasHoldemBatch,
+    { resolveRankFewerCards<0>, resolveRankFewerCards<1> },
+    { resolveRankFewerCardsBatch<0>, resolveRankFewerCardsBatch<1> },
+    resolveRankShortDeck, resolveRankShortDeckBatch, resolveShowdown
+};
+
+}  // namespace
+
+std::atomic<const detail::RankKernels*> detail::active_rank_kernels(
+        &resolving_kernels);
+
+std::string toString(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SSE2:
+        return "SSE2";
+    case SimdLevel::SSE4_2:
+        return "SSE4.2";
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::AVX512:
+        return "AVX-512";
+    default:
+        return "?";
+    }
+}
+
+SimdLevel detectSimdLevel() {
+    SimdLevel levels[] = { SimdLevel::AVX512, SimdLevel::AVX2,
+            SimdLevel::SSE4_2 };
+    for (SimdLevel level : levels) {
+        if (isSupported(level)) {
+            return level;
+        }
+    }
+    return SimdLevel::SSE2;
+}
+
+SimdLevel getSimdLevel() {
+    std::lock_guard<std::mutex> lock(selection_mutex);
+    if (!resolved) {
+        install();
+    }
+    return selected_level;
+}
+
+void setSimdLevel(SimdLevel level) {
+    if (!isSupported(level)) {
+        throw new std::runtime_error(
+                "SIMD level not supported by this CPU: " + toString(level));
+    }
+    std::lock_guard<std::mutex> lock(selection_mutex);
+    resolved = true;
+    selected_level = level;
+    install();
+}
+
+std::string toString(RankBackend backend) {
+    switch (backend) {
+    case RankBackend::COMPUTED:
+        return "computed";
+    case RankBackend::TABLE:
+        return "table";
+    default:
+        return "?";
+    }
+}
+
+RankBackend getRankBackend() {
+    std::lock_guard<std::mutex> lock(selection_mutex);
+    return selected_backend;
+}
+
+void setRankBackend(RankBackend backend) {
+    std::lock_guard<std::mutex> lock(selection_mutex);
+    if (backend == RankBackend::TABLE && !rank_tables) {
+        // The computing kernels all agree, the baseline one is always there.
+        rank_tables = new detail::RankTables(sse2::rankTexasHoldem);
+        if (replicate_tables) {
+            rank_tables->replicate();
+        }
+    }
+    selected_backend = backend;
+    install();
+}
+
+void replicateRankTables() {
+    std::lock_guard<std::mutex> lock(selection_mutex);
+    replicate_tables = true;
+    if (rank_tables) {
+        rank_tables->replicate();
+    }
+}
+
+} /* namespace poker */
@@ -0,0 +1,82 @@
+#ifndef CPUDISPATCH_H_
+#define CPUDISPATCH_H_
+
+#include <atomic>
+#include <string>
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <emmintrin.h>
+
+namespace poker {
+
+// Instruction set levels the ranking kernels are built for. The best level
+// supported by the CPU is picked on first use, so a single binary runs its
+// fastest path everywhere.
+enum class SimdLevel {
+    SSE2 = 0, SSE4_2 = 1, AVX2 = 2, AVX512 = 3,
+};
+
+std::string toString(SimdLevel level);
+
+// Best level supported by the CPU (and operating system) we run on.
+SimdLevel detectSimdLevel();
+
+SimdLevel getSimdLevel();
+
+// Overrides the detected level, e.g. to compare kernels against each other.
+// Throws if the CPU does not support the level.
+void setSimdLevel(SimdLevel level);
+
+// Algorithm behind CardSet::rankTexasHoldem() and its batch variant. Both
+// return identical rankings: COMPUTED evaluates the card vector with the
+// kernels of the active SIMD level, TABLE looks the hand up in tables that
+// are generated on first selection. Which one is faster depends on the host.
+enum class RankBackend {
+    COMPUTED = 0, TABLE = 1,
+};
+
+std::string toString(RankBackend backend);
+
+RankBackend getRankBackend();
+
+void setRankBackend(RankBackend backend);
+
+// Keeps a copy of the tables of the TABLE backend in the memory of every
+// NUMA node, read by the threads pinned to the node with
+// pinThreadToNumaNode(). Lasts for the lifetime of the process; on hosts
+// with a single node it just adds a copy.
+void replicateRankTables();
+
+namespace detail {
+
+// Most hands a showdown kernel takes, one bit each in the winner mask.
+constexpr size_t MAX_SHOWDOWN = 32;
+
+struct RankKernels {
+    uint64_t (*rankTexasHoldem)(__m128i cv);
+    void (*rankTexasHoldemBatch)(const __m128i* in, uint64_t* out, size_t n);
+    // Best five of five or six cards, indexed by the card count minus five.
+    uint64_t (*rankFewerCards[2])(__m128i cv);
+    void (*rankFewerCardsBatch[2])(const __m128i* in, uint64_t* out,
+            size_t n);
+    // Seven card short deck hands, see ShortDeckRanking.
+    uint64_t (*rankShortDeck)(__m128i cv);
+    void (*rankShortDeckBatch)(const __m128i* in, uint64_t* out, size_t n);
+    // Ranks up to MAX_SHOWDOWN seven card hands and returns the mask of those
+    // with the highest ranking. The rankings go to out unless it is null.
+    uint32_t (*showdown)(const __m128i* in, size_t n, uint64_t* out);
+};
+
+extern std::atomic<const RankKernels*> active_rank_kernels;
+
+inline const RankKernels& rankKernels() {
+    return *active_rank_kernels.load(std::memory_order_acquire);
+}
+
+} // namespace detail
+
+} // namespace poker
+
+#endif /* CPUDISPATCH_H_ */
@@ -0,0 +1,299 @@
+#include "EquityCalculator.h"
+#include "BoardEnumerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace poker {
+
+namespace {
+
+// Least common multiple of 1..MAX_PLAYERS, so every split pot share is an
+// integral number of units and the tallies can be summed exactly.
+constexpr uint64_t SHARE_UNIT = 2520;
+
+// Trials whose hands are ranked with a single batch call.
+constexpr uint64_t BLOCK_TRIALS = 16;
+
+// Trials of a chunk, dealt from one substream and merged into the shared
+// tally at once.
+constexpr uint64_t CHUNK_TRIALS = 8192;
+
+// Boards of an enumeration task.
+constexpr uint64_t ENUMERATION_GRAIN = 4096;
+
+// The hands of all players for a number of boards, ranked together. The
+// buffers are scratch memory of the task.
+class HandBlock {
+public:
+    HandBlock(const std::vector<CardSet>& hole_cards, ScratchArena& arena) :
+            hole_cards(hole_cards), hands(arena.allocate<CardSet>(
+                    BLOCK_TRIALS * hole_cards.size())), rankings(
+                    arena.allocate<HandRanking>(
+                            BLOCK_TRIALS * hole_cards.size())) {
+    }
+
+    void add(const CardSet& board) {
+        CardSet* board_hands = hands + boards * hole_cards.size();
+        for (size_t p = 0; p < hole_cards.size(); ++p) {
+            board_hands[p] = board;
+            board_hands[p].addAll(hole_cards[p]);
+        }
+        boards++;
+    }
+
+    bool full() const {
+        return boards == BLOCK_TRIALS;
+    }
+
+    size_t size() const {
+        return boards;
+    }
+
+    void rank() {
+        CardSet::rankTexasHoldemBatch(hands, rankings,
+                boards * hole_cards.size());
+    }
+
+    const HandRanking* getRankings(size_t board) const {
+        return rankings + board * hole_cards.size();
+    }
+
+    void clear() {
+        boards = 0;
+    }
+
+private:
+    const std::vector<CardSet>& hole_cards;
+    size_t boards = 0;
+    CardSet* hands;
+    HandRanking* rankings;
+};
+
+}
+
+class EquityCalculator::Tally {
+public:
+    explicit Tally(size_t players) :
+            wins(players), ties(players), shares(players), squares(players) {
+    }
+
+    void add(const HandRanking* rankings) {
+        size_t players = wins.size();
+        HandRanking best = rankings[0];
+        for (size_t p = 1; p < players; ++p) {
+            best = std::max(best, rankings[p]);
+        }
+        uint32_t winners = 0;
+        for (size_t p = 0; p < players; ++p) {
+            winners += rankings[p] == best;
+        }
+        uint64_t share = SHARE_UNIT / winners;
+        std::vector<uint64_t>& outcome = winners == 1 ? wins : ties;
+        for (size_t p = 0; p < players; ++p) {
+            if (rankings[p] == best) {
+                outcome[p]++;
+                shares[p] += share;
+                squares[p] += share * share;
+            }
+        }
+        trials++;
+    }
+
+    // Ranks and counts all boards of the block and empties it.
+    void add(HandBlock& block) {
+        block.rank();
+        for (size_t b = 0; b < block.size(); ++b) {
+            add(block.getRankings(b));
+        }
+        block.clear();
+    }
+
+    void merge(const Tally& o) {
+        for (size_t p = 0; p < wins.size(); ++p) {
+            wins[p] += o.wins[p];
+            ties[p] += o.ties[p];
+            shares[p] += o.shares[p];
+            squares[p] += o.squares[p];
+        }
+        trials += o.trials;
+    }
+
+    void clear() {
+        std::fill(wins.begin(), wins.end(), 0);
+        std::fill(ties.begin(), ties.end(), 0);
+        std::fill(shares.begin(), shares.end(), 0);
+        std::fill(squares.begin(), squares.end(), 0);
+        trials = 0;
+    }
+
+    uint64_t getTrials() const {
+        return trials;
+    }
+
+    PlayerEquity getPlayer(size_t p) const {
+        PlayerEquity result;
+        if (trials == 0) {
+            return result;
+        }
+        double n = static_cast<double>(trials);
+        double mean = shares[p] / (SHARE_UNIT * n);
+        double mean_square = squares[p] / (SHARE_UNIT * SHARE_UNIT * n);
+        result.win = wins[p] / n;
+        result.tie = ties[p] / n;
+        result.equity = mean;
+        result.std_error = std::sqrt(
+                std::max(0.0, mean_square - mean * mean) / n);
+        return result;
+    }
+
+private:
+    uint64_t trials = 0;
+    std::vector<uint64_t> wins;
+    std::vector<uint64_t> ties;
+    // Pot shares in units of 1/SHARE_UNIT and their squares.
+    std::vector<uint64_t> shares;
+    std::vector<uint64_t> squares;
+};
+
+EquityCalculator::EquityCalculator(const std::vector<HoleCards>& players,
+        const CardSet& board, const CardSet& dead) :
+        board(board), excluded(board), missing_board_cards(5 - board.size()) {
+    if (players.size() < MIN_PLAYERS || players.size() > MAX_PLAYERS) {
+        throw new std::runtime_error(
+                "Invalid number of players: "
+                        + std::to_string(players.size()));
+    }
+    if (board.size() > 5) {
+        throw new std::runtime_error(
+                "Invalid board size: " + std::to_string(board.size()));
+    }
+    for (const Card& card : dead.toCardVector()) {
+        if (excluded.contains(card)) {
+            throw new std::runtime_error("Card used twice: " + card.toString());
+        }
+        excluded.add(card);
+    }
+    for (const HoleCards& player : players) {
+        for (const Card& card : { player.getFirst(), player.getSecond() }) {
+            if (excluded.contains(card)) {
+                throw new std::runtime_error(
+                        "Card used twice: " + card.toString());
+            }
+            excluded.add(card);
+        }
+        hole_cards.push_back(player.toCardSet());
+    }
+    setThreads(0);
+}
+
+void EquityCalculator::setThreads(uint32_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->threads = threads;
+}
+
+template<typename F>
+void EquityCalculator::parallelFor(uint64_t size, uint64_t grain,
+        F f) const {
+    withScheduler(scheduler, [&](TaskScheduler& workers) {
+        workers.parallelFor(0, size, grain, f);
+    }, threads);
+}
+
+EquityResult EquityCalculator::calculate() const {
+    PhiloxDeck deck(excluded, seed);
+    Tally total(hole_cards.size());
+    std::mutex mutex;
+    std::atomic<bool> done { false };
+
+    parallelFor((max_trials + CHUNK_TRIALS - 1) / CHUNK_TRIALS, 1,
+            [&](uint64_t begin, uint64_t end, ScratchArena& arena) {
+        Tally tally(hole_cards.size());
+        HandBlock block(hole_cards, arena);
+        for (uint64_t chunk = begin; chunk < end; ++chunk) {
+            if (done.load(std::memory_order_relaxed)) {
+                return;
+            }
+            PhiloxDeck chunk_deck = deck.split(chunk);
+            uint64_t trials = std::min(CHUNK_TRIALS,
+                    max_trials - chunk * CHUNK_TRIALS);
+            for (uint64_t t = 0; t < trials; ++t) {
+                chunk_deck.shuffle();
+                CardSet full_board = board;
+                for (uint32_t i = 0; i < missing_board_cards; ++i) {
+                    full_board.add(chunk_deck.deal());
+                }
+                block.add(full_board);
+                if (block.full()) {
+                    tally.add(block);
+                }
+            }
+            tally.add(block);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            total.merge(tally);
+            tally.clear();
+            if (targetReached(total)) {
+                done.store(true, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    EquityResult result;
+    result.trials = total.getTrials();
+    for (size_t p = 0; p < hole_cards.size(); ++p) {
+        result.players.push_back(total.getPlayer(p));
+    }
+    return result;
+}
+
+bool EquityCalculator::targetReached(const Tally& tally) const {
+    if (target_std_error <= 0) {
+        return false;
+    }
+    for (size_t p = 0; p < hole_cards.size(); ++p) {
+        if (tally.getPlayer(p).std_error > target_std_error) {
+            return false;
+        }
+    }
+    return true;
+}
+
+EquityResult EquityCalculator::enumerate() const {
+    BoardEnumerator boards(board, excluded, missing_board_cards);
+    Tally total(hole_cards.size());
+    std::mutex mutex;
+
+    parallelFor(boards.size(), ENUMERATION_GRAIN,
+            [&](uint64_t begin, uint64_t end, ScratchArena& arena) {
+        Tally tally(hole_cards.size());
+        HandBlock block(hole_cards, arena);
+        boards.forEach(begin, end, [&](const CardSet& full_board) {
+            block.add(full_board);
+            if (block.full()) {
+                tally.add(block);
+            }
+        });
+        tally.add(block);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        total.merge(tally);
+    });
+
+    EquityResult result;
+    result.trials = total.getTrials();
+    for (size_t p = 0; p < hole_cards.size(); ++p) {
+        PlayerEquity player = total.getPlayer(p);
+        player.std_error = 0;
+        result.players.push_back(player);
+    }
+    return result;
+}
+
+} /* namespace poker */
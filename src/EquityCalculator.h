@@ -0,0 +1,98 @@
+#ifndef EQUITYCALCULATOR_H_
+#define EQUITYCALCULATOR_H_
+
+#include "CardSet.h"
+#include "TaskScheduler.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+struct PlayerEquity {
+    // Probability to win the pot alone.
+    double win = 0;
+    // Probability to split the pot with at least one other player.
+    double tie = 0;
+    // Expected share of the pot.
+    double equity = 0;
+    // Standard error of the equity estimate.
+    double std_error = 0;
+};
+
+struct EquityResult {
+    uint64_t trials = 0;
+    std::vector<PlayerEquity> players;
+};
+
+// Monte Carlo equity of Texas Hold'em hands. Each trial completes the board
+// from the cards not held by any player, on the board or dead.
+//
+// Trials are run in chunks, as tasks of a TaskScheduler. Each chunk deals
+// from its own substream of the calculator seed, see PhiloxDeck::split(),
+// which costs nothing to position. With a fixed seed and no target standard
+// error the result is fully reproducible, whatever the thread count.
+class EquityCalculator {
+public:
+    constexpr static size_t MIN_PLAYERS = 2;
+    constexpr static size_t MAX_PLAYERS = 10;
+    constexpr static uint64_t DEFAULT_MAX_TRIALS = 1000000;
+
+    EquityCalculator(const std::vector<HoleCards>& players,
+            const CardSet& board = CardSet(), const CardSet& dead = CardSet());
+
+    // Threads of the scheduler started for each calculation, defaults to
+    // the number of hardware threads.
+    void setThreads(uint32_t threads);
+
+    // Runs on the scheduler, shared with other calculations, instead of
+    // threads of its own. Null restores the default.
+    void setScheduler(TaskScheduler* scheduler) {
+        this->scheduler = scheduler;
+    }
+
+    void setSeed(uint32_t seed) {
+        this->seed = seed;
+    }
+
+    void setMaxTrials(uint64_t max_trials) {
+        this->max_trials = max_trials;
+    }
+
+    // Stops before max trials once the standard error of every player's
+    // equity is at most the target. Zero (the default) disables early stop.
+    void setTargetStdError(double target_std_error) {
+        this->target_std_error = target_std_error;
+    }
+
+    EquityResult calculate() const;
+
+    // Exact equity over every possible completion of the board, e.g. all
+    // C(48,5) boards of a heads-up preflop all-in. Reports the number of
+    // boards as trials and ignores the trial and standard error settings.
+    EquityResult enumerate() const;
+
+private:
+    class Tally;
+
+    template<typename F>
+    void parallelFor(uint64_t size, uint64_t grain, F f) const;
+    bool targetReached(const Tally& tally) const;
+
+    std::vector<CardSet> hole_cards;
+    CardSet board;
+    CardSet excluded;
+    uint32_t missing_board_cards;
+
+    uint32_t threads;
+    TaskScheduler* scheduler = nullptr;
+    uint32_t seed = PhiloxDeck::DEFAULT_SEED;
+    uint64_t max_trials = DEFAULT_MAX_TRIALS;
+    double target_std_error = 0;
+};
+
+} /* namespace poker */
+
+#endif /* EQUITYCALCULATOR_H_ */
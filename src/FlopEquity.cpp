@@ -0,0 +1,220 @@
+#include "FlopEquity.h"
+
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+namespace poker {
+
+namespace {
+
+// Grain of runouts per task.
+constexpr uint64_t GENERATION_GRAIN = 16;
+
+CardSet canonicalFlop(const CardSet& flop) {
+    if (flop.size() != 3) {
+        throw new std::runtime_error(
+                "Invalid flop size: " + std::to_string(flop.size()));
+    }
+    return std::get<0>(flop.canonicalize());
+}
+
+std::string tableName(const CardSet& canonical) {
+    return "flop_equity_" + canonical.toString();
+}
+
+void fill(const CardSet& flop, HandRankIndex* rankings,
+        TaskScheduler& scheduler) {
+    // The runout of the cards i < j of the deck has number j*(j-1)/2 + i.
+    std::vector<Card> deck;
+    for (int rank = 0; rank < 13; ++rank) {
+        for (int color = 0; color < 4; ++color) {
+            Card card(static_cast<Rank>(rank), static_cast<Color>(color));
+            if (!flop.contains(card)) {
+                deck.push_back(card);
+            }
+        }
+    }
+    scheduler.parallelFor(0, FlopEquity::RUNOUTS, GENERATION_GRAIN,
+            [&](uint64_t begin, uint64_t end, ScratchArena& arena) {
+        CardSet* hands = arena.allocate<CardSet>(Range::COMBOS);
+        HandRanking* ranked = arena.allocate<HandRanking>(Range::COMBOS);
+        uint32_t* slots = arena.allocate<uint32_t>(Range::COMBOS);
+        for (uint64_t runout = begin; runout < end; ++runout) {
+            uint32_t j = 1;
+            while ((j + 1) * j / 2 <= runout) {
+                ++j;
+            }
+            CardSet board = flop;
+            board.add(deck[j]);
+            board.add(deck[runout - j * (j - 1) / 2]);
+            uint64_t board_bits = board.cardBits();
+            size_t count = 0;
+            for (size_t c = 0; c < Range::COMBOS; ++c) {
+                const CardSet& combo = Range::comboCards(c);
+                if (combo.cardBits() & board_bits) {
+                    continue;
+                }
+                hands[count] = board;
+                hands[count].addAll(combo);
+                slots[count++] = c;
+            }
+            CardSet::rankTexasHoldemBatch(hands, ranked, count);
+            HandRankIndex* row = rankings + runout * Range::COMBOS;
+            for (size_t c = 0; c < Range::COMBOS; ++c) {
+                row[c] = FlopEquity::BLOCKED;
+            }
+            for (size_t k = 0; k < count; ++k) {
+                row[slots[k]] = HandRankIndex(ranked[k]);
+            }
+        }
+    });
+}
+
+void fill(const CardSet& canonical, void* payload,
+        TaskScheduler* scheduler) {
+    HandRankIndex* rankings = static_cast<HandRankIndex*>(payload);
+    withScheduler(scheduler, [&](TaskScheduler& workers) {
+        fill(canonical, rankings, workers);
+    });
+}
+
+constexpr size_t TABLE_SIZE = FlopEquity::RUNOUTS * Range::COMBOS
+        * sizeof(HandRankIndex);
+
+}
+
+constexpr uint32_t FlopEquity::VERSION;
+constexpr uint32_t FlopEquity::FLOPS;
+constexpr uint32_t FlopEquity::RUNOUTS;
+constexpr HandRankIndex FlopEquity::BLOCKED;
+
+FlopEquity::FlopEquity(const CardSet& flop, TaskScheduler* scheduler) :
+        FlopEquity(flop, loadTable(tableName(canonicalFlop(flop)), VERSION,
+                TABLE_SIZE, [&](void* payload) {
+                    fill(canonicalFlop(flop), payload, scheduler);
+                })) {
+}
+
+FlopEquity::FlopEquity(const CardSet& flop, TableData data) :
+        flop(flop), permutation(std::get<1>(flop.canonicalize())), data(
+                std::move(data)), rankings(
+                this->data.as<HandRankIndex>()) {
+    if (flop.size() != 3) {
+        throw new std::runtime_error(
+                "Invalid flop size: " + std::to_string(flop.size()));
+    }
+    if (this->data.size() != TABLE_SIZE) {
+        throw new std::runtime_error("Invalid flop equity table size");
+    }
+}
+
+TableData FlopEquity::generate(const CardSet& flop, TaskScheduler* scheduler) {
+    CardSet canonical = canonicalFlop(flop);
+    return TableData::generate(TABLE_SIZE, [&](void* payload) {
+        fill(canonical, payload, scheduler);
+    });
+}
+
+void FlopEquity::generateAll(TaskScheduler* scheduler) {
+    if (getTableDirectory().empty()) {
+        throw new std::runtime_error("No table directory");
+    }
+    for (const CardSet& flop : canonicalFlops()) {
+        FlopEquity table(flop, scheduler);
+    }
+}
+
+std::vector<CardSet> FlopEquity::canonicalFlops() {
+    std::vector<CardSet> flops;
+    std::set<uint64_t> seen;
+    for (size_t c = 0; c < Range::COMBOS; ++c) {
+        HoleCards first = Range::combo(c);
+        for (int rank = 0; rank < 13; ++rank) {
+            for (int color = 0; color < 4; ++color) {
+                Card card(static_cast<Rank>(rank), static_cast<Color>(color));
+                CardSet flop = first.toCardSet();
+                if (flop.contains(card)) {
+                    continue;
+                }
+                flop.add(card);
+                CardSet canonical = std::get<0>(flop.canonicalize());
+                if (seen.insert(canonical.cardBits()).second) {
+                    flops.push_back(canonical);
+                }
+            }
+        }
+    }
+    return flops;
+}
+
+EquityResult FlopEquity::equity(const HoleCards& hand,
+        const Range& range) const {
+    uint64_t hand_bits = hand.toCardSet().cardBits();
+    if (hand_bits & flop.cardBits()) {
+        throw new std::runtime_error(
+                "Hand shares a card with the flop: " + hand.toString());
+    }
+    // Everything in the suits of the canonical flop.
+    size_t hero = Range::comboIndex(permutation.apply(hand.getFirst()),
+            permutation.apply(hand.getSecond()));
+    // Live combinations of the range and their weights.
+    std::vector<uint32_t> villains;
+    std::vector<float> weights;
+    for (size_t c : range.liveCombos(flop)) {
+        HoleCards villain = Range::combo(c);
+        if (villain.toCardSet().cardBits() & hand_bits) {
+            continue;
+        }
+        villains.push_back(Range::comboIndex(
+                permutation.apply(villain.getFirst()),
+                permutation.apply(villain.getSecond())));
+        weights.push_back(range.getWeight(c));
+    }
+    if (villains.empty()) {
+        throw new std::runtime_error("Range without live combinations");
+    }
+
+    // Runouts the hand wins and ties against each combination, and those
+    // the combination is dealt on at all. Branch free, blocked entries
+    // neither lose nor tie.
+    size_t n = villains.size();
+    std::vector<uint16_t> wins(n, 0);
+    std::vector<uint16_t> ties(n, 0);
+    std::vector<uint16_t> dealt(n, 0);
+    const uint16_t blocked = BLOCKED.getIndex();
+    for (uint32_t runout = 0; runout < RUNOUTS; ++runout) {
+        const HandRankIndex* row = rankings + runout * Range::COMBOS;
+        uint16_t own = row[hero].getIndex();
+        if (own == blocked) {
+            continue;
+        }
+        for (size_t k = 0; k < n; ++k) {
+            uint16_t other = row[villains[k]].getIndex();
+            wins[k] += own > other;
+            ties[k] += own == other;
+            dealt[k] += other != blocked;
+        }
+    }
+
+    double win = 0;
+    double tie = 0;
+    double total = 0;
+    EquityResult result;
+    for (size_t k = 0; k < n; ++k) {
+        win += weights[k] * wins[k];
+        tie += weights[k] * ties[k];
+        total += weights[k] * dealt[k];
+        result.trials += dealt[k];
+    }
+    result.players.resize(2);
+    result.players[0].win = win / total;
+    result.players[1].win = (total - win - tie) / total;
+    result.players[0].tie = result.players[1].tie = tie / total;
+    for (PlayerEquity& player : result.players) {
+        player.equity = player.win + player.tie / 2;
+    }
+    return result;
+}
+
+} /* namespace poker */
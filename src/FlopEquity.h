@@ -0,0 +1,79 @@
+#ifndef FLOPEQUITY_H_
+#define FLOPEQUITY_H_
+
+#include "EquityCalculator.h"
+#include "HandRankIndex.h"
+#include "Range.h"
+#include "TableFile.h"
+#include "TaskScheduler.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// Equity of a hand against a weighted range on a flop, without ranking any
+// hands.
+//
+// A flop has C(49, 2) turn and river runouts. The table of a flop holds the
+// HandRankIndex of every combination of hole cards on every runout, one
+// row of Range::COMBOS per runout. An equity is then a pass over the rows
+// counting, per live combination of the range, the runouts the hand wins
+// and ties against it, followed by a dot product of the counts with the
+// range weights.
+//
+// Tables exist for the 1,755 flops that are distinct up to a permutation
+// of the suits, other flops are mapped onto them. A table is about 3 MB,
+// all of them about 5.5 GB, so they are meant to be kept as table files,
+// see loadTable() and generateAll().
+class FlopEquity {
+public:
+    // Bump when the layout or the runout order changes.
+    constexpr static uint32_t VERSION = 1;
+
+    constexpr static uint32_t FLOPS = 1755;
+    // Turn and river cards, C(49, 2).
+    constexpr static uint32_t RUNOUTS = 1176;
+    // Entries of combinations sharing a card with the board.
+    constexpr static HandRankIndex BLOCKED = HandRankIndex(0xffff);
+
+    // Maps the table file of the flop, or generates the table on the
+    // scheduler (all hardware threads without one) and writes it to the
+    // table directory.
+    explicit FlopEquity(const CardSet& flop, TaskScheduler* scheduler =
+            nullptr);
+
+    // A table of generate() for the same flop, or mapped elsewhere.
+    FlopEquity(const CardSet& flop, TableData data);
+
+    // Generates the table of the flop in memory.
+    static TableData generate(const CardSet& flop, TaskScheduler* scheduler =
+            nullptr);
+
+    // Writes the table files of all canonical flops missing from the table
+    // directory. Throws if there is none.
+    static void generateAll(TaskScheduler* scheduler = nullptr);
+
+    // The canonical flops, see CardSet::canonicalize().
+    static std::vector<CardSet> canonicalFlops();
+
+    // Exact equity of the hand (first player) against the range (second
+    // player) over all runouts, weighting each combination by its range
+    // weight. Reports the runouts of all matchups as trials. Throws if the
+    // hand shares a card with the flop or the range has no live
+    // combinations.
+    EquityResult equity(const HoleCards& hand, const Range& range) const;
+
+private:
+    CardSet flop;
+    // Maps the flop onto the canonical one of the table.
+    SuitPermutation permutation;
+    TableData data;
+    const HandRankIndex* rankings;
+};
+
+} /* namespace poker */
+
+#endif /* FLOPEQUITY_H_ */
@@ -0,0 +1,347 @@
+#include "HandBuckets.h"
+#include "BoardEnumerator.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace poker {
+
+namespace {
+
+// Grain of hands per task of the k-means steps.
+constexpr uint64_t CLUSTER_GRAIN = 4096;
+
+// The canonical hands of all boards as points of the metric.
+struct Points {
+    size_t size() const {
+        return weights.size();
+    }
+
+    const float* operator[](size_t i) const {
+        return values.data() + i * dimensions;
+    }
+
+    size_t dimensions;
+    std::vector<float> values;
+    // Number of hands each point stands for.
+    std::vector<float> weights;
+    std::vector<float> ehs;
+    // Entry of the point in the table, board * Range::COMBOS + combination.
+    std::vector<uint32_t> slots;
+};
+
+void addPoint(Points& points, const HandFeatures& features,
+        HandBuckets::Metric metric, float weight, uint32_t slot) {
+    if (metric == HandBuckets::Metric::FEATURES) {
+        points.values.push_back(features.ehs);
+        points.values.push_back(features.ehs2);
+        points.values.push_back(features.ppot);
+        points.values.push_back(features.npot);
+    } else {
+        // The earth mover's distance of one-dimensional histograms is the
+        // L1 distance of their cumulative sums.
+        float sum = 0;
+        for (float bin : features.histogram) {
+            sum += bin;
+            points.values.push_back(sum);
+        }
+    }
+    points.weights.push_back(weight);
+    points.ehs.push_back(features.ehs);
+    points.slots.push_back(slot);
+}
+
+// Squared Euclidean distance, or the earth mover's distance.
+float distance(const float* a, const float* b, size_t dimensions,
+        HandBuckets::Metric metric) {
+    float result = 0;
+    for (size_t d = 0; d < dimensions; ++d) {
+        float difference = a[d] - b[d];
+        result += metric == HandBuckets::Metric::FEATURES ?
+                difference * difference : std::abs(difference);
+    }
+    return result;
+}
+
+// Uniform in [0, 1), from block i of the Philox stream of the seed.
+double uniform(uint64_t seed, uint64_t i) {
+    uint32_t words[4];
+    PhiloxRandom::generate(seed, 0, i, words);
+    uint64_t bits = static_cast<uint64_t>(words[0]) << 21 | words[1] >> 11;
+    return bits * (1.0 / (static_cast<uint64_t>(1) << 53));
+}
+
+// Index of the point at the fraction of the running sum of the weights.
+size_t sample(const std::vector<double>& weights, double fraction) {
+    double total = 0;
+    for (double weight : weights) {
+        total += weight;
+    }
+    if (total == 0) {
+        return weights.size();
+    }
+    double target = fraction * total;
+    double sum = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        sum += weights[i];
+        if (weights[i] > 0 && sum > target) {
+            return i;
+        }
+    }
+    return weights.size() - 1;
+}
+
+// Picks the initial centers by k-means++: each further center is a point
+// drawn with probability proportional to its weight times its distance to
+// the nearest center so far.
+std::vector<float> seedCenters(const Points& points,
+        const HandBuckets::Config& config, TaskScheduler& scheduler) {
+    const size_t n = points.size();
+    const size_t dimensions = points.dimensions;
+    std::vector<double> cost(points.weights.begin(), points.weights.end());
+    std::vector<float> nearest(n, std::numeric_limits<float>::max());
+    std::vector<float> centers(config.buckets * dimensions);
+    for (uint32_t k = 0; k < config.buckets; ++k) {
+        size_t chosen = sample(cost, uniform(config.seed, k));
+        if (chosen == n) {
+            // Fewer distinct points than buckets.
+            chosen = k % n;
+        }
+        float* center = centers.data() + k * dimensions;
+        std::copy(points[chosen], points[chosen] + dimensions, center);
+        scheduler.parallelFor(0, n, CLUSTER_GRAIN,
+                [&](uint64_t begin, uint64_t end, ScratchArena&) {
+            for (uint64_t i = begin; i < end; ++i) {
+                nearest[i] = std::min(nearest[i], distance(points[i], center,
+                        dimensions, config.metric));
+                cost[i] = points.weights[i] * nearest[i];
+            }
+        });
+    }
+    return centers;
+}
+
+// Lloyd's iterations from the k-means++ centers. Returns the bucket of
+// every point.
+std::vector<uint16_t> cluster(const Points& points,
+        const HandBuckets::Config& config, TaskScheduler& scheduler) {
+    const size_t n = points.size();
+    const size_t dimensions = points.dimensions;
+    const uint32_t k = config.buckets;
+    std::vector<float> centers = seedCenters(points, config, scheduler);
+    std::vector<uint16_t> assignment(n, HandBuckets::NO_BUCKET);
+    for (uint32_t iteration = 0; iteration < config.iterations; ++iteration) {
+        std::atomic<uint64_t> changed(0);
+        scheduler.parallelFor(0, n, CLUSTER_GRAIN,
+                [&](uint64_t begin, uint64_t end, ScratchArena&) {
+            uint64_t changes = 0;
+            for (uint64_t i = begin; i < end; ++i) {
+                uint16_t best = 0;
+                float best_distance = std::numeric_limits<float>::max();
+                for (uint32_t c = 0; c < k; ++c) {
+                    float d = distance(points[i],
+                            centers.data() + c * dimensions, dimensions,
+                            config.metric);
+                    if (d < best_distance) {
+                        best = c;
+                        best_distance = d;
+                    }
+                }
+                if (assignment[i] != best) {
+                    assignment[i] = best;
+                    changes++;
+                }
+            }
+            changed += changes;
+        });
+        if (changed == 0) {
+            break;
+        }
+        // Weighted means; a bucket left without points keeps its center.
+        std::vector<double> sums(k * dimensions, 0);
+        std::vector<double> weights(k, 0);
+        for (size_t i = 0; i < n; ++i) {
+            double* sum = sums.data() + assignment[i] * dimensions;
+            for (size_t d = 0; d < dimensions; ++d) {
+                sum[d] += points.weights[i] * points[i][d];
+            }
+            weights[assignment[i]] += points.weights[i];
+        }
+        for (uint32_t c = 0; c < k; ++c) {
+            if (weights[c] == 0) {
+                continue;
+            }
+            for (size_t d = 0; d < dimensions; ++d) {
+                centers[c * dimensions + d] = sums[c * dimensions + d]
+                        / weights[c];
+            }
+        }
+    }
+
+    // Renumbers the buckets by ascending mean EHS.
+    std::vector<double> ehs(k, 0);
+    std::vector<double> weights(k, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ehs[assignment[i]] += points.weights[i] * points.ehs[i];
+        weights[assignment[i]] += points.weights[i];
+    }
+    std::vector<uint16_t> order(k);
+    for (uint32_t c = 0; c < k; ++c) {
+        order[c] = c;
+        ehs[c] = weights[c] > 0 ? ehs[c] / weights[c] : 0;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](uint16_t a, uint16_t b) {
+        return ehs[a] < ehs[b];
+    });
+    std::vector<uint16_t> bucket(k);
+    for (uint32_t c = 0; c < k; ++c) {
+        bucket[order[c]] = c;
+    }
+    for (uint16_t& a : assignment) {
+        a = bucket[a];
+    }
+    return assignment;
+}
+
+}
+
+constexpr uint32_t HandBuckets::VERSION;
+constexpr const char* HandBuckets::TABLE_NAME;
+constexpr uint16_t HandBuckets::NO_BUCKET;
+
+TableData HandBuckets::build(const std::vector<CardSet>& boards,
+        const Config& config, TaskScheduler* scheduler) {
+    if (boards.empty()) {
+        throw new std::runtime_error("No boards to build buckets for");
+    }
+    if (config.buckets == 0 || config.buckets >= NO_BUCKET) {
+        throw new std::runtime_error(
+                "Invalid bucket count: " + std::to_string(config.buckets));
+    }
+    if (config.iterations == 0) {
+        throw new std::runtime_error("No k-means iterations");
+    }
+    const uint32_t board_cards = boards.front().size();
+    std::map<uint64_t, CardSet> canonical;
+    for (const CardSet& board : boards) {
+        if (board.size() != board_cards || board_cards < 3
+                || board_cards > 5) {
+            throw new std::runtime_error(
+                    "Invalid board size: " + std::to_string(board.size()));
+        }
+        CardSet form = std::get<0>(board.canonicalize());
+        canonical.insert(std::make_pair(form.cardBits(), form));
+    }
+
+    Points points;
+    points.dimensions = config.metric == Metric::FEATURES ?
+            4 : HandFeatures::HISTOGRAM_BINS;
+    std::vector<uint16_t> assignment;
+    // One scheduler for the features of all boards and the clustering.
+    withScheduler(scheduler, [&](TaskScheduler& workers) {
+        uint32_t b = 0;
+        for (const auto& entry : canonical) {
+            const CardSet& board = entry.second;
+            std::vector<HandFeatures> features = HandFeatures::compute(board,
+                    &workers);
+            for (size_t c = 0; c < Range::COMBOS; ++c) {
+                const CardSet& hole = Range::comboCards(c);
+                if ((hole.cardBits() & board.cardBits())
+                        || std::get<1>(board.canonicalize(hole)).cardBits()
+                                != hole.cardBits()) {
+                    continue;
+                }
+                addPoint(points, features[c], config.metric,
+                        board.multiplicity(hole), b * Range::COMBOS + c);
+            }
+            b++;
+        }
+        assignment = cluster(points, config, workers);
+    });
+
+    const size_t count = canonical.size();
+    size_t size = sizeof(Header) + count * sizeof(uint64_t)
+            + count * Range::COMBOS * sizeof(uint16_t);
+    return TableData::generate(size, [&](void* payload) {
+        Header* header = static_cast<Header*>(payload);
+        header->board_cards = board_cards;
+        header->boards = count;
+        header->buckets = config.buckets;
+        uint64_t* keys = reinterpret_cast<uint64_t*>(header + 1);
+        for (const auto& entry : canonical) {
+            *keys++ = entry.first;
+        }
+        uint16_t* buckets = reinterpret_cast<uint16_t*>(keys);
+        std::fill(buckets, buckets + count * Range::COMBOS, NO_BUCKET);
+        for (size_t i = 0; i < points.size(); ++i) {
+            buckets[points.slots[i]] = assignment[i];
+        }
+    });
+}
+
+std::vector<CardSet> HandBuckets::canonicalBoards(uint32_t cards) {
+    if (cards < 3 || cards > 5) {
+        throw new std::runtime_error(
+                "Invalid board size: " + std::to_string(cards));
+    }
+    std::map<uint64_t, CardSet> canonical;
+    BoardEnumerator(CardSet(), CardSet(), cards).forEach(
+            [&](const CardSet& board) {
+        CardSet form = std::get<0>(board.canonicalize());
+        canonical.insert(std::make_pair(form.cardBits(), form));
+    });
+    std::vector<CardSet> result;
+    for (const auto& entry : canonical) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+HandBuckets::HandBuckets(TableData data) :
+        data(std::move(data)), header(this->data.as<Header>()), boards(
+                nullptr), buckets(nullptr) {
+    if (this->data.size() < sizeof(Header)) {
+        throw new std::runtime_error("Invalid hand bucket table size");
+    }
+    const size_t count = header->boards;
+    if (this->data.size() != sizeof(Header) + count * sizeof(uint64_t)
+            + count * Range::COMBOS * sizeof(uint16_t)
+            || header->board_cards < 3 || header->board_cards > 5
+            || header->buckets == 0 || header->buckets >= NO_BUCKET) {
+        throw new std::runtime_error("Invalid hand bucket table");
+    }
+    boards = reinterpret_cast<const uint64_t*>(header + 1);
+    buckets = reinterpret_cast<const uint16_t*>(boards + count);
+}
+
+uint64_t HandBuckets::getHandIndex(const HoleCards& hole,
+        const CardSet& board) const {
+    if (board.size() != header->board_cards) {
+        throw new std::runtime_error(
+                "Invalid board size: " + std::to_string(board.size()));
+    }
+    CardSet cards = hole.toCardSet();
+    if (cards.cardBits() & board.cardBits()) {
+        throw new std::runtime_error(
+                "Hand shares a card with the board: " + hole.toString());
+    }
+    auto canonical = board.canonicalize(cards);
+    uint64_t key = std::get<0>(canonical).cardBits();
+    const uint64_t* end = boards + header->boards;
+    const uint64_t* found = std::lower_bound(boards, end, key);
+    if (found == end || *found != key) {
+        throw new std::runtime_error(
+                "Board not in the table: " + board.toString());
+    }
+    std::vector<Card> canonical_hole = std::get<1>(canonical).toCardVector();
+    return (found - boards) * Range::COMBOS
+            + Range::comboIndex(canonical_hole[0], canonical_hole[1]);
+}
+
+} /* namespace poker */
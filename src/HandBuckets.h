@@ -0,0 +1,116 @@
+#ifndef HANDBUCKETS_H_
+#define HANDBUCKETS_H_
+
+#include "HandFeatures.h"
+#include "TableFile.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// A card abstraction of one street: every hand, up to a permutation of the
+// suits, mapped to one of a few buckets of hands with similar features.
+//
+// build() computes the HandFeatures of all canonical (board, hole cards)
+// pairs of the given boards and clusters them by k-means, seeded by
+// k-means++ and weighted by the number of hands each pair stands for.
+// Buckets are numbered by ascending mean expected hand strength. The
+// result is the payload of a table file: the canonical boards, sorted,
+// followed by one bucket per board and Range::comboIndex() of the
+// canonical hole cards, so a lookup is a canonicalization, a binary search
+// and a load from the mapped file.
+//
+// The features of all flops, or all turns, take a few minutes on one core,
+// those of all rivers gigabytes of memory. Building a street is an offline
+// job whose table file every process then maps.
+class HandBuckets {
+public:
+    // Bump when the layout or the clustering changes.
+    constexpr static uint32_t VERSION = 1;
+    // Kind of the table files.
+    constexpr static const char* TABLE_NAME = "hand_buckets";
+    // Entries of hands that are not canonical or share a card with the
+    // board.
+    constexpr static uint16_t NO_BUCKET = 0xffff;
+
+    enum class Metric {
+        // Euclidean distance of the EHS, EHS², PPot and NPot.
+        FEATURES,
+        // Earth mover's distance of the river hand strength histograms,
+        // which tells draws from made hands of the same EHS.
+        EARTH_MOVER,
+    };
+
+    struct Config {
+        uint32_t buckets = 8;
+        Metric metric = Metric::EARTH_MOVER;
+        // Most rounds of k-means, which stops early once no hand changes
+        // its bucket.
+        uint32_t iterations = 100;
+        uint64_t seed = 1;
+    };
+
+    // Clusters the hands of the boards, all with the same number of cards,
+    // on the scheduler (all hardware threads without one). Boards that are
+    // not canonical are canonicalized. Throws without boards, for boards
+    // of different or invalid sizes, without 1 to 65,534 buckets or
+    // without iterations.
+    static TableData build(const std::vector<CardSet>& boards,
+            const Config& config, TaskScheduler* scheduler = nullptr);
+
+    // The canonical boards of three to five cards, sorted by their card
+    // bits, see CardSet::canonicalize().
+    static std::vector<CardSet> canonicalBoards(uint32_t cards);
+
+    // A table of build(), or mapped from a file written with it. Throws if
+    // the table is malformed.
+    explicit HandBuckets(TableData data);
+
+    uint32_t getBoardCards() const {
+        return header->board_cards;
+    }
+
+    uint32_t getBoardCount() const {
+        return header->boards;
+    }
+
+    uint32_t getBucketCount() const {
+        return header->buckets;
+    }
+
+    // Index of the canonical form of the hand in the table, equal for all
+    // hands that are the same up to a permutation of the suits. Throws if
+    // the board has the wrong size, the hole cards share a card with it or
+    // the table has no such board.
+    uint64_t getHandIndex(const HoleCards& hole, const CardSet& board) const;
+
+    uint16_t getBucket(uint64_t index) const {
+        return buckets[index];
+    }
+
+    uint16_t getBucket(const HoleCards& hole, const CardSet& board) const {
+        return buckets[getHandIndex(hole, board)];
+    }
+
+private:
+    // In front of the boards in the payload.
+    struct Header {
+        uint32_t board_cards;
+        uint32_t boards;
+        uint32_t buckets;
+        uint32_t reserved;
+    };
+
+    TableData data;
+    const Header* header;
+    // CardSet::cardBits() of the canonical boards, ascending.
+    const uint64_t* boards;
+    const uint16_t* buckets;
+};
+
+} /* namespace poker */
+
+#endif /* HANDBUCKETS_H_ */
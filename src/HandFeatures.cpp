@@ -0,0 +1,296 @@
+#include "HandFeatures.h"
+#include "BoardEnumerator.h"
+#include "HandRankIndex.h"
+#include "RiverRanks.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+namespace poker {
+
+namespace {
+
+// Grain of runouts per task.
+constexpr uint64_t RUNOUT_GRAIN = 8;
+
+// Of a hand against an opponent, on the current board or at the river.
+enum Relation {
+    AHEAD, TIED, BEHIND,
+};
+
+// Numbers of combinations per position of the current rankings, in total
+// and of those holding each card, as Fenwick trees.
+class CardCounts {
+public:
+    CardCounts(size_t positions, ScratchArena& arena) :
+            positions(positions), trees(
+                    arena.allocate<int32_t>(
+                            (Range::CARD_VALUES + 1) * (positions + 1))) {
+    }
+
+    void add(size_t position, uint8_t first, uint8_t second, int32_t delta) {
+        int32_t* total = tree(Range::CARD_VALUES);
+        int32_t* a = tree(first);
+        int32_t* b = tree(second);
+        for (size_t i = position + 1; i <= positions; i += i & -i) {
+            total[i] += delta;
+            a[i] += delta;
+            b[i] += delta;
+        }
+    }
+
+    // Of the combinations not holding either card, those the hand at the
+    // position is ahead of, tied with and behind on the current board.
+    // With contained, the hand itself was added, which the card trees
+    // subtract twice.
+    void split(size_t position, uint8_t first, uint8_t second,
+            bool contained, int32_t* out) const {
+        int32_t lower = countBelow(position, first, second);
+        int32_t upto = countBelow(position + 1, first, second) + contained;
+        int32_t all = countBelow(positions, first, second) + contained;
+        out[AHEAD] = lower;
+        out[TIED] = upto - lower;
+        out[BEHIND] = all - upto;
+    }
+
+private:
+    int32_t* tree(size_t t) const {
+        return trees + t * (positions + 1);
+    }
+
+    int32_t countBelow(size_t end, uint8_t first, uint8_t second) const {
+        const int32_t* total = tree(Range::CARD_VALUES);
+        const int32_t* a = tree(first);
+        const int32_t* b = tree(second);
+        int32_t count = 0;
+        for (size_t i = end; i > 0; i -= i & -i) {
+            count += total[i] - a[i] - b[i];
+        }
+        return count;
+    }
+
+    size_t positions;
+    int32_t* trees;
+};
+
+// Sums over the runouts of one hand.
+struct Tally {
+    void merge(const Tally& other) {
+        for (int now = 0; now < 3; ++now) {
+            for (int river = 0; river < 3; ++river) {
+                potential[now][river] += other.potential[now][river];
+            }
+        }
+        runouts += other.runouts;
+        strength += other.strength;
+        squared += other.squared;
+        for (size_t b = 0; b < HandFeatures::HISTOGRAM_BINS; ++b) {
+            histogram[b] += other.histogram[b];
+        }
+    }
+
+    // Opponents by the relation on the current board and at the river.
+    uint32_t potential[3][3];
+    uint32_t runouts;
+    // Of the hand strength at the river.
+    double strength;
+    double squared;
+    uint32_t histogram[HandFeatures::HISTOGRAM_BINS];
+};
+
+// Position of the current ranking of every live combination.
+struct Combos {
+    uint16_t position[Range::COMBOS];
+    size_t positions;
+};
+
+void rankCurrent(const CardSet* hands, HandRanking* out, size_t n,
+        uint32_t cards) {
+    switch (cards) {
+    case 5:
+        CardSet::rankBatch<5>(hands, out, n);
+        break;
+    case 6:
+        CardSet::rankBatch<6>(hands, out, n);
+        break;
+    default:
+        CardSet::rankBatch<7>(hands, out, n);
+        break;
+    }
+}
+
+Combos rankCombos(const CardSet& board) {
+    Combos combos;
+    std::vector<CardSet> hands;
+    std::vector<uint16_t> live;
+    uint64_t board_bits = board.cardBits();
+    for (size_t c = 0; c < Range::COMBOS; ++c) {
+        const CardSet& combo = Range::comboCards(c);
+        combos.position[c] = 0;
+        if (combo.cardBits() & board_bits) {
+            continue;
+        }
+        hands.push_back(board);
+        hands.back().addAll(combo);
+        live.push_back(c);
+    }
+    std::vector<HandRanking> ranked(hands.size());
+    rankCurrent(hands.data(), ranked.data(), hands.size(), board.size() + 2);
+    std::vector<HandRankIndex> indexes(hands.size());
+    HandRankIndex::fromHandRankings(ranked.data(), indexes.data(),
+            hands.size());
+
+    std::vector<uint16_t> values;
+    for (HandRankIndex index : indexes) {
+        values.push_back(index.getIndex());
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    for (size_t k = 0; k < live.size(); ++k) {
+        combos.position[live[k]] = std::lower_bound(values.begin(),
+                values.end(), indexes[k].getIndex()) - values.begin();
+    }
+    combos.positions = values.size();
+    return combos;
+}
+
+// Adds the runout to the tallies, sweeping its tie groups in ascending
+// order: below holds the combinations of lower groups, group those of the
+// current one and all every live one.
+void sweep(const RiverRanks& river, const Combos& combos, CardCounts& all,
+        CardCounts& below, CardCounts& group, Tally* tallies) {
+    const uint16_t* position = combos.position;
+    const Range::ComboCardValues& cards = Range::comboCardValues();
+    const uint8_t* first = cards.first;
+    const uint8_t* second = cards.second;
+    for (size_t i = 0; i < RiverRanks::COMBOS; ++i) {
+        uint16_t c = river.getCombo(i);
+        all.add(position[c], first[c], second[c], 1);
+    }
+    const std::vector<uint16_t>& groups = river.getGroups();
+    for (size_t g = 0; g + 1 < groups.size(); ++g) {
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            uint16_t c = river.getCombo(i);
+            group.add(position[c], first[c], second[c], 1);
+        }
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            uint16_t c = river.getCombo(i);
+            int32_t beaten[3];
+            int32_t tied[3];
+            int32_t dealt[3];
+            below.split(position[c], first[c], second[c], false, beaten);
+            group.split(position[c], first[c], second[c], true, tied);
+            all.split(position[c], first[c], second[c], true, dealt);
+            Tally& tally = tallies[c];
+            int32_t wins = 0;
+            int32_t ties = 0;
+            int32_t count = 0;
+            for (int now = 0; now < 3; ++now) {
+                tally.potential[now][AHEAD] += beaten[now];
+                tally.potential[now][TIED] += tied[now];
+                tally.potential[now][BEHIND] += dealt[now] - beaten[now]
+                        - tied[now];
+                wins += beaten[now];
+                ties += tied[now];
+                count += dealt[now];
+            }
+            double strength = (wins + ties / 2.0) / count;
+            tally.runouts++;
+            tally.strength += strength;
+            tally.squared += strength * strength;
+            size_t bin = std::min(static_cast<size_t>(
+                    strength * HandFeatures::HISTOGRAM_BINS),
+                    HandFeatures::HISTOGRAM_BINS - 1);
+            tally.histogram[bin]++;
+        }
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            uint16_t c = river.getCombo(i);
+            below.add(position[c], first[c], second[c], 1);
+            group.add(position[c], first[c], second[c], -1);
+        }
+    }
+    // Empties the trees for the next runout.
+    for (size_t i = 0; i < RiverRanks::COMBOS; ++i) {
+        uint16_t c = river.getCombo(i);
+        all.add(position[c], first[c], second[c], -1);
+        below.add(position[c], first[c], second[c], -1);
+    }
+}
+
+HandFeatures toFeatures(const Tally& tally) {
+    HandFeatures features;
+    const uint32_t (&p)[3][3] = tally.potential;
+    double now[3] = { };
+    for (int n = 0; n < 3; ++n) {
+        for (int r = 0; r < 3; ++r) {
+            now[n] += p[n][r];
+        }
+    }
+    features.strength = (now[AHEAD] + now[TIED] / 2)
+            / (now[AHEAD] + now[TIED] + now[BEHIND]);
+    features.ehs = tally.strength / tally.runouts;
+    features.ehs2 = tally.squared / tally.runouts;
+    double behind = now[BEHIND] + now[TIED] / 2;
+    if (behind > 0) {
+        features.ppot = (p[BEHIND][AHEAD] + p[BEHIND][TIED] / 2.0
+                + p[TIED][AHEAD] / 2.0) / behind;
+    }
+    double ahead = now[AHEAD] + now[TIED] / 2;
+    if (ahead > 0) {
+        features.npot = (p[AHEAD][BEHIND] + p[TIED][BEHIND] / 2.0
+                + p[AHEAD][TIED] / 2.0) / ahead;
+    }
+    for (size_t b = 0; b < HandFeatures::HISTOGRAM_BINS; ++b) {
+        features.histogram[b] = static_cast<float>(tally.histogram[b])
+                / tally.runouts;
+    }
+    return features;
+}
+
+void fill(const CardSet& board, HandFeatures* features,
+        TaskScheduler& scheduler) {
+    const Combos combos = rankCombos(board);
+    BoardEnumerator runouts(board, board, 5 - board.size());
+    std::vector<Tally> total(Range::COMBOS, Tally());
+    std::mutex mutex;
+    scheduler.parallelFor(0, runouts.size(), RUNOUT_GRAIN,
+            [&](uint64_t begin, uint64_t end, ScratchArena& arena) {
+        Tally* tallies = arena.allocate<Tally>(Range::COMBOS);
+        CardCounts all(combos.positions, arena);
+        CardCounts below(combos.positions, arena);
+        CardCounts group(combos.positions, arena);
+        runouts.forEach(begin, end, [&](const CardSet& river_board) {
+            sweep(RiverRanks(river_board), combos, all, below, group,
+                    tallies);
+        });
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t c = 0; c < Range::COMBOS; ++c) {
+            total[c].merge(tallies[c]);
+        }
+    });
+    for (size_t c = 0; c < Range::COMBOS; ++c) {
+        if (total[c].runouts > 0) {
+            features[c] = toFeatures(total[c]);
+        }
+    }
+}
+
+}
+
+constexpr size_t HandFeatures::HISTOGRAM_BINS;
+
+std::vector<HandFeatures> HandFeatures::compute(const CardSet& board,
+        TaskScheduler* scheduler) {
+    if (board.size() < 3 || board.size() > 5) {
+        throw new std::runtime_error(
+                "Invalid board size: " + std::to_string(board.size()));
+    }
+    std::vector<HandFeatures> features(Range::COMBOS);
+    withScheduler(scheduler, [&](TaskScheduler& workers) {
+        fill(board, features.data(), workers);
+    });
+    return features;
+}
+
+} /* namespace poker */
@@ -0,0 +1,54 @@
+#ifndef HANDFEATURES_H_
+#define HANDFEATURES_H_
+
+#include "Range.h"
+#include "TaskScheduler.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// Strength and potential of a hand on a flop, turn or river against a
+// random opponent, the inputs of a card abstraction (see HandBuckets).
+//
+// All values are exact: every runout of the board and every opponent hand
+// not sharing a card counts once. They are computed for all combinations
+// of a board at once. Each runout ranks the combinations in order (see
+// RiverRanks), and a sweep over its tie groups counts, per hand, the
+// opponents it beats, ties and loses to at the river, split by whether it
+// is ahead, tied or behind them on the current board. The split comes from
+// Fenwick trees over the positions of the current rankings, one per card
+// on top of the total, so card removal is exact and a runout costs
+// O(n log n) rather than a comparison per pair of combinations.
+struct HandFeatures {
+    constexpr static size_t HISTOGRAM_BINS = 10;
+
+    // Opponent hands beaten on the current board, ties counting half.
+    double strength = 0;
+    // Expected hand strength at the river, over the runouts, and the
+    // expectation of its square, which favors drawing hands.
+    double ehs = 0;
+    double ehs2 = 0;
+    // Chance to get ahead of an opponent the hand is behind now, and to
+    // fall behind one it is ahead of, ties counting half. Zero on the
+    // river.
+    double ppot = 0;
+    double npot = 0;
+    // Distribution of the hand strength at the river: the fraction of the
+    // runouts per bin of equal width.
+    float histogram[HISTOGRAM_BINS] = { };
+
+    // Features of every combination on the board of three to five cards,
+    // indexed by Range::comboIndex(), on the scheduler (all hardware
+    // threads without one). Entries of combinations sharing a card with
+    // the board are left zero. Throws for other board sizes.
+    static std::vector<HandFeatures> compute(const CardSet& board,
+            TaskScheduler* scheduler = nullptr);
+};
+
+} /* namespace poker */
+
+#endif /* HANDFEATURES_H_ */
@@ -0,0 +1,85 @@
+#include "HandRankIndex.h"
+
+namespace poker {
+
+constexpr uint16_t HandRankIndex::COUNT;
+
+struct HandRankIndex::Tables {
+    uint64_t values[COUNT];
+    // Colex rank of every set of ranks among those of its size, and the
+    // class of the five rank sets within high cards and flushes.
+    uint16_t colex[1 << 13];
+    uint16_t no_straight[1 << 13];
+};
+
+const HandRankIndex::Tables& HandRankIndex::loadTables() {
+    static Tables t;
+    for (u32 i = 0; i < COUNT; ++i) {
+        t.values[i] = toValue(i);
+    }
+    for (u32 ranks = 0; ranks < (1 << 13); ++ranks) {
+        t.colex[ranks] = colex(ranks);
+        t.no_straight[ranks] =
+                __builtin_popcount(ranks) == 5 ? noStraightIndex(ranks) : 0;
+    }
+    return t;
+}
+
+const HandRankIndex::Tables& HandRankIndex::tables = loadTables();
+
+namespace {
+
+// The ranks of rank bits at 2 * rank + 3.
+inline uint32_t compressCounts(uint32_t bits) {
+    uint32_t x = (bits >> 3) & 0x55555555;
+    x = (x | x >> 1) & 0x33333333;
+    x = (x | x >> 2) & 0x0f0f0f0f;
+    x = (x | x >> 4) & 0x00ff00ff;
+    return (x | x >> 8) & 0xffff;
+}
+
+}
+
+// fromParts() with the sets of ranks looked up.
+uint16_t HandRankIndex::lookup(uint64_t value) {
+    u32 category = value >> HandRanking::RANKING_SHIFT;
+    u32 height = (value >> 32) & 0x0fffffff;
+    u32 side = value;
+    u32 base = offset(category);
+    switch (category) {
+    case HandRanking::HIGH_CARD:
+        return base + tables.no_straight[compressCounts(side)];
+    case HandRanking::ONE_PAIR:
+        return base + countRank(height) * 220 + tables.colex[squeeze(
+                compressCounts(side), countRank(height))];
+    case HandRanking::TWO_PAIRS: {
+        u32 pairs = compressCounts(height);
+        return base + tables.colex[pairs] * 11 + without(countRank(side),
+                lowRank(pairs), highRank(pairs));
+    }
+    case HandRanking::THREE_OF_A_KIND:
+        return base + countRank(height) * 66 + tables.colex[squeeze(
+                compressCounts(side), countRank(height))];
+    case HandRanking::FLUSH:
+        return base + tables.no_straight[side >> 1];
+    default:
+        // Single ranks, cheap to compute.
+        return fromParts(category, height, side);
+    }
+}
+
+void HandRankIndex::fromHandRankings(const HandRanking* in,
+        HandRankIndex* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i].index = lookup(in[i].value);
+    }
+}
+
+void HandRankIndex::toHandRankings(const HandRankIndex* in, HandRanking* out,
+        size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = HandRanking(tables.values[in[i].index]);
+    }
+}
+
+} /* namespace poker */
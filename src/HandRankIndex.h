@@ -0,0 +1,266 @@
+#ifndef HANDRANKINDEX_H_
+#define HANDRANKINDEX_H_
+
+#include "CardSet.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// Dense 16-bit form of a HandRanking: the number of the five card
+// equivalence class, from 0 (7-5-4-3-2) to 7461 (royal flush), in the order
+// of the rankings. A quarter of the size, so large arrays of rankings stay
+// in cache and compare with 16-bit SIMD.
+//
+// Within each category the class number is the rank of its cards in the
+// combinatorial number system: sets of ranks in colex order, which is the
+// order of comparing them from the highest rank down. High cards and flushes
+// skip the ten sets that are straights. The conversions are computed, not
+// looked up, so they work in constant expressions.
+class HandRankIndex {
+public:
+    constexpr static uint16_t COUNT = 7462;
+
+    constexpr HandRankIndex() :
+            index(0) {
+    }
+
+    constexpr explicit HandRankIndex(uint16_t index) :
+            index(index) {
+    }
+
+    // Any ranking returned by the rank functions, of five to seven cards.
+    constexpr explicit HandRankIndex(HandRanking ranking) :
+            index(fromValue(ranking.value)) {
+    }
+
+    constexpr uint16_t getIndex() const {
+        return index;
+    }
+
+    constexpr HandRanking toHandRanking() const {
+        return HandRanking(toValue(index));
+    }
+
+    constexpr bool operator<(const HandRankIndex& o) const {
+        return index < o.index;
+    }
+    constexpr bool operator==(const HandRankIndex& o) const {
+        return index == o.index;
+    }
+    constexpr bool operator!=(const HandRankIndex& o) const {
+        return index != o.index;
+    }
+    constexpr bool operator>(const HandRankIndex& o) const {
+        return index > o.index;
+    }
+    constexpr bool operator<=(const HandRankIndex& o) const {
+        return index <= o.index;
+    }
+    constexpr bool operator>=(const HandRankIndex& o) const {
+        return index >= o.index;
+    }
+
+    // Batch conversions, at runtime backed by small tables derived from the
+    // constexpr functions.
+    static void fromHandRankings(const HandRanking* in, HandRankIndex* out,
+            size_t n);
+
+    static void toHandRankings(const HandRankIndex* in, HandRanking* out,
+            size_t n);
+
+private:
+    struct Tables;
+
+    static const Tables& tables;
+    static const Tables& loadTables();
+
+    static uint16_t lookup(uint64_t value);
+
+    typedef uint32_t u32;
+
+    // First class of each category.
+    constexpr static u32 offset(u32 category) {
+        return category == 0 ? 0 : category == 1 ? 1277 :
+                category == 2 ? 4137 : category == 3 ? 4995 :
+                category == 4 ? 5853 : category == 5 ? 5863 :
+                category == 6 ? 7140 : category == 7 ? 7296 : 7452;
+    }
+
+    constexpr static u32 choose(u32 n, u32 k) {
+        return k == 0 ? 1 : n < k ? 0 : choose(n - 1, k - 1) * n / k;
+    }
+
+    // Rank of a set of ranks among those of its size, in colex order.
+    constexpr static u32 colex(u32 ranks, u32 i = 0) {
+        return ranks == 0 ? 0 : choose(__builtin_ctz(ranks), i + 1)
+                + colex(ranks & (ranks - 1), i + 1);
+    }
+
+    // Largest r with choose(r, k) <= c.
+    constexpr static u32 top(u32 c, u32 k, u32 r) {
+        return choose(r + 1, k) <= c ? top(c, k, r + 1) : r;
+    }
+
+    constexpr static u32 uncolexFrom(u32 c, u32 k, u32 r) {
+        return (1u << r) | uncolex(c - choose(r, k), k - 1);
+    }
+
+    // The set of k ranks with the given colex rank.
+    constexpr static u32 uncolex(u32 c, u32 k) {
+        return k == 0 ? 0 : uncolexFrom(c, k, top(c, k, k - 1));
+    }
+
+    // Straights as sets of five ranks, the wheel last.
+    constexpr static u32 straight(u32 i) {
+        return i == 9 ? 0x100f : 0x1fu << i;
+    }
+
+    // Straights whose colex rank is below c, or up to c.
+    constexpr static u32 straightsBelow(u32 c, u32 i = 0) {
+        return i == 10 ? 0 : (colex(straight(i)) < c)
+                + straightsBelow(c, i + 1);
+    }
+    constexpr static u32 straightsUpTo(u32 c, u32 i = 0) {
+        return i == 10 ? 0 : (colex(straight(i)) <= c)
+                + straightsUpTo(c, i + 1);
+    }
+
+    // Smallest c with c - straightsBelow(c) = j that is no straight.
+    constexpr static u32 skipStraights(u32 j, u32 c) {
+        return j + straightsUpTo(c) == c ? c :
+                skipStraights(j, j + straightsUpTo(c));
+    }
+
+    constexpr static u32 noStraightIndex(u32 ranks) {
+        return colex(ranks) - straightsBelow(colex(ranks));
+    }
+
+    constexpr static u32 noStraightRanks(u32 j) {
+        return uncolex(skipStraights(j, j), 5);
+    }
+
+    // Rank bits at 2 * rank + 3, as in the rank counts of the kernels, and
+    // their sets of ranks.
+    constexpr static u32 countsToRanks(u32 bits) {
+        return bits == 0 ? 0 : (1u << ((__builtin_ctz(bits) - 3) / 2))
+                | countsToRanks(bits & (bits - 1));
+    }
+    constexpr static u32 ranksToCounts(u32 ranks) {
+        return ranks == 0 ? 0 : (1u << (2 * __builtin_ctz(ranks) + 3))
+                | ranksToCounts(ranks & (ranks - 1));
+    }
+
+    // A single rank bit at 2 * rank + 3 after highest_bit_ranking().
+    constexpr static u32 HIGHEST_COUNT_BIT = 0xffffffe4;
+    // A single rank bit at rank + 1 after highest_bit_ranking().
+    constexpr static u32 HIGHEST_WORD_BIT = 0xffffffe2;
+
+    // Removes rank r from the ranks, the ones above it move down by one.
+    constexpr static u32 squeeze(u32 ranks, u32 r) {
+        return (ranks & ((1u << r) - 1)) | ((ranks >> (r + 1)) << r);
+    }
+    constexpr static u32 unsqueeze(u32 ranks, u32 r) {
+        return (ranks & ((1u << r) - 1)) | ((ranks >> r) << (r + 1));
+    }
+
+    // Rank r among those other than a and b, for a < b. Pass 13 as b to
+    // leave out a alone.
+    constexpr static u32 without(u32 r, u32 a, u32 b) {
+        return r - (r > a) - (r > b);
+    }
+    constexpr static u32 with(u32 r, u32 a, u32 b) {
+        return r + (r >= a) + (r + (r >= a) >= b);
+    }
+
+    constexpr static u32 countRank(u32 bit) {
+        return (__builtin_ctz(bit) - 3) / 2;
+    }
+
+    constexpr static u32 lowRank(u32 ranks) {
+        return __builtin_ctz(ranks);
+    }
+    constexpr static u32 highRank(u32 ranks) {
+        return 31 - __builtin_clz(ranks);
+    }
+
+    constexpr static u32 fromParts(u32 category, u32 height, u32 side) {
+        return offset(category) + (
+            category == HandRanking::HIGH_CARD ?
+                noStraightIndex(countsToRanks(side)) :
+            category == HandRanking::ONE_PAIR ?
+                countRank(height) * 220 + colex(squeeze(countsToRanks(side),
+                        countRank(height))) :
+            category == HandRanking::TWO_PAIRS ?
+                colex(countsToRanks(height)) * 11 + without(countRank(side),
+                        lowRank(countsToRanks(height)),
+                        highRank(countsToRanks(height))) :
+            category == HandRanking::THREE_OF_A_KIND ?
+                countRank(height) * 66 + colex(squeeze(countsToRanks(side),
+                        countRank(height))) :
+            category == HandRanking::STRAIGHT ?
+                (side - HIGHEST_COUNT_BIT) / 2 - 3 :
+            category == HandRanking::FLUSH ?
+                noStraightIndex(side >> 1) :
+            category == HandRanking::FULL_HOUSE ?
+                countRank(height) * 12 + without((side - HIGHEST_COUNT_BIT)
+                        / 2, countRank(height), 13) :
+            category == HandRanking::FOUR_OF_A_KIND ?
+                (__builtin_ctz(height) - 1) * 12 + without((side
+                        - HIGHEST_COUNT_BIT) / 2, __builtin_ctz(height) - 1,
+                        13) :
+                side - HIGHEST_WORD_BIT - 3);
+    }
+
+    constexpr static uint16_t fromValue(uint64_t value) {
+        return fromParts(value >> HandRanking::RANKING_SHIFT,
+                (value >> 32) & 0x0fffffff, value);
+    }
+
+    constexpr static uint64_t value(u32 category, u32 height, u32 side) {
+        return static_cast<uint64_t>(category) << HandRanking::RANKING_SHIFT
+                | static_cast<uint64_t>(height) << 32 | side;
+    }
+
+    constexpr static uint64_t toValue(u32 category, u32 j) {
+        return category == HandRanking::HIGH_CARD ?
+                value(category, 0, ranksToCounts(noStraightRanks(j))) :
+            category == HandRanking::ONE_PAIR ?
+                value(category, 1u << (2 * (j / 220) + 3), ranksToCounts(
+                        unsqueeze(uncolex(j % 220, 3), j / 220))) :
+            category == HandRanking::TWO_PAIRS ?
+                value(category, ranksToCounts(uncolex(j / 11, 2)),
+                        1u << (2 * with(j % 11,
+                                lowRank(uncolex(j / 11, 2)),
+                                highRank(uncolex(j / 11, 2))) + 3)) :
+            category == HandRanking::THREE_OF_A_KIND ?
+                value(category, 1u << (2 * (j / 66) + 3), ranksToCounts(
+                        unsqueeze(uncolex(j % 66, 2), j / 66))) :
+            category == HandRanking::STRAIGHT ?
+                value(category, 0, HIGHEST_COUNT_BIT + 2 * (j + 3)) :
+            category == HandRanking::FLUSH ?
+                value(category, 0, noStraightRanks(j) << 1) :
+            category == HandRanking::FULL_HOUSE ?
+                value(category, 1u << (2 * (j / 12) + 3), HIGHEST_COUNT_BIT
+                        + 2 * with(j % 12, j / 12, 13)) :
+            category == HandRanking::FOUR_OF_A_KIND ?
+                value(category, 1u << (j / 12 + 1), HIGHEST_COUNT_BIT
+                        + 2 * with(j % 12, j / 12, 13)) :
+                value(category, 0, HIGHEST_WORD_BIT + j + 3);
+    }
+
+    constexpr static u32 category(u32 index, u32 c = 8) {
+        return index >= offset(c) ? c : category(index, c - 1);
+    }
+
+    constexpr static uint64_t toValue(u32 index) {
+        return toValue(category(index), index - offset(category(index)));
+    }
+
+    uint16_t index;
+};
+
+} /* namespace poker */
+
+#endif /* HANDRANKINDEX_H_ */
@@ -0,0 +1,149 @@
+#include "IncrementalEvaluator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace poker {
+
+constexpr uint32_t IncrementalEvaluator::KEYS;
+
+IncrementalEvaluator::IncrementalEvaluator(const CardSet& start) :
+        depth(0) {
+    cards[0] = start;
+    sizes[0] = start.size();
+#ifdef CARD_CHECKS
+    if (sizes[0] > MAX_CARDS) {
+        throw new std::runtime_error(
+                "Too many cards: " + std::to_string(sizes[0]));
+    }
+#endif
+    updateFlushColor();
+}
+
+void IncrementalEvaluator::push(Card card) {
+#ifdef CARD_CHECKS
+    if (size() == MAX_CARDS) {
+        throw new std::runtime_error("Hand complete, cannot add "
+                + card.toString());
+    }
+#endif
+    cards[depth + 1] = cards[depth];
+    cards[depth + 1].add(card);
+    sizes[depth + 1] = sizes[depth] + 1;
+    ++depth;
+    updateFlushColor();
+}
+
+void IncrementalEvaluator::pop() {
+#ifdef CARD_CHECKS
+    if (depth == 0) {
+        throw new std::runtime_error("No card to take back");
+    }
+#endif
+    --depth;
+}
+
+HandRanking IncrementalEvaluator::rank() const {
+    return getCards().rankCards(size());
+}
+
+HandRanking IncrementalEvaluator::rankWith(Card card) const {
+    CardSet hand = getCards();
+    hand.add(card);
+    return hand.rankCards(size() + 1);
+}
+
+void IncrementalEvaluator::rankWithEach(const Card* next, size_t n,
+        HandRanking* out) const {
+    const CardSet base = getCards();
+    const uint32_t flush_color = flush_colors[depth];
+    // Position in the batch of the first card of each key.
+    uint8_t slots[KEYS];
+    std::fill(slots, slots + KEYS, KEYS);
+    uint32_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t& slot = slots[key(next[i], flush_color)];
+        if (slot == KEYS) {
+            slot = count;
+            hands[count] = base;
+            hands[count].add(next[i]);
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
+    CardSet::rankCardsBatchPadded(hands, rankings, count, size() + 1);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = rankings[slots[key(next[i], flush_color)]];
+    }
+}
+
+void IncrementalEvaluator::rankWithRemaining(const CardSet& dead,
+        std::vector<Card>& next, std::vector<HandRanking>& out) const {
+    const CardSet base = getCards();
+    const uint32_t flush_color = flush_colors[depth];
+    uint64_t remaining = ~(dead.cardBits() | base.cardBits())
+            & CardSet::fullDeck().cardBits();
+    // Bits of the flush color in cardBits(), and the ranks, at rank + 1, of
+    // the remaining cards in and outside of it.
+    uint64_t flush_word = flush_color == NO_FLUSH_COLOR ? 0 :
+            static_cast<uint64_t>(0xffff) << (16 * flush_color);
+    uint64_t others = remaining & ~flush_word;
+    uint32_t flush_ranks = flush_word ?
+            (remaining & flush_word) >> (16 * flush_color) : 0;
+    uint32_t other_ranks = (others | others >> 16 | others >> 32
+            | others >> 48) & 0xffff;
+
+    // One hand per key, straight from the bits.
+    uint8_t slots[KEYS];
+    uint32_t count = 0;
+    for (; other_ranks; other_ranks &= other_ranks - 1) {
+        uint32_t bit = __builtin_ctz(other_ranks);
+        uint64_t colors = others & (0x0001000100010001ull << bit);
+        slots[bit - 1] = count;
+        hands[count] = base;
+        hands[count].add(Card(static_cast<Rank>(bit - 1),
+                static_cast<Color>(__builtin_ctzll(colors) >> 4)));
+        ++count;
+    }
+    for (; flush_ranks; flush_ranks &= flush_ranks - 1) {
+        uint32_t bit = __builtin_ctz(flush_ranks);
+        slots[bit - 1 + RANKS] = count;
+        hands[count] = base;
+        hands[count].add(Card(static_cast<Rank>(bit - 1),
+                static_cast<Color>(flush_color)));
+        ++count;
+    }
+    if (count > 0) {
+        CardSet::rankCardsBatchPadded(hands, rankings, count, size() + 1);
+    }
+
+    // Decodes the cards, see CardSet::toCards(), and looks up their keys.
+    next.resize(Card::COUNT);
+    out.resize(Card::COUNT);
+    size_t n = 0;
+    for (uint32_t c = 0; c < 4; ++c) {
+        uint32_t offset = c == flush_color ? RANKS : 0;
+        for (uint32_t word = (remaining >> (16 * c)) & 0xffff; word;
+                word &= word - 1) {
+            uint32_t bit = __builtin_ctz(word);
+            next[n] = Card(static_cast<Rank>(bit - 1), static_cast<Color>(c));
+            out[n] = rankings[slots[bit - 1 + offset]];
+            ++n;
+        }
+    }
+    next.resize(n);
+    out.resize(n);
+}
+
+void IncrementalEvaluator::updateFlushColor() {
+    // Color counts are bytes of at most seven, the high bit of a byte is set
+    // by adding 124 to a count of four or more.
+    uint32_t four_or_more = (cards[depth].color_cnts() + 0x7c7c7c7c)
+            & 0x80808080;
+    flush_colors[depth] = four_or_more ?
+            __builtin_ctz(four_or_more) / 8 : NO_FLUSH_COLOR;
+}
+
+} /* namespace poker */
@@ -0,0 +1,102 @@
+#ifndef INCREMENTALEVALUATOR_H_
+#define INCREMENTALEVALUATOR_H_
+
+#include "CardSet.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// The hand of a single player while the board is dealt one card at a time.
+//
+// The card vector of every street is kept on a stack, and it already holds
+// the partial color counts (flushes), rank counts (pairs and better) and
+// rank bits (straights). Moving to the next card or back, e.g. to walk all
+// turn and river cards, is a single vector addition rather than a rebuild
+// from the hole cards. The hand can also be ranked together with each of the
+// remaining cards in one batch, on the vectorized kernels.
+//
+// Each street also caches its flush color, the only color in which one more
+// card can make or improve a flush. A card of any other color ranks the same
+// as every other card of its rank outside the flush color, so the batch only
+// ranks the first card of each rank, in and outside the flush color: at most
+// 26 hands, and 13 without a flush color, instead of 46 or 47.
+class IncrementalEvaluator {
+public:
+    constexpr static uint32_t MAX_CARDS = 7;
+
+    explicit IncrementalEvaluator(const HoleCards& hole) :
+            IncrementalEvaluator(hole.toCardSet()) {
+    }
+
+    // Starts from any cards, e.g. hole cards and the flop.
+    explicit IncrementalEvaluator(const CardSet& cards);
+
+    // Adds a board card. Throws with CARD_CHECKS if the card is held already
+    // or the hand is complete.
+    void push(Card card);
+
+    // Takes back the last card pushed.
+    void pop();
+
+    uint32_t size() const {
+        return sizes[depth];
+    }
+
+    const CardSet& getCards() const {
+        return cards[depth];
+    }
+
+    // Best five cards of the current five to seven cards.
+    HandRanking rank() const;
+
+    // Ranking of the current cards plus one more that is not held yet.
+    HandRanking rankWith(Card card) const;
+
+    // Ranks the current cards with each of the n given cards, into out. The
+    // current cards must number four to six. Cards that rank the same, see
+    // above, are ranked once.
+    void rankWithEach(const Card* next, size_t n, HandRanking* out) const;
+
+    // Ranks the current cards with every card neither held nor in dead. The
+    // cards replace the contents of next, in ascending order of their value,
+    // and their rankings those of out. Reusing both vectors across calls
+    // avoids allocations.
+    void rankWithRemaining(const CardSet& dead, std::vector<Card>& next,
+            std::vector<HandRanking>& out) const;
+
+private:
+    constexpr static uint32_t RANKS = 13;
+    // Flush color of the streets without four cards of a color.
+    constexpr static uint8_t NO_FLUSH_COLOR = 4;
+    // Distinct rankings with one more card: every rank, in the flush color
+    // and outside of it.
+    constexpr static uint32_t KEYS = 2 * RANKS;
+    constexpr static size_t BATCH_SIZE = CardSet::paddedBatchSize(KEYS);
+
+    // Index of the ranking with the card among the KEYS of a street.
+    static uint32_t key(Card card, uint32_t flush_color) {
+        uint32_t rank = static_cast<uint32_t>(card.getRank());
+        uint32_t color = static_cast<uint32_t>(card.getColor());
+        return color == flush_color ? rank + RANKS : rank;
+    }
+
+    // Sets the flush color of the current street.
+    void updateFlushColor();
+
+    CardSet cards[MAX_CARDS + 1];
+    uint32_t sizes[MAX_CARDS + 1];
+    uint8_t flush_colors[MAX_CARDS + 1];
+    uint32_t depth;
+
+    // Scratch space of the batches, kept to skip initializing it per call.
+    mutable CardSet hands[BATCH_SIZE];
+    mutable HandRanking rankings[BATCH_SIZE];
+};
+
+} /* namespace poker */
+
+#endif /* INCREMENTALEVALUATOR_H_ */
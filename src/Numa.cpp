@@ -0,0 +1,97 @@
+#include "Numa.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <ctype.h>
+#include <sched.h>
+
+namespace poker {
+
+namespace {
+
+// Parses a list like "0-3,8,10-11" as used by sysfs, empty on failure.
+std::vector<uint32_t> parseList(const std::string& text) {
+    std::vector<uint32_t> result;
+    size_t pos = 0;
+    while (pos < text.size() && isdigit(text[pos])) {
+        size_t end;
+        uint32_t first = std::stoul(text.substr(pos), &end);
+        pos += end;
+        uint32_t last = first;
+        if (pos + 1 < text.size() && text[pos] == '-'
+                && isdigit(text[pos + 1])) {
+            last = std::stoul(text.substr(++pos), &end);
+            pos += end;
+        }
+        for (uint32_t i = first; i <= last; ++i) {
+            result.push_back(i);
+        }
+        if (pos < text.size() && text[pos] == ',') {
+            pos++;
+        }
+    }
+    return result;
+}
+
+std::vector<uint32_t> readList(const std::string& path) {
+    std::ifstream in(path);
+    std::string line;
+    if (!std::getline(in, line)) {
+        return std::vector<uint32_t>();
+    }
+    return parseList(line);
+}
+
+const std::string NODE_DIRECTORY = "/sys/devices/system/node/";
+
+}
+
+thread_local uint32_t detail::thread_numa_node = 0;
+
+uint32_t getNumaNodeCount() {
+    static const uint32_t count = []() {
+        std::vector<uint32_t> nodes = readList(NODE_DIRECTORY + "online");
+        if (nodes.empty()) {
+            return 1u;
+        }
+        return std::min(nodes.back() + 1, MAX_NUMA_NODES);
+    }();
+    return count;
+}
+
+std::vector<uint32_t> getNumaNodeCpus(uint32_t node) {
+    std::vector<uint32_t> cpus = readList(
+            NODE_DIRECTORY + "node" + std::to_string(node) + "/cpulist");
+    if (cpus.empty() && node == 0 && getNumaNodeCount() == 1) {
+        // No sysfs, a single node of all CPUs.
+        for (uint32_t cpu = 0; cpu < std::thread::hardware_concurrency();
+                ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+bool pinThreadToNumaNode(uint32_t node) {
+    if (node >= getNumaNodeCount()) {
+        return false;
+    }
+    std::vector<uint32_t> cpus = getNumaNodeCpus(node);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (CPU_COUNT(&set) == 0 || sched_setaffinity(0, sizeof(set), &set) != 0) {
+        return false;
+    }
+    detail::thread_numa_node = node;
+    return true;
+}
+
+} /* namespace poker */
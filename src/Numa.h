@@ -0,0 +1,40 @@
+#ifndef NUMA_H_
+#define NUMA_H_
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// NUMA topology as the kernel reports it in sysfs, read without libnuma.
+// Hosts without NUMA, or without sysfs, are a single node with all CPUs.
+constexpr uint32_t MAX_NUMA_NODES = 64;
+
+// One above the highest node number, at most MAX_NUMA_NODES.
+uint32_t getNumaNodeCount();
+
+// CPUs of the node, empty for nodes without CPUs or not present.
+std::vector<uint32_t> getNumaNodeCpus(uint32_t node);
+
+// Pins the calling thread to the CPUs of the node and has it read the
+// node's replicas of read-only tables, see replicateRankTables(). Returns
+// false if the node has no CPUs or the affinity cannot be set, the thread
+// stays where it was then.
+bool pinThreadToNumaNode(uint32_t node);
+
+namespace detail {
+
+extern thread_local uint32_t thread_numa_node;
+
+}
+
+// Node the calling thread was pinned to, 0 if it never was.
+inline uint32_t getThreadNumaNode() {
+    return detail::thread_numa_node;
+}
+
+} /* namespace poker */
+
+#endif /* NUMA_H_ */
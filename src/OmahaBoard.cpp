@@ -0,0 +1,192 @@
+#include "OmahaBoard.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace poker {
+
+namespace {
+
+// Rank counts in base four, sums of them identify multisets of up to three
+// ranks.
+uint32_t rankKey(Card card) {
+    return 1u << (2 * static_cast<uint32_t>(card.getRank()));
+}
+
+uint64_t cardBit(Card card) {
+    return 1ull << (card.getValue() + 1);
+}
+
+constexpr uint64_t COLOR_BITS = 0x3ffe;
+
+// Bit of the rank with aces low, zero above the eight.
+uint32_t lowRankBit(Card card) {
+    uint32_t rank = static_cast<uint32_t>(card.getRank());
+    uint32_t low = rank == static_cast<uint32_t>(Rank::A) ? 0 : rank + 1;
+    return low <= 7 ? 1u << low : 0;
+}
+
+}
+
+OmahaBoard::OmahaBoard(const CardSet& board) :
+        board(board), rank_subset_count(0), flush_subset_count(0),
+        flush_mask(0), low_ranks(0) {
+    Card cards[5];
+#ifdef CARD_CHECKS
+    uint32_t size = board.size();
+    if (size < 3 || size > 5) {
+        throw new std::runtime_error(
+                "Invalid board size: " + std::to_string(size));
+    }
+#endif
+    uint32_t n = board.toCards(cards);
+    uint64_t bits = board.cardBits();
+    uint32_t ranks = (bits | bits >> 16 | bits >> 32 | bits >> 48)
+            & COLOR_BITS;
+    paired = static_cast<uint32_t>(__builtin_popcount(ranks)) < n;
+    for (uint32_t color = 0; color < 4; ++color) {
+        uint64_t mask = COLOR_BITS << (16 * color);
+        if (__builtin_popcountll(bits & mask) >= 3) {
+            flush_mask = mask;
+        }
+    }
+
+    for (uint32_t i = 0; i < n; ++i) {
+        low_ranks |= lowRankBit(cards[i]);
+    }
+
+    uint32_t keys[MAX_SUBSETS];
+    for (uint32_t i = 0; i < n; ++i) {
+        for (uint32_t j = i + 1; j < n; ++j) {
+            for (uint32_t k = j + 1; k < n; ++k) {
+                CardSet subset( { cards[i], cards[j], cards[k] });
+                if ((subset.cardBits() & flush_mask) == subset.cardBits()) {
+                    flush_subsets[flush_subset_count++] = subset;
+                }
+                uint32_t key = rankKey(cards[i]) + rankKey(cards[j])
+                        + rankKey(cards[k]);
+                if (std::find(keys, keys + rank_subset_count, key)
+                        == keys + rank_subset_count) {
+                    keys[rank_subset_count] = key;
+                    rank_subsets[rank_subset_count++] = subset;
+                }
+            }
+        }
+    }
+}
+
+HandRanking OmahaBoard::rank(const CardSet& hole) const {
+#ifdef CARD_CHECKS
+    uint32_t size = hole.size();
+    if (size < MIN_HOLE_CARDS || size > MAX_HOLE_CARDS) {
+        throw new std::runtime_error(
+                "Invalid number of hole cards: " + std::to_string(size));
+    }
+    if (hole.cardBits() & board.cardBits()) {
+        throw new std::runtime_error("Hole cards on the board");
+    }
+#endif
+    // Hands per batch, two steps of the widest batch kernel.
+    constexpr uint32_t BATCH_SIZE = 2 * CardSet::BATCH_WIDTH;
+    CardSet hands[BATCH_SIZE];
+    HandRanking rankings[BATCH_SIZE];
+    uint32_t count = 0;
+    HandRanking best;
+    auto rankHands = [&]() {
+        CardSet::rankCardsBatchPadded(hands, rankings, count, 5);
+        best = std::max(best, *std::max_element(rankings,
+                rankings + count));
+        count = 0;
+    };
+    auto addHands = [&](const CardSet& pair, const CardSet* subsets,
+            uint32_t n) {
+        for (uint32_t i = 0; i < n; ++i) {
+            hands[count] = subsets[i];
+            hands[count].addAll(pair);
+            if (++count == BATCH_SIZE) {
+                rankHands();
+            }
+        }
+    };
+
+    Card cards[MAX_HOLE_CARDS];
+    uint32_t n = hole.toCards(cards);
+    bool flush = false;
+    if (flush_mask) {
+        for (uint32_t i = 0; i < n; ++i) {
+            for (uint32_t j = i + 1; j < n; ++j) {
+                uint64_t bits = cardBit(cards[i]) | cardBit(cards[j]);
+                if ((bits & flush_mask) == bits) {
+                    addHands(CardSet( { cards[i], cards[j] }), flush_subsets,
+                            flush_subset_count);
+                    flush = true;
+                }
+            }
+        }
+    }
+    if (!flush || paired) {
+        uint32_t keys[MAX_HOLE_CARDS * (MAX_HOLE_CARDS - 1) / 2];
+        uint32_t key_count = 0;
+        for (uint32_t i = 0; i < n; ++i) {
+            for (uint32_t j = i + 1; j < n; ++j) {
+                uint32_t key = rankKey(cards[i]) + rankKey(cards[j]);
+                if (std::find(keys, keys + key_count, key)
+                        != keys + key_count) {
+                    continue;
+                }
+                keys[key_count++] = key;
+                addHands(CardSet( { cards[i], cards[j] }), rank_subsets,
+                        rank_subset_count);
+            }
+        }
+    }
+    if (count) {
+        rankHands();
+    }
+    return best;
+}
+
+HiLoRanking OmahaBoard::rankHiLo(const CardSet& hole) const {
+    HiLoRanking result;
+    result.high = rank(hole);
+    if (__builtin_popcount(low_ranks) < 3) {
+        return result;
+    }
+    Card cards[MAX_HOLE_CARDS];
+    uint32_t n = hole.toCards(cards);
+    // Five ranks as a mask, the lower mask is the better low.
+    uint32_t best = ~0u;
+    for (uint32_t i = 0; i < n; ++i) {
+        for (uint32_t j = i + 1; j < n; ++j) {
+            uint32_t pair = lowRankBit(cards[i]) | lowRankBit(cards[j]);
+            if (!(pair & (pair - 1))) {
+                // A high card or a pair.
+                continue;
+            }
+            uint32_t rest = low_ranks & ~pair;
+            uint32_t hand = pair;
+            int k = 0;
+            for (; k < 3 && rest; ++k) {
+                hand |= rest & -rest;
+                rest &= rest - 1;
+            }
+            if (k == 3) {
+                best = std::min(best, hand);
+            }
+        }
+    }
+    if (best != ~0u) {
+        result.low = LowRanking::fromA5Ranks(HandRanking::HIGH_CARD, best);
+    }
+    return result;
+}
+
+HandRanking rankOmaha(const CardSet& hole, const CardSet& board) {
+    return OmahaBoard(board).rank(hole);
+}
+
+HiLoRanking rankOmahaHiLo(const CardSet& hole, const CardSet& board) {
+    return OmahaBoard(board).rankHiLo(hole);
+}
+
+} /* namespace poker */
@@ -0,0 +1,81 @@
+#ifndef OMAHABOARD_H_
+#define OMAHABOARD_H_
+
+#include "CardSet.h"
+
+#include <stdint.h>
+
+namespace poker {
+
+// Both halves of a hi-lo hand. The low is LowRanking() if none qualifies.
+struct HiLoRanking {
+    HandRanking high;
+    LowRanking low;
+};
+
+// Omaha hands on a fixed board, of four (PLO4) to six (PLO6) hole cards. A
+// hand is the best five cards of exactly two hole cards and exactly three
+// board cards, so PLO4 on the river is the best of 60 five card hands and
+// PLO6 the best of 150.
+//
+// The board is analyzed once. Its three card subsets are kept as card
+// vectors, one per multiset of ranks: suits only matter for a flush, and
+// with at most five board cards only one suit can have three of them. The
+// hole cards are combined the same way, one pair per pair of ranks with the
+// subsets of ranks, and just the pairs of the flush suit with its suited
+// subsets. Such a flush beats anything but the full houses and quads of a
+// paired board, so on an unpaired board the rank subsets are skipped once a
+// hole pair makes one. The hands left are ranked in SIMD lanes.
+class OmahaBoard {
+public:
+    constexpr static uint32_t MIN_HOLE_CARDS = 4;
+    constexpr static uint32_t MAX_HOLE_CARDS = 6;
+
+    // The flop, turn or river, three to five cards.
+    explicit OmahaBoard(const CardSet& board);
+
+    const CardSet& getCards() const {
+        return board;
+    }
+
+    // Best hand of two of the hole cards and three of the board. Throws with
+    // CARD_CHECKS unless there are four to six hole cards, none on the
+    // board.
+    HandRanking rank(const CardSet& hole) const;
+
+    // Omaha Hi-Lo, eight or better: the high hand and the best A-5 low of
+    // two hole cards and three board cards, five distinct ranks from the ace
+    // to the eight. The low is picked on rank masks, the hole pairs each
+    // take the lowest three board ranks they do not pair.
+    HiLoRanking rankHiLo(const CardSet& hole) const;
+
+private:
+    constexpr static uint32_t MAX_SUBSETS = 10;
+
+    CardSet board;
+    bool paired;
+
+    // Subsets of distinct ranks.
+    CardSet rank_subsets[MAX_SUBSETS];
+    uint32_t rank_subset_count;
+
+    // Subsets of three cards of the flush suit.
+    CardSet flush_subsets[MAX_SUBSETS];
+    uint32_t flush_subset_count;
+
+    // Card bits of the flush suit, zero without one.
+    uint64_t flush_mask;
+
+    // Ranks of the board from the ace to the eight, the ace being bit 0.
+    uint32_t low_ranks;
+};
+
+// Ranks a single Omaha hand. Analyzes the board on every call, keep an
+// OmahaBoard to rank several hands on the same board.
+HandRanking rankOmaha(const CardSet& hole, const CardSet& board);
+
+HiLoRanking rankOmahaHiLo(const CardSet& hole, const CardSet& board);
+
+} /* namespace poker */
+
+#endif /* OMAHABOARD_H_ */
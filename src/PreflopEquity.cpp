@@ -0,0 +1,240 @@
+#include "PreflopEquity.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace poker {
+
+namespace {
+
+constexpr uint32_t NO_MATCHUP = ~0u;
+
+constexpr size_t COMBO_PAIRS = Range::COMBOS * (Range::COMBOS - 1) / 2;
+
+// Index of the pair of combinations p < q, like Range::comboIndex().
+size_t pairIndex(size_t p, size_t q) {
+    return q * (q - 1) / 2 + p;
+}
+
+// The hands in their canonical suits, the primary one first.
+std::pair<uint64_t, uint64_t> canonicalKey(const HoleCards& primary,
+        const HoleCards& secondary) {
+    auto canonical = primary.toCardSet().canonicalize(
+            secondary.toCardSet());
+    return std::make_pair(std::get<0>(canonical).cardBits(),
+            std::get<1>(canonical).cardBits());
+}
+
+}
+
+constexpr uint32_t PreflopEquity::VERSION;
+constexpr uint32_t PreflopEquity::MATCHUPS;
+constexpr uint32_t PreflopEquity::HAND_CLASSES;
+constexpr uint32_t PreflopEquity::BOARDS;
+
+struct PreflopEquity::Layout {
+    // Matchup << 1 | swapped of the combinations p < q at pairIndex(p, q),
+    // NO_MATCHUP if they share a card.
+    uint32_t matchups[COMBO_PAIRS];
+    // Boards won, tied and lost by the first hand of the matchup, all zero
+    // unless enumerated.
+    uint32_t wins[MATCHUPS];
+    uint32_t ties[MATCHUPS];
+    uint32_t losses[MATCHUPS];
+    double class_equity[HAND_CLASSES * HAND_CLASSES];
+};
+
+PreflopEquity::PreflopEquity(TaskScheduler* scheduler) :
+        PreflopEquity(loadTable("preflop_equity", VERSION, sizeof(Layout),
+                [scheduler](void* payload) {
+                    std::vector<uint32_t> all;
+                    for (uint32_t c = 0; c < HAND_CLASSES; ++c) {
+                        all.push_back(c);
+                    }
+                    withScheduler(scheduler, [&](TaskScheduler& workers) {
+                        fill(*static_cast<Layout*>(payload), all, workers);
+                    });
+                }), scheduler) {
+}
+
+PreflopEquity::PreflopEquity(TableData data, TaskScheduler* scheduler) :
+        data(std::move(data)), table(this->data.as<Layout>()), scheduler(
+                scheduler) {
+    if (this->data.size() != sizeof(Layout)) {
+        throw new std::runtime_error("Invalid preflop equity table size");
+    }
+}
+
+TableData PreflopEquity::generate(const std::vector<uint32_t>& hand_classes,
+        TaskScheduler* scheduler) {
+    return TableData::generate(sizeof(Layout), [&](void* payload) {
+        withScheduler(scheduler, [&](TaskScheduler& workers) {
+            fill(*static_cast<Layout*>(payload), hand_classes, workers);
+        });
+    });
+}
+
+void PreflopEquity::fill(Layout& table,
+        const std::vector<uint32_t>& hand_classes, TaskScheduler& scheduler) {
+    // Numbers the matchups in the order they are first met. Every matchup
+    // is held in the orientation with the smaller canonical key.
+    std::map<std::pair<uint64_t, uint64_t>, uint32_t> ids;
+    std::vector<std::pair<HoleCards, HoleCards>> representatives;
+    for (size_t q = 0; q < Range::COMBOS; ++q) {
+        HoleCards second = Range::combo(q);
+        uint64_t second_bits = second.toCardSet().cardBits();
+        for (size_t p = 0; p < q; ++p) {
+            HoleCards first = Range::combo(p);
+            if (first.toCardSet().cardBits() & second_bits) {
+                table.matchups[pairIndex(p, q)] = NO_MATCHUP;
+                continue;
+            }
+            std::pair<uint64_t, uint64_t> key = canonicalKey(first, second);
+            std::pair<uint64_t, uint64_t> swapped_key = canonicalKey(second,
+                    first);
+            bool swapped = swapped_key < key;
+            auto inserted = ids.insert(std::make_pair(
+                    swapped ? swapped_key : key, ids.size()));
+            if (inserted.second) {
+                representatives.push_back(swapped ?
+                        std::make_pair(second, first) :
+                        std::make_pair(first, second));
+            }
+            table.matchups[pairIndex(p, q)] = inserted.first->second << 1
+                    | swapped;
+        }
+    }
+    if (ids.size() != MATCHUPS) {
+        throw new std::runtime_error(
+                "Unexpected number of matchups: " + std::to_string(ids.size()));
+    }
+
+    std::vector<bool> selected(HAND_CLASSES, false);
+    for (uint32_t c : hand_classes) {
+        selected.at(c) = true;
+    }
+    std::vector<uint32_t> enumerated;
+    for (uint32_t m = 0; m < MATCHUPS; ++m) {
+        if (selected[handClass(representatives[m].first)]
+                && selected[handClass(representatives[m].second)]) {
+            enumerated.push_back(m);
+        }
+    }
+    // A task per matchup, the boards of each run as nested tasks.
+    scheduler.parallelFor(0, enumerated.size(), 1,
+            [&](uint64_t begin, uint64_t end, ScratchArena&) {
+        for (uint64_t i = begin; i < end; ++i) {
+            uint32_t m = enumerated[i];
+            EquityCalculator calc( { representatives[m].first,
+                    representatives[m].second });
+            calc.setScheduler(&scheduler);
+            EquityResult result = calc.enumerate();
+            table.wins[m] = std::llround(result.players[0].win * BOARDS);
+            table.ties[m] = std::llround(result.players[0].tie * BOARDS);
+            table.losses[m] = BOARDS - table.wins[m] - table.ties[m];
+        }
+    });
+
+    // Every combination pair counts once in both directions.
+    std::vector<double> sums(HAND_CLASSES * HAND_CLASSES, 0);
+    std::vector<uint32_t> pairs(HAND_CLASSES * HAND_CLASSES, 0);
+    std::vector<bool> complete(HAND_CLASSES * HAND_CLASSES, true);
+    for (size_t q = 0; q < Range::COMBOS; ++q) {
+        uint32_t second = handClass(Range::combo(q));
+        for (size_t p = 0; p < q; ++p) {
+            uint32_t entry = table.matchups[pairIndex(p, q)];
+            if (entry == NO_MATCHUP) {
+                continue;
+            }
+            uint32_t first = handClass(Range::combo(p));
+            uint32_t m = entry >> 1;
+            double equity = (table.wins[m] + 0.5 * table.ties[m]) / BOARDS;
+            if (entry & 1) {
+                equity = 1 - equity;
+            }
+            for (int direction = 0; direction < 2; ++direction) {
+                size_t cell = direction ?
+                        second * HAND_CLASSES + first :
+                        first * HAND_CLASSES + second;
+                sums[cell] += direction ? 1 - equity : equity;
+                pairs[cell]++;
+                complete[cell] = complete[cell]
+                        && table.wins[m] + table.ties[m] + table.losses[m]
+                                == BOARDS;
+            }
+        }
+    }
+    for (size_t cell = 0; cell < sums.size(); ++cell) {
+        table.class_equity[cell] = complete[cell] ? sums[cell] / pairs[cell] :
+                std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+uint32_t PreflopEquity::matchup(const HoleCards& first,
+        const HoleCards& second, bool* swapped) const {
+    if (first.toCardSet().cardBits() & second.toCardSet().cardBits()) {
+        throw new std::runtime_error(
+                "Hands share a card: " + first.toString() + " "
+                        + second.toString());
+    }
+    size_t p = Range::comboIndex(first.getFirst(), first.getSecond());
+    size_t q = Range::comboIndex(second.getFirst(), second.getSecond());
+    uint32_t entry = table->matchups[p < q ? pairIndex(p, q) : pairIndex(q,
+            p)];
+    *swapped = (entry & 1) != (p > q);
+    return entry >> 1;
+}
+
+EquityResult PreflopEquity::lookup(const HoleCards& first,
+        const HoleCards& second) const {
+    bool swapped;
+    uint32_t m = matchup(first, second, &swapped);
+    if (table->wins[m] + table->ties[m] + table->losses[m] != BOARDS) {
+        return enumerate( { first, second }, CardSet(), CardSet());
+    }
+    EquityResult result;
+    result.trials = BOARDS;
+    result.players.resize(2);
+    PlayerEquity& winner = result.players[swapped];
+    PlayerEquity& loser = result.players[!swapped];
+    winner.win = static_cast<double>(table->wins[m]) / BOARDS;
+    loser.win = static_cast<double>(table->losses[m]) / BOARDS;
+    winner.tie = loser.tie = static_cast<double>(table->ties[m]) / BOARDS;
+    winner.equity = winner.win + winner.tie / 2;
+    loser.equity = loser.win + loser.tie / 2;
+    return result;
+}
+
+EquityResult PreflopEquity::calculate(const std::vector<HoleCards>& players,
+        const CardSet& board, const CardSet& dead) const {
+    if (players.size() == 2 && board.size() == 0 && dead.size() == 0) {
+        return lookup(players[0], players[1]);
+    }
+    return enumerate(players, board, dead);
+}
+
+EquityResult PreflopEquity::enumerate(const std::vector<HoleCards>& players,
+        const CardSet& board, const CardSet& dead) const {
+    EquityCalculator calc(players, board, dead);
+    calc.setScheduler(scheduler);
+    return calc.enumerate();
+}
+
+double PreflopEquity::getClassEquity(uint32_t first, uint32_t second) const {
+    return table->class_equity[first * HAND_CLASSES + second];
+}
+
+uint32_t PreflopEquity::handClass(const HoleCards& hole) {
+    uint32_t a = 12 - static_cast<uint32_t>(hole.getFirst().getRank());
+    uint32_t b = 12 - static_cast<uint32_t>(hole.getSecond().getRank());
+    uint32_t high = std::min(a, b);
+    uint32_t low = std::max(a, b);
+    bool suited = hole.getFirst().getColor() == hole.getSecond().getColor();
+    return suited ? high * 13 + low : low * 13 + high;
+}
+
+} /* namespace poker */
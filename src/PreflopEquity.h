@@ -0,0 +1,92 @@
+#ifndef PREFLOPEQUITY_H_
+#define PREFLOPEQUITY_H_
+
+#include "EquityCalculator.h"
+#include "Range.h"
+#include "TableFile.h"
+#include "TaskScheduler.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// Exact heads-up preflop equities of all pairs of hole cards, looked up in
+// constant time.
+//
+// Two pairs of hole cards are the same matchup if a permutation of the
+// suits, and possibly swapping the hands, maps one onto the other. Only
+// one pair of each of the 47,008 matchups is enumerated over all C(48, 5)
+// boards; the table maps every pair of combinations to its matchup. From
+// the matchups follows the 169 x 169 matrix of hand classes, e.g. AKs
+// against QQ, averaged over the combinations that do not share cards.
+//
+// Generating the table takes about 80 billion hands, so it is meant to be
+// kept as a table file, see loadTable().
+class PreflopEquity {
+public:
+    // Bump when the layout or the matchup numbering changes.
+    constexpr static uint32_t VERSION = 1;
+
+    constexpr static uint32_t MATCHUPS = 47008;
+    constexpr static uint32_t HAND_CLASSES = 169;
+    // Completions of an empty board, C(48, 5).
+    constexpr static uint32_t BOARDS = 1712304;
+
+    // Maps the table file, or generates the table on the scheduler (all
+    // hardware threads without one) and writes it to the table directory.
+    // The scheduler also runs the fallback calculations.
+    explicit PreflopEquity(TaskScheduler* scheduler = nullptr);
+
+    // A table of generate() or a table file mapped elsewhere.
+    explicit PreflopEquity(TableData data, TaskScheduler* scheduler =
+            nullptr);
+
+    // Generates a table in memory with only the matchups between the given
+    // hand classes enumerated. Lookups of the others fall back to the
+    // calculator.
+    static TableData generate(const std::vector<uint32_t>& hand_classes,
+            TaskScheduler* scheduler = nullptr);
+
+    // Exact equity of the two hands. Throws if they share a card.
+    EquityResult lookup(const HoleCards& first, const HoleCards& second) const;
+
+    // Table lookup for two players without board and dead cards, exact
+    // enumeration by EquityCalculator for everything else.
+    EquityResult calculate(const std::vector<HoleCards>& players,
+            const CardSet& board = CardSet(), const CardSet& dead = CardSet())
+            const;
+
+    // Equity of the first hand class against the second, NaN if not all of
+    // their matchups were enumerated.
+    double getClassEquity(uint32_t first, uint32_t second) const;
+
+    // Hand class in the usual 13 x 13 grid, aces first: pairs on the
+    // diagonal, suited hands above it and offsuit hands below, so AA is 0,
+    // AKs 1 and AKo 13.
+    static uint32_t handClass(const HoleCards& hole);
+
+    // Matchup of two hands not sharing a card, and whether the table holds
+    // it the other way round.
+    uint32_t matchup(const HoleCards& first, const HoleCards& second,
+            bool* swapped) const;
+
+private:
+    struct Layout;
+
+    static void fill(Layout& table, const std::vector<uint32_t>& hand_classes,
+            TaskScheduler& scheduler);
+
+    EquityResult enumerate(const std::vector<HoleCards>& players,
+            const CardSet& board, const CardSet& dead) const;
+
+    TableData data;
+    const Layout* table;
+    TaskScheduler* scheduler;
+};
+
+} /* namespace poker */
+
+#endif /* PREFLOPEQUITY_H_ */
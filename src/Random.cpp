@@ -0,0 +1,91 @@
+#include "Random.h"
+
+#include <emmintrin.h>
+
+namespace poker {
+
+namespace {
+
+constexpr uint32_t PHILOX_M0 = 0xd2511f53;
+constexpr uint32_t PHILOX_M1 = 0xcd9e8d57;
+constexpr uint32_t PHILOX_W0 = 0x9e3779b9;
+constexpr uint32_t PHILOX_W1 = 0xbb67ae85;
+constexpr int PHILOX_ROUNDS = 10;
+
+// Low and high halves of the products of the four lanes with m.
+inline void mulhilo(__m128i x, __m128i m, __m128i& lo, __m128i& hi) {
+    // Lanes 0 and 2, then 1 and 3, as 64-bit products.
+    __m128i even = _mm_mul_epu32(x, m);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), m);
+    even = _mm_shuffle_epi32(even, _MM_SHUFFLE(3, 1, 2, 0));
+    odd = _mm_shuffle_epi32(odd, _MM_SHUFFLE(3, 1, 2, 0));
+    lo = _mm_unpacklo_epi32(even, odd);
+    hi = _mm_unpackhi_epi32(even, odd);
+}
+
+}
+
+void PhiloxRandom::generate(uint64_t key, uint64_t stream, uint64_t block,
+        uint32_t* out) {
+    uint32_t c0 = block, c1 = block >> 32, c2 = stream, c3 = stream >> 32;
+    uint32_t k0 = key, k1 = key >> 32;
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c0;
+        uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c2;
+        uint32_t x0 = (p1 >> 32) ^ c1 ^ k0;
+        uint32_t x2 = (p0 >> 32) ^ c3 ^ k1;
+        c0 = x0;
+        c1 = p1;
+        c2 = x2;
+        c3 = p0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+void PhiloxRandom::generate(uint64_t key, uint64_t stream, uint64_t block,
+        size_t n, uint32_t* out) {
+    const __m128i m0 = _mm_set1_epi32(PHILOX_M0);
+    const __m128i m1 = _mm_set1_epi32(PHILOX_M1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4, block += 4) {
+        // Word j of the four blocks in lane-wise vectors.
+        uint64_t b[4] = { block, block + 1, block + 2, block + 3 };
+        __m128i c0 = _mm_setr_epi32(b[0], b[1], b[2], b[3]);
+        __m128i c1 = _mm_setr_epi32(b[0] >> 32, b[1] >> 32, b[2] >> 32,
+                b[3] >> 32);
+        __m128i c2 = _mm_set1_epi32(stream);
+        __m128i c3 = _mm_set1_epi32(stream >> 32);
+        uint32_t k0 = key, k1 = key >> 32;
+        for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+            __m128i lo0, hi0, lo1, hi1;
+            mulhilo(c0, m0, lo0, hi0);
+            mulhilo(c2, m1, lo1, hi1);
+            c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(k0));
+            c1 = lo1;
+            c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(k1));
+            c3 = lo0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+        // Back to the four words of each block.
+        __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+        __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+        __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+        __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+        __m128i* o = reinterpret_cast<__m128i*>(out + 4 * i);
+        _mm_storeu_si128(o, _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128(o + 1, _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128(o + 2, _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128(o + 3, _mm_unpackhi_epi64(t2, t3));
+    }
+    for (; i < n; ++i, ++block) {
+        generate(key, stream, block, out + 4 * i);
+    }
+}
+
+} /* namespace poker */
@@ -0,0 +1,93 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include "SFMT.h"
+#include "SfmtJump.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// Random sources of BasicFastDeck. Each fills buffers of BUFFER_SIZE words at
+// once and can jump k substreams ahead, see FastDeck::split().
+
+// SFMT of the period the build selects with SFMT_MEXP. Fast, but the state is
+// SFMT_N32 words, 2.5KB for SFMT19937, and jumping takes a pass over it.
+class SfmtRandom {
+public:
+    // A multiple of four and at least SFMT_N32, as sfmt_fill_array32()
+    // requires.
+    constexpr static int32_t BUFFER_SIZE = SFMT_N32 > 256 ? SFMT_N32 : 256;
+
+    explicit SfmtRandom(uint32_t seed) {
+        sfmt_init_gen_rand(&sfmt, seed);
+    }
+
+    void fill(uint32_t* out) {
+        sfmt_fill_array32(&sfmt, out, BUFFER_SIZE);
+    }
+
+    // Substreams of 2^64 steps, four words each.
+    void jump(uint64_t k) {
+        sfmtJumpSubstreams(sfmt, k);
+    }
+
+private:
+    sfmt_t sfmt;
+};
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+// 3"). Block i of stream s are the four words of ten rounds of a bijection of
+// the counter (i, s), keyed by the seed. The state is just key and counter,
+// so any block of any stream is addressable directly, and jumping is free.
+class PhiloxRandom {
+public:
+    constexpr static int32_t BUFFER_SIZE = 64;
+
+    explicit PhiloxRandom(uint64_t key, uint64_t stream = 0,
+            uint64_t block = 0) :
+            key(key), stream(stream), block(block) {
+    }
+
+    void fill(uint32_t* out) {
+        generate(key, stream, block, BUFFER_SIZE / 4, out);
+        block += BUFFER_SIZE / 4;
+    }
+
+    // Substreams of 2^64 blocks.
+    void jump(uint64_t k) {
+        stream += k;
+    }
+
+    // Continues at the given block of the given stream.
+    void seek(uint64_t stream, uint64_t block) {
+        this->stream = stream;
+        this->block = block;
+    }
+
+    uint64_t getStream() const {
+        return stream;
+    }
+
+    uint64_t getBlock() const {
+        return block;
+    }
+
+    // The four words of a single block.
+    static void generate(uint64_t key, uint64_t stream, uint64_t block,
+            uint32_t* out);
+
+    // The words of n consecutive blocks, four blocks at a time in SSE2 lanes.
+    static void generate(uint64_t key, uint64_t stream, uint64_t block,
+            size_t n, uint32_t* out);
+
+private:
+    uint64_t key;
+    uint64_t stream;
+    uint64_t block;
+};
+
+} /* namespace poker */
+
+#endif /* RANDOM_H_ */
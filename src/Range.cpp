@@ -0,0 +1,267 @@
+#include "Range.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace poker {
+
+namespace {
+
+const std::string RANK_CHARS = "23456789TJQKA";
+const std::string COLOR_CHARS = "CDHS";
+
+uint32_t denseIndex(Card c) {
+    return 4 * static_cast<uint32_t>(c.getRank())
+            + static_cast<uint32_t>(c.getColor());
+}
+
+Card denseCard(uint32_t index) {
+    return Card(static_cast<Rank>(index / 4), static_cast<Color>(index % 4));
+}
+
+std::runtime_error* invalid(const std::string& text) {
+    return new std::runtime_error("Invalid range: " + text);
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+int parseRank(char c) {
+    size_t pos = RANK_CHARS.find(toupper(c));
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int parseColor(char c) {
+    size_t pos = COLOR_CHARS.find(toupper(c));
+    return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+// Two ranks, the higher first, and 's', 'o' or 0 for both.
+struct HandClass {
+    int high;
+    int low;
+    char suited;
+};
+
+HandClass parseHandClass(const std::string& text) {
+    if (text.size() < 2 || text.size() > 3) {
+        throw invalid(text);
+    }
+    HandClass hand;
+    hand.high = parseRank(text[0]);
+    hand.low = parseRank(text[1]);
+    hand.suited = text.size() == 3 ? tolower(text[2]) : 0;
+    if (hand.high < 0 || hand.low < 0) {
+        throw invalid(text);
+    }
+    if (hand.high < hand.low) {
+        std::swap(hand.high, hand.low);
+    }
+    if (hand.high == hand.low ?
+            hand.suited != 0 : hand.suited != 0 && hand.suited != 's'
+                    && hand.suited != 'o') {
+        throw invalid(text);
+    }
+    return hand;
+}
+
+void addClass(std::vector<float>& weights, int high, int low, char suited,
+        float weight) {
+    for (int c1 = 0; c1 < 4; ++c1) {
+        for (int c2 = 0; c2 < 4; ++c2) {
+            bool same = c1 == c2;
+            if ((high == low && c1 >= c2) || (suited == 's' && !same)
+                    || (suited == 'o' && same)) {
+                continue;
+            }
+            Card a(static_cast<Rank>(high), static_cast<Color>(c1));
+            Card b(static_cast<Rank>(low), static_cast<Color>(c2));
+            weights[Range::comboIndex(a, b)] = weight;
+        }
+    }
+}
+
+void addHand(std::vector<float>& weights, const std::string& text,
+        float weight) {
+    if (text.size() == 4 && parseColor(text[1]) >= 0
+            && parseColor(text[3]) >= 0) {
+        int r1 = parseRank(text[0]);
+        int r2 = parseRank(text[2]);
+        if (r1 < 0 || r2 < 0
+                || (r1 == r2 && parseColor(text[1]) == parseColor(text[3]))) {
+            throw invalid(text);
+        }
+        Card a(static_cast<Rank>(r1), static_cast<Color>(parseColor(text[1])));
+        Card b(static_cast<Rank>(r2), static_cast<Color>(parseColor(text[3])));
+        weights[Range::comboIndex(a, b)] = weight;
+        return;
+    }
+
+    size_t dash = text.find('-');
+    if (dash != std::string::npos) {
+        HandClass from = parseHandClass(text.substr(0, dash));
+        HandClass to = parseHandClass(text.substr(dash + 1));
+        bool pairs = from.high == from.low && to.high == to.low;
+        if (pairs) {
+            for (int r = std::min(from.high, to.high);
+                    r <= std::max(from.high, to.high); ++r) {
+                addClass(weights, r, r, 0, weight);
+            }
+            return;
+        }
+        if (from.high != to.high || from.suited != to.suited
+                || from.high == from.low || to.high == to.low) {
+            throw invalid(text);
+        }
+        for (int r = std::min(from.low, to.low);
+                r <= std::max(from.low, to.low); ++r) {
+            addClass(weights, from.high, r, from.suited, weight);
+        }
+        return;
+    }
+
+    bool plus = !text.empty() && text.back() == '+';
+    HandClass hand = parseHandClass(
+            plus ? text.substr(0, text.size() - 1) : text);
+    if (!plus) {
+        addClass(weights, hand.high, hand.low, hand.suited, weight);
+    } else if (hand.high == hand.low) {
+        for (int r = hand.high; r < static_cast<int>(RANK_CHARS.size()); ++r) {
+            addClass(weights, r, r, 0, weight);
+        }
+    } else {
+        for (int r = hand.low; r < hand.high; ++r) {
+            addClass(weights, hand.high, r, hand.suited, weight);
+        }
+    }
+}
+
+float parseWeight(const std::string& text) {
+    std::string number = trim(text);
+    bool percent = !number.empty() && number.back() == '%';
+    if (percent) {
+        number.pop_back();
+    }
+    size_t parsed = 0;
+    double weight;
+    try {
+        weight = std::stod(number, &parsed);
+    } catch (const std::exception&) {
+        throw invalid(text);
+    }
+    if (parsed != number.size()) {
+        throw invalid(text);
+    }
+    if (percent) {
+        weight /= 100;
+    }
+    if (weight < 0 || weight > 1) {
+        throw invalid(text);
+    }
+    return weight;
+}
+
+}
+
+Range::Range() :
+        weights(COMBOS, 0) {
+}
+
+Range Range::parse(const std::string& text) {
+    Range range;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t end = std::min(text.find(',', begin), text.size());
+        std::string token = trim(text.substr(begin, end - begin));
+        begin = end + 1;
+        if (token.empty()) {
+            if (end < text.size()) {
+                throw invalid(text);
+            }
+            continue;
+        }
+        float weight = 1;
+        size_t colon = token.find(':');
+        if (colon != std::string::npos) {
+            weight = parseWeight(token.substr(colon + 1));
+            token = trim(token.substr(0, colon));
+        }
+        addHand(range.weights, token, weight);
+    }
+    return range;
+}
+
+size_t Range::comboIndex(Card a, Card b) {
+    uint32_t i = denseIndex(a);
+    uint32_t j = denseIndex(b);
+#ifdef CARD_CHECKS
+    if (i == j) {
+        throw new std::runtime_error("Duplicate card " + a.toString());
+    }
+#endif
+    if (i > j) {
+        std::swap(i, j);
+    }
+    return j * (j - 1) / 2 + i;
+}
+
+HoleCards Range::combo(size_t index) {
+    // Inverse of comboIndex(): the largest j with j*(j-1)/2 <= index.
+    uint32_t j = 1;
+    while ((j + 1) * j / 2 <= index) {
+        ++j;
+    }
+    uint32_t i = index - j * (j - 1) / 2;
+    return HoleCards(denseCard(j), denseCard(i));
+}
+
+const CardSet& Range::comboCards(size_t index) {
+    static const std::vector<CardSet> cards = []() {
+        std::vector<CardSet> result;
+        for (size_t c = 0; c < COMBOS; ++c) {
+            result.push_back(combo(c).toCardSet());
+        }
+        return result;
+    }();
+    return cards[index];
+}
+
+const Range::ComboCardValues& Range::comboCardValues() {
+    static const ComboCardValues values = []() {
+        ComboCardValues result;
+        for (size_t c = 0; c < COMBOS; ++c) {
+            HoleCards hole = combo(c);
+            result.first[c] = hole.getFirst().getValue();
+            result.second[c] = hole.getSecond().getValue();
+        }
+        return result;
+    }();
+    return values;
+}
+
+size_t Range::size() const {
+    return COMBOS - std::count(weights.begin(), weights.end(), 0.0f);
+}
+
+std::vector<size_t> Range::liveCombos(const CardSet& blocked) const {
+    std::vector<size_t> result;
+    for (size_t index = 0; index < COMBOS; ++index) {
+        if (weights[index] == 0) {
+            continue;
+        }
+        HoleCards hole = combo(index);
+        if (!blocked.contains(hole.getFirst())
+                && !blocked.contains(hole.getSecond())) {
+            result.push_back(index);
+        }
+    }
+    return result;
+}
+
+} /* namespace poker */
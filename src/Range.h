@@ -0,0 +1,83 @@
+#ifndef RANGE_H_
+#define RANGE_H_
+
+#include "CardSet.h"
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// A weighted set of hole cards, e.g. "QQ+, AKs, KQo:0.5".
+//
+// Every one of the 1326 possible two card combinations has a weight between
+// zero and one. Combinations are indexed by their cards in dense order (four
+// colors per rank), the combination of cards i < j has index j*(j-1)/2 + i.
+class Range {
+public:
+    constexpr static size_t COMBOS = 52 * 51 / 2;
+    // Bound of Card::getValue(), the size of per-card tables.
+    constexpr static size_t CARD_VALUES = 64;
+
+    // Card::getValue() of both cards of every combination.
+    struct ComboCardValues {
+        uint8_t first[COMBOS];
+        uint8_t second[COMBOS];
+    };
+
+    Range();
+
+    // Parses comma separated hands, each optionally followed by ":weight"
+    // with the weight a fraction ("0.5") or a percentage ("50%"):
+    //
+    //   QQ      all six combinations of a pair
+    //   QQ+     queens and higher pairs
+    //   22-55   pairs from deuces to fives
+    //   AKs     suited, AKo offsuit, AK both
+    //   ATs+    the kicker going up to just below the first rank
+    //   A2s-A5s the kicker ranging over the given ranks
+    //   AsKd    a single combination
+    //
+    // Hands listed more than once keep the last weight.
+    static Range parse(const std::string& text);
+
+    static size_t comboIndex(Card a, Card b);
+
+    static HoleCards combo(size_t index);
+
+    // The cards of the combination, from a table.
+    static const CardSet& comboCards(size_t index);
+
+    // The card values of all combinations, from a table, e.g. for per-card
+    // sums that account for card removal.
+    static const ComboCardValues& comboCardValues();
+
+    double getWeight(size_t index) const {
+        return weights[index];
+    }
+
+    double getWeight(const HoleCards& hole) const {
+        return weights[comboIndex(hole.getFirst(), hole.getSecond())];
+    }
+
+    void setWeight(const HoleCards& hole, double weight) {
+        weights[comboIndex(hole.getFirst(), hole.getSecond())] = weight;
+    }
+
+    // Number of combinations with non-zero weight.
+    size_t size() const;
+
+    // Indexes of the combinations with non-zero weight that do not use any of
+    // the blocked cards.
+    std::vector<size_t> liveCombos(const CardSet& blocked) const;
+
+private:
+    std::vector<float> weights;
+};
+
+} /* namespace poker */
+
+#endif /* RANGE_H_ */
@@ -0,0 +1,344 @@
+#include "RangeEquityCalculator.h"
+#include "BoardEnumerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace poker {
+
+namespace {
+
+// Accepted matchups of a chunk, drawn from one substream.
+constexpr uint64_t CHUNK_TRIALS = 8192;
+
+// Boards of an enumeration task, each ranks the hands of all combinations.
+constexpr uint64_t ENUMERATION_GRAIN = 16;
+
+// Matchups drawn for every sampled board.
+constexpr uint32_t DRAWS_PER_BOARD = 64;
+
+// Gives up once this many matchups per requested trial got rejected, e.g.
+// for ranges that (almost) always conflict.
+constexpr uint64_t MAX_ATTEMPTS_PER_TRIAL = 100;
+
+}
+
+class RangeEquityCalculator::Tally {
+public:
+    explicit Tally(size_t players) :
+            wins(players), ties(players), shares(players), board_shares(
+                    players), squares(players), products(players) {
+    }
+
+    // Counts a matchup of the given weight.
+    void add(const HandRanking* rankings, double weight) {
+        size_t players = wins.size();
+        HandRanking best = rankings[0];
+        for (size_t p = 1; p < players; ++p) {
+            best = std::max(best, rankings[p]);
+        }
+        uint32_t winners = 0;
+        for (size_t p = 0; p < players; ++p) {
+            winners += rankings[p] == best;
+        }
+        double share = 1.0 / winners;
+        std::vector<double>& outcome = winners == 1 ? wins : ties;
+        for (size_t p = 0; p < players; ++p) {
+            if (rankings[p] == best) {
+                outcome[p] += weight;
+                shares[p] += weight * share;
+                board_shares[p] += weight * share;
+            }
+        }
+        total_weight += weight;
+        board_weight += weight;
+        samples++;
+    }
+
+    // Ends the matchups of a sampled board. They share the board, so the
+    // boards rather than the matchups are the independent samples.
+    void endBoard() {
+        if (board_weight == 0) {
+            return;
+        }
+        for (size_t p = 0; p < wins.size(); ++p) {
+            squares[p] += board_shares[p] * board_shares[p];
+            products[p] += board_shares[p] * board_weight;
+            board_shares[p] = 0;
+        }
+        weight_squares += board_weight * board_weight;
+        board_weight = 0;
+        boards++;
+    }
+
+    void merge(const Tally& o) {
+        for (size_t p = 0; p < wins.size(); ++p) {
+            wins[p] += o.wins[p];
+            ties[p] += o.ties[p];
+            shares[p] += o.shares[p];
+            squares[p] += o.squares[p];
+            products[p] += o.products[p];
+        }
+        total_weight += o.total_weight;
+        weight_squares += o.weight_squares;
+        samples += o.samples;
+        boards += o.boards;
+    }
+
+    EquityResult getResult(bool exact) const {
+        EquityResult result;
+        result.trials = samples;
+        for (size_t p = 0; p < wins.size(); ++p) {
+            PlayerEquity player;
+            if (total_weight > 0) {
+                double mean = shares[p] / total_weight;
+                player.win = wins[p] / total_weight;
+                player.tie = ties[p] / total_weight;
+                player.equity = mean;
+                if (!exact && boards > 1) {
+                    // Ratio estimator over the boards: the variance of the
+                    // board shares around mean times the board weights.
+                    double residuals = squares[p] - 2 * mean * products[p]
+                            + mean * mean * weight_squares;
+                    player.std_error = std::sqrt(std::max(0.0, residuals)
+                            * boards / (boards - 1)) / total_weight;
+                }
+            }
+            result.players.push_back(player);
+        }
+        return result;
+    }
+
+private:
+    uint64_t samples = 0;
+    uint64_t boards = 0;
+    double total_weight = 0;
+    double board_weight = 0;
+    double weight_squares = 0;
+    std::vector<double> wins;
+    std::vector<double> ties;
+    std::vector<double> shares;
+    // Of the current board.
+    std::vector<double> board_shares;
+    // Sums over the boards of the squared shares and of the shares times
+    // the board weight.
+    std::vector<double> squares;
+    std::vector<double> products;
+};
+
+// Ranks the hands of all combinations not blocked by a board. The buffers
+// are scratch memory of the task.
+class RangeEquityCalculator::BoardRanker {
+public:
+    BoardRanker(const RangeEquityCalculator& calc, ScratchArena& arena) :
+            calc(calc), hands(arena.allocate<CardSet>(calc.combos.size())),
+            rankings(arena.allocate<HandRanking>(calc.combos.size())),
+            slots(arena.allocate<uint32_t>(calc.combos.size())) {
+    }
+
+    void rank(const CardSet& board) {
+        uint64_t board_bits = board.cardBits();
+        size_t count = 0;
+        for (size_t k = 0; k < calc.combos.size(); ++k) {
+            if (calc.combo_bits[k] & board_bits) {
+                continue;
+            }
+            hands[count] = board;
+            hands[count].addAll(calc.combos[k]);
+            slots[k] = count++;
+        }
+        CardSet::rankTexasHoldemBatch(hands, rankings, count);
+    }
+
+    // Only valid for combinations not blocked by the board.
+    HandRanking get(size_t combo) const {
+        return rankings[slots[combo]];
+    }
+
+private:
+    const RangeEquityCalculator& calc;
+    CardSet* hands;
+    HandRanking* rankings;
+    uint32_t* slots;
+};
+
+RangeEquityCalculator::RangeEquityCalculator(const std::vector<Range>& ranges,
+        const CardSet& board, const CardSet& dead) :
+        board(board), excluded(board), missing_board_cards(5 - board.size()) {
+    if (ranges.size() < EquityCalculator::MIN_PLAYERS
+            || ranges.size() > EquityCalculator::MAX_PLAYERS) {
+        throw new std::runtime_error(
+                "Invalid number of players: " + std::to_string(ranges.size()));
+    }
+    if (board.size() > 5) {
+        throw new std::runtime_error(
+                "Invalid board size: " + std::to_string(board.size()));
+    }
+    if (board.cardBits() & dead.cardBits()) {
+        throw new std::runtime_error("Board and dead cards overlap");
+    }
+    excluded.addAll(dead);
+
+    offsets.push_back(0);
+    for (const Range& range : ranges) {
+        std::vector<size_t> live = range.liveCombos(excluded);
+        if (live.empty()) {
+            throw new std::runtime_error("Range without live combinations");
+        }
+        for (size_t index : live) {
+            CardSet cards = Range::combo(index).toCardSet();
+            combos.push_back(cards);
+            combo_bits.push_back(cards.cardBits());
+            combo_weights.push_back(range.getWeight(index));
+        }
+        offsets.push_back(combos.size());
+    }
+    setThreads(0);
+}
+
+void RangeEquityCalculator::setThreads(uint32_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    this->threads = threads;
+}
+
+template<typename F>
+void RangeEquityCalculator::parallelFor(uint64_t size, uint64_t grain,
+        F f) const {
+    withScheduler(scheduler, [&](TaskScheduler& workers) {
+        workers.parallelFor(0, size, grain, f);
+    }, threads);
+}
+
+EquityResult RangeEquityCalculator::calculate() const {
+    Tally total(offsets.size() - 1);
+    std::mutex mutex;
+    parallelFor((max_trials + CHUNK_TRIALS - 1) / CHUNK_TRIALS, 1,
+            [&](uint64_t begin, uint64_t end, ScratchArena& arena) {
+        runChunks(begin, end, arena, total, mutex);
+    });
+    return total.getResult(false);
+}
+
+void RangeEquityCalculator::runChunks(uint64_t begin, uint64_t end,
+        ScratchArena& arena, Tally& total, std::mutex& mutex) const {
+    const size_t players = offsets.size() - 1;
+    // Boards and matchups come from separate generators, both Philox so
+    // that any chunk's substream is positioned for free.
+    const PhiloxDeck seed_deck(excluded, seed);
+    const uint64_t matchup_key = ~static_cast<uint64_t>(seed);
+
+    std::vector<double> cumulative(combos.size());
+    for (size_t p = 0; p < players; ++p) {
+        double sum = 0;
+        for (size_t k = offsets[p]; k < offsets[p + 1]; ++k) {
+            sum += combo_weights[k];
+            cumulative[k] = sum;
+        }
+    }
+
+    Tally tally(players);
+    BoardRanker ranker(*this, arena);
+    HandRanking rankings[EquityCalculator::MAX_PLAYERS];
+    uint32_t words[PhiloxRandom::BUFFER_SIZE];
+    for (uint64_t chunk = begin; chunk < end; ++chunk) {
+        PhiloxDeck deck = seed_deck.split(chunk);
+        PhiloxRandom random(matchup_key, chunk);
+        int32_t position = PhiloxRandom::BUFFER_SIZE;
+        // Uniform in [0, 1), as sfmt_genrand_real2().
+        auto uniform = [&]() {
+            if (position == PhiloxRandom::BUFFER_SIZE) {
+                random.fill(words);
+                position = 0;
+            }
+            return words[position++] * (1.0 / 4294967296.0);
+        };
+        uint64_t trials = std::min(CHUNK_TRIALS,
+                max_trials - chunk * CHUNK_TRIALS);
+        uint64_t accepted = 0;
+        uint64_t attempts = 0;
+        while (accepted < trials
+                && attempts < trials * MAX_ATTEMPTS_PER_TRIAL) {
+            deck.shuffle();
+            CardSet full_board = board;
+            for (uint32_t i = 0; i < missing_board_cards; ++i) {
+                full_board.add(deck.deal());
+            }
+            ranker.rank(full_board);
+
+            for (uint32_t d = 0; d < DRAWS_PER_BOARD && accepted < trials;
+                    ++d) {
+                attempts++;
+                // The matchup is drawn independently of the board and only
+                // kept if nothing conflicts, so accepted boards and matchups
+                // follow the joint distribution.
+                uint64_t used = full_board.cardBits();
+                bool conflict = false;
+                for (size_t p = 0; p < players && !conflict; ++p) {
+                    const double* first = &cumulative[offsets[p]];
+                    const double* last = &cumulative[offsets[p + 1] - 1] + 1;
+                    double target = uniform() * last[-1];
+                    size_t k = std::upper_bound(first, last, target) - first
+                            + offsets[p];
+                    k = std::min(k, offsets[p + 1] - 1);
+                    conflict = used & combo_bits[k];
+                    used |= combo_bits[k];
+                    rankings[p] = ranker.get(k);
+                }
+                if (!conflict) {
+                    tally.add(rankings, 1);
+                    accepted++;
+                }
+            }
+            tally.endBoard();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    total.merge(tally);
+}
+
+EquityResult RangeEquityCalculator::enumerate() const {
+    const size_t players = offsets.size() - 1;
+    BoardEnumerator boards(board, excluded, missing_board_cards);
+    Tally total(players);
+    std::mutex mutex;
+
+    parallelFor(boards.size(), ENUMERATION_GRAIN,
+            [&](uint64_t begin, uint64_t end, ScratchArena& arena) {
+        Tally tally(players);
+        BoardRanker ranker(*this, arena);
+        HandRanking rankings[EquityCalculator::MAX_PLAYERS];
+
+        // Visits all matchups of the remaining players without conflicts.
+        std::function<void(size_t, uint64_t, double)> visit =
+                [&](size_t p, uint64_t used, double weight) {
+            if (p == players) {
+                tally.add(rankings, weight);
+                return;
+            }
+            for (size_t k = offsets[p]; k < offsets[p + 1]; ++k) {
+                if (used & combo_bits[k]) {
+                    continue;
+                }
+                rankings[p] = ranker.get(k);
+                visit(p + 1, used | combo_bits[k], weight * combo_weights[k]);
+            }
+        };
+
+        boards.forEach(begin, end, [&](const CardSet& full_board) {
+            ranker.rank(full_board);
+            visit(0, full_board.cardBits(), 1);
+        });
+
+        std::lock_guard<std::mutex> lock(mutex);
+        total.merge(tally);
+    });
+    return total.getResult(true);
+}
+
+} /* namespace poker */
@@ -0,0 +1,85 @@
+#ifndef RANGEEQUITYCALCULATOR_H_
+#define RANGEEQUITYCALCULATOR_H_
+
+#include "EquityCalculator.h"
+#include "Range.h"
+#include "TaskScheduler.h"
+
+#include <mutex>
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// Equity of ranges against each other, weighting every combination of hole
+// cards by its range weight and skipping those that share cards.
+//
+// Per board, the hands of all combinations not blocked by the board are
+// ranked once in a single batch, and every matchup on that board just looks
+// the rankings up.
+class RangeEquityCalculator {
+public:
+    RangeEquityCalculator(const std::vector<Range>& ranges,
+            const CardSet& board = CardSet(), const CardSet& dead = CardSet());
+
+    // Threads of the scheduler started for each calculation, defaults to
+    // the number of hardware threads.
+    void setThreads(uint32_t threads);
+
+    // Runs on the scheduler, shared with other calculations, instead of
+    // threads of its own. Null restores the default.
+    void setScheduler(TaskScheduler* scheduler) {
+        this->scheduler = scheduler;
+    }
+
+    void setSeed(uint32_t seed) {
+        this->seed = seed;
+    }
+
+    void setMaxTrials(uint64_t max_trials) {
+        this->max_trials = max_trials;
+    }
+
+    // Monte Carlo estimate. Each sampled board is reused for a number of
+    // matchups drawn by weight, those conflicting with the board or with each
+    // other are rejected. Reports the accepted matchups as trials. As with
+    // EquityCalculator, chunks of trials draw from their own substreams of
+    // the seed, so the thread count does not change the samples.
+    EquityResult calculate() const;
+
+    // Exact equity over all boards and all non-conflicting matchups, reported
+    // as trials. The work grows with the product of the range sizes, so this
+    // is meant for heads-up or narrow ranges.
+    EquityResult enumerate() const;
+
+private:
+    class Tally;
+    class BoardRanker;
+
+    template<typename F>
+    void parallelFor(uint64_t size, uint64_t grain, F f) const;
+    void runChunks(uint64_t begin, uint64_t end, ScratchArena& arena,
+            Tally& total, std::mutex& mutex) const;
+
+    // The live combinations of all players, concatenated.
+    std::vector<CardSet> combos;
+    std::vector<uint64_t> combo_bits;
+    std::vector<double> combo_weights;
+    // Player p owns the combinations [offsets[p], offsets[p + 1]).
+    std::vector<size_t> offsets;
+
+    CardSet board;
+    CardSet excluded;
+    uint32_t missing_board_cards;
+
+    uint32_t threads;
+    TaskScheduler* scheduler = nullptr;
+    uint32_t seed = PhiloxDeck::DEFAULT_SEED;
+    uint64_t max_trials = EquityCalculator::DEFAULT_MAX_TRIALS;
+};
+
+} /* namespace poker */
+
+#endif /* RANGEEQUITYCALCULATOR_H_ */
@@ -0,0 +1,768 @@
+// Hand ranking kernels.
+//
+// This file has no include guard on purpose: CpuDispatch.cpp includes it once
+// per supported instruction set, each time inside a "#pragma GCC target"
+// region and with RANK_KERNEL_NAMESPACE naming the namespace of that variant.
+// As GCC does not update __SSE4_1__, __AVX2__ and friends for the pragma in
+// C++, the code paths are selected by the following switches instead:
+//
+//   RANK_KERNEL_SSE4    SSE4.1/4.2 and POPCNT instructions
+//   RANK_KERNEL_AVX2    8 hands per step in the batch kernel
+//   RANK_KERNEL_AVX512  16 hands per step in the batch kernel (AVX-512F/CD)
+//
+// Kernels return the raw HandRanking value, CardSet wraps them. Next to the
+// seven card kernels there are variants for five and six cards, which drop
+// fewer of the lowest side cards, and for short deck Hold'em (SHORT_DECK).
+
+namespace poker {
+namespace RANK_KERNEL_NAMESPACE {
+
+template<typename T>
+inline T unlikely(T t) {
+    return __builtin_expect(t, 0);
+}
+
+inline bool all_zeros(__m128i v, __m128i mask) {
+#ifdef RANK_KERNEL_SSE4
+    return _mm_testz_si128(v, mask);
+#else
+    v = _mm_and_si128(v, mask);
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_setzero_si128()))
+            == 0xffff;
+#endif
+}
+
+inline uint64_t upper_bits(__m128i v) {
+#ifdef RANK_KERNEL_SSE4
+    return _mm_extract_epi64(v, 1);
+#else
+    return _mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v));
+#endif
+}
+
+inline bool multiple_bits_set(uint32_t v) {
+    return v & (v - 1);
+}
+
+inline uint32_t lowest_bit(uint32_t v) {
+    return v & (-v);
+}
+
+template<typename T>
+inline T erase_lowest_bit(T v) {
+    return v & (v - 1);
+}
+
+// Drops the DROP lowest side cards, those that do not make it into the best
+// five of 5 + DROP cards.
+template<int DROP>
+inline uint32_t erase_lowest_bits(uint32_t v) {
+    for (int i = 0; i < DROP; ++i) {
+        v &= (v - 1);
+    }
+    return v;
+}
+
+inline uint32_t highest_bit_ranking(uint32_t v) {
+    return -__builtin_clz(v);
+}
+
+inline uint32_t trailing_zeros(uint32_t v) {
+    return __builtin_ctz(v);
+}
+
+template<typename F>
+inline __m128i combine4(__m128i v, F f) {
+    __m128i r = f(v, _mm_shufflehi_epi16(v, _MM_SHUFFLE(2,3,0,1)));
+    return f(r, _mm_shufflehi_epi16(r, _MM_SHUFFLE(1,0,3,2)));
+}
+
+inline __m128i vand(__m128i a, __m128i b) {
+    return _mm_and_si128(a, b);
+}
+
+inline uint64_t create(HandRanking::Ranking ranking, uint32_t height,
+        uint32_t side_cards) {
+    return (static_cast<uint64_t>(ranking) << HandRanking::RANKING_SHIFT)
+            | (static_cast<uint64_t>(height) << 32) | side_cards;
+}
+
+inline uint64_t create(HandRanking::Ranking ranking, uint32_t height) {
+    return (static_cast<uint64_t>(ranking) << HandRanking::RANKING_SHIFT)
+            | height;
+}
+
+// Short deck (sixes to aces) moves the ace below the six for the lowest
+// straight, where the five would be, and ranks flushes above full houses.
+// The value swaps the two categories, ShortDeckRanking swaps them back.
+template<bool SHORT_DECK>
+constexpr HandRanking::Ranking flush_category() {
+    return SHORT_DECK ? HandRanking::FULL_HOUSE : HandRanking::FLUSH;
+}
+
+template<bool SHORT_DECK>
+constexpr HandRanking::Ranking full_house_category() {
+    return SHORT_DECK ? HandRanking::FLUSH : HandRanking::FULL_HOUSE;
+}
+
+// The ace of the rank bits at 2 * rank + 3 below the lowest rank: below the
+// two, or at the five.
+template<bool SHORT_DECK>
+inline uint32_t low_ace(uint32_t colorless) {
+    return SHORT_DECK ? (colorless >> 18) & (1 << 9) : colorless >> 26;
+}
+
+// The same for the bits at rank + 1 of a color word.
+template<bool SHORT_DECK>
+inline uint32_t low_ace_word(uint32_t cards) {
+    return SHORT_DECK ? (cards >> 9) & (1 << 4) : cards >> 13;
+}
+
+// Best five cards of 5 + DROP cards.
+template<int DROP, bool SHORT_DECK = false>
+inline uint64_t rank_cards(__m128i cv) {
+    __m128i flush = _mm_cmpgt_epi8(cv, _mm_set1_epi8(4));
+    if (unlikely(!all_zeros(flush, _mm_set_epi32(0, 0, -1, 0)))) {
+        uint32_t color = trailing_zeros(_mm_movemask_epi8(flush) >> 4);
+        uint16_t flush_cards = upper_bits(cv) >> (color * 16);
+
+        uint32_t flush_cards_dup = flush_cards
+                | low_ace_word<SHORT_DECK>(flush_cards);
+        uint32_t straight_flush = flush_cards & (flush_cards_dup << 1);
+        straight_flush &= (straight_flush << 2);
+        straight_flush &= (flush_cards_dup << 4);
+        if (unlikely(straight_flush != 0)) {
+            return create(HandRanking::STRAIGHT_FLUSH,
+                    highest_bit_ranking(straight_flush));
+        }
+        uint32_t color_cnts = _mm_cvtsi128_si64(cv) >> 32;
+        uint32_t flush_card_count = (color_cnts >> (8 * color)) & 0xff;
+        if (flush_card_count > 5) {
+            flush_cards = erase_lowest_bit(flush_cards);
+        }
+        if (flush_card_count > 6) {
+            flush_cards = erase_lowest_bit(flush_cards);
+        }
+        return create(flush_category<SHORT_DECK>(), flush_cards);
+    }
+
+    uint32_t sum_bits = _mm_cvtsi128_si64(cv);
+
+    // Check for four of a kind:
+    __m128i four_of_a_kind = combine4(cv, vand);
+    if (unlikely(!all_zeros(four_of_a_kind, _mm_set_epi64x(-1, 0)))) {
+        // Congratulations! You have a four of a kind!
+        // Note that this makes straight flush impossible at the same time.
+        // Now need the highest card not part of the poker as side card.
+        uint32_t fok = _mm_extract_epi16(four_of_a_kind, 5);
+        uint32_t fok_bit = (4 << (trailing_zeros(fok) * 2));
+        sum_bits -= fok_bit;
+        uint32_t side_cards = (sum_bits | (sum_bits << 1)) & 0x2aaaaaaa;
+
+        return create(HandRanking::FOUR_OF_A_KIND, fok,
+                highest_bit_ranking(side_cards));
+    }
+
+    uint32_t one_of_a_kind = (sum_bits << 1) & 0x2aaaaaaa;
+    uint32_t two_of_a_kind = sum_bits & 0x2aaaaaaa;
+    uint32_t colorless = one_of_a_kind | two_of_a_kind;
+
+    // Straight:
+    uint32_t straight_bits = colorless | low_ace<SHORT_DECK>(colorless);
+    uint32_t straight = colorless & (straight_bits << 2);
+    straight = straight & (straight << 4);
+    straight = straight & (straight_bits << 8);
+    if (unlikely(straight != 0)) {
+        return create(HandRanking::STRAIGHT, highest_bit_ranking(straight));
+    }
+
+    // Three of a kind:
+    uint32_t three_of_a_kind = one_of_a_kind & two_of_a_kind;
+    if (unlikely(three_of_a_kind != 0)) {
+        two_of_a_kind ^= three_of_a_kind;
+        if (multiple_bits_set(three_of_a_kind)) {
+            // Two three-of-a-kind. The lower one is our pair for the full house.
+            two_of_a_kind = lowest_bit(three_of_a_kind);
+            three_of_a_kind ^= two_of_a_kind;
+        }
+        if (two_of_a_kind != 0) {
+            // Full house!
+            // There could still be multiple two-of-a-kind. Keep highest only.
+            return create(full_house_category<SHORT_DECK>(), three_of_a_kind,
+                    highest_bit_ranking(two_of_a_kind));
+        }
+        uint32_t side_cards = erase_lowest_bits<DROP>(
+                colorless ^ three_of_a_kind);
+        return create(HandRanking::THREE_OF_A_KIND, three_of_a_kind,
+                side_cards);
+    }
+
+#ifdef RANK_KERNEL_SSE4
+    uint32_t pairs = _mm_popcnt_u32(two_of_a_kind);
+    bool has_three_pairs = (pairs == 3);
+#else
+    // Emulate popcnt for 0-2 bits:
+    uint32_t remaining_pairs = two_of_a_kind;
+    uint32_t pairs = (remaining_pairs == 0) ? 0 : 1;
+    remaining_pairs = erase_lowest_bit(remaining_pairs);
+    pairs += (remaining_pairs == 0) ? 0 : 1;
+    remaining_pairs = erase_lowest_bit(remaining_pairs);
+    bool has_three_pairs = (remaining_pairs != 0);
+#endif
+    if (unlikely(has_three_pairs)) {
+        // Three pairs, only keep highest two.
+        uint32_t tok3 = lowest_bit(two_of_a_kind);
+        // Kicker is either highest card not part of any pairs or one of the lowest pair cards.
+        uint32_t side_cards = std::max(colorless ^ two_of_a_kind, tok3);
+        return create(HandRanking::TWO_PAIRS, two_of_a_kind ^ tok3,
+                side_cards);
+    }
+
+    // Zero to two pairs. Kicker are those cards that remain after removing the pairs and the lowest two cards.
+    uint32_t side_cards = erase_lowest_bits<DROP>(colorless ^ two_of_a_kind);
+    return create(static_cast<HandRanking::Ranking>(pairs), two_of_a_kind,
+            side_cards);
+}
+
+inline uint64_t rankTexasHoldem(__m128i cv) {
+    return rank_cards<2>(cv);
+}
+
+uint64_t rankFiveCards(__m128i cv) {
+    return rank_cards<0>(cv);
+}
+
+uint64_t rankSixCards(__m128i cv) {
+    return rank_cards<1>(cv);
+}
+
+uint64_t rankShortDeck(__m128i cv) {
+    return rank_cards<2, true>(cv);
+}
+
+// The batch ranking works on a transposed layout: every 32-bit lane holds one
+// hand and the four 32-bit words of a card vector (card counts, color counts
+// and the two pairs of color words) live in four separate registers. That
+// way the kicker logic of rankTexasHoldem() maps to lane-wise integer
+// operations and the category is picked with blends instead of branches.
+// With only four lanes (SSE) this does not beat the scalar kernel, so below
+// AVX2 the batch just loops over rankTexasHoldem().
+
+#ifdef RANK_KERNEL_AVX2
+struct Avx2Lanes {
+    typedef __m256i V;
+    typedef __m256i M;
+    constexpr static size_t WIDTH = 8;
+
+    static V set1(uint32_t v) {
+        return _mm256_set1_epi32(v);
+    }
+    static V vand(V a, V b) {
+        return _mm256_and_si256(a, b);
+    }
+    static V vor(V a, V b) {
+        return _mm256_or_si256(a, b);
+    }
+    static V vxor(V a, V b) {
+        return _mm256_xor_si256(a, b);
+    }
+    static V vadd(V a, V b) {
+        return _mm256_add_epi32(a, b);
+    }
+    static V vsub(V a, V b) {
+        return _mm256_sub_epi32(a, b);
+    }
+    static V vmul(V a, V b) {
+        return _mm256_mullo_epi32(a, b);
+    }
+    static V vmax(V a, V b) {
+        return _mm256_max_epu32(a, b);
+    }
+    template<int N>
+    static V shl(V a) {
+        return _mm256_slli_epi32(a, N);
+    }
+    template<int N>
+    static V shr(V a) {
+        return _mm256_srli_epi32(a, N);
+    }
+    static M non_zero(V a) {
+        return _mm256_xor_si256(_mm256_cmpeq_epi32(a, _mm256_setzero_si256()),
+                _mm256_set1_epi32(-1));
+    }
+    static M greater(V a, V b) {
+        return _mm256_cmpgt_epi32(a, b);
+    }
+    static M equal(V a, V b) {
+        return _mm256_cmpeq_epi32(a, b);
+    }
+    static uint32_t bits(M m) {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(m));
+    }
+    // Maximum of all lanes, in every lane.
+    static V hmax(V v) {
+        v = vmax(v, _mm256_permute2x128_si256(v, v, 1));
+        v = vmax(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+        return vmax(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+    static M mand(M a, M b) {
+        return _mm256_and_si256(a, b);
+    }
+    static M mor(M a, M b) {
+        return _mm256_or_si256(a, b);
+    }
+    static M mandnot(M a, M b) {
+        return _mm256_andnot_si256(a, b);
+    }
+    static V select(M m, V a, V b) {
+        return _mm256_blendv_epi8(b, a, m);
+    }
+    static V highest_bit_ranking(V v) {
+        // -clz(v) for 0 < v < 2^30. Converting to float is only exact for up
+        // to 24 significant bits, so larger values are shifted down first.
+        V high = shr<8>(v);
+        M use_high = non_zero(high);
+        V exponent = shr<23>(_mm256_castps_si256(
+                _mm256_cvtepi32_ps(select(use_high, high, v))));
+        return vsub(exponent,
+                select(use_high, set1(127 + 31 - 8), set1(127 + 31)));
+    }
+
+    static V load2(const __m128i* in, int i) {
+        return _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(in + i)),
+                _mm_loadu_si128(in + i + 4), 1);
+    }
+
+    static void load(const __m128i* in, V& sum, V& colors, V& words_lo,
+            V& words_hi) {
+        V r0 = load2(in, 0);
+        V r1 = load2(in, 1);
+        V r2 = load2(in, 2);
+        V r3 = load2(in, 3);
+        V t0 = _mm256_unpacklo_epi32(r0, r1);
+        V t1 = _mm256_unpacklo_epi32(r2, r3);
+        V t2 = _mm256_unpackhi_epi32(r0, r1);
+        V t3 = _mm256_unpackhi_epi32(r2, r3);
+        sum = _mm256_unpacklo_epi64(t0, t1);
+        colors = _mm256_unpackhi_epi64(t0, t1);
+        words_lo = _mm256_unpacklo_epi64(t2, t3);
+        words_hi = _mm256_unpackhi_epi64(t2, t3);
+    }
+
+    static void store(uint64_t* out, V hi, V lo) {
+        V v0 = _mm256_unpacklo_epi32(lo, hi);
+        V v1 = _mm256_unpackhi_epi32(lo, hi);
+        _mm256_storeu_si256(reinterpret_cast<V*>(out),
+                _mm256_permute2x128_si256(v0, v1, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<V*>(out + 4),
+                _mm256_permute2x128_si256(v0, v1, 0x31));
+    }
+};
+#endif
+
+#ifdef RANK_KERNEL_AVX512
+struct Avx512Lanes {
+    typedef __m512i V;
+    typedef __mmask16 M;
+    constexpr static size_t WIDTH = 16;
+
+    static V set1(uint32_t v) {
+        return _mm512_set1_epi32(v);
+    }
+    static V vand(V a, V b) {
+        return _mm512_and_si512(a, b);
+    }
+    static V vor(V a, V b) {
+        return _mm512_or_si512(a, b);
+    }
+    static V vxor(V a, V b) {
+        return _mm512_xor_si512(a, b);
+    }
+    static V vadd(V a, V b) {
+        return _mm512_add_epi32(a, b);
+    }
+    static V vsub(V a, V b) {
+        return _mm512_sub_epi32(a, b);
+    }
+    static V vmul(V a, V b) {
+        return _mm512_mullo_epi32(a, b);
+    }
+    static V vmax(V a, V b) {
+        return _mm512_max_epu32(a, b);
+    }
+    template<int N>
+    static V shl(V a) {
+        return _mm512_slli_epi32(a, N);
+    }
+    template<int N>
+    static V shr(V a) {
+        return _mm512_srli_epi32(a, N);
+    }
+    static M non_zero(V a) {
+        return _mm512_test_epi32_mask(a, a);
+    }
+    static M greater(V a, V b) {
+        return _mm512_cmpgt_epi32_mask(a, b);
+    }
+    static M equal(V a, V b) {
+        return _mm512_cmpeq_epi32_mask(a, b);
+    }
+    static uint32_t bits(M m) {
+        return m;
+    }
+    static V hmax(V v) {
+        return _mm512_set1_epi32(_mm512_reduce_max_epu32(v));
+    }
+    static M mand(M a, M b) {
+        return a & b;
+    }
+    static M mor(M a, M b) {
+        return a | b;
+    }
+    static M mandnot(M a, M b) {
+        return ~a & b;
+    }
+    static V select(M m, V a, V b) {
+        return _mm512_mask_blend_epi32(m, b, a);
+    }
+    static V highest_bit_ranking(V v) {
+        return _mm512_sub_epi32(_mm512_setzero_si512(), _mm512_lzcnt_epi32(v));
+    }
+
+    static V load4(const __m128i* in, int i) {
+        V v = _mm512_castsi128_si512(_mm_loadu_si128(in + i));
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(in + i + 4), 1);
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(in + i + 8), 2);
+        return _mm512_inserti32x4(v, _mm_loadu_si128(in + i + 12), 3);
+    }
+
+    static void load(const __m128i* in, V& sum, V& colors, V& words_lo,
+            V& words_hi) {
+        V r0 = load4(in, 0);
+        V r1 = load4(in, 1);
+        V r2 = load4(in, 2);
+        V r3 = load4(in, 3);
+        V t0 = _mm512_unpacklo_epi32(r0, r1);
+        V t1 = _mm512_unpacklo_epi32(r2, r3);
+        V t2 = _mm512_unpackhi_epi32(r0, r1);
+        V t3 = _mm512_unpackhi_epi32(r2, r3);
+        sum = _mm512_unpacklo_epi64(t0, t1);
+        colors = _mm512_unpackhi_epi64(t0, t1);
+        words_lo = _mm512_unpacklo_epi64(t2, t3);
+        words_hi = _mm512_unpackhi_epi64(t2, t3);
+    }
+
+    static void store(uint64_t* out, V hi, V lo) {
+        // 64-bit lanes of v0 hold hands 0,1,4,5,8,9,12,13 and v1 the rest.
+        V v0 = _mm512_unpacklo_epi32(lo, hi);
+        V v1 = _mm512_unpackhi_epi32(lo, hi);
+        _mm512_storeu_si512(out, _mm512_permutex2var_epi64(v0,
+                _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11), v1));
+        _mm512_storeu_si512(out + 8, _mm512_permutex2var_epi64(v0,
+                _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15), v1));
+    }
+};
+#endif
+
+#if defined(RANK_KERNEL_AVX2) || defined(RANK_KERNEL_AVX512)
+template<typename L>
+inline typename L::V erase_lowest_bit_lanes(typename L::V v) {
+    return L::vand(v, L::vsub(v, L::set1(1)));
+}
+
+template<typename L>
+inline typename L::V lowest_bit_lanes(typename L::V v) {
+    return L::vand(v, L::vsub(L::set1(0), v));
+}
+
+template<typename L, int COLOR>
+inline void select_flush_color(typename L::V colors, typename L::V word,
+        typename L::V& flush_cards, typename L::V& flush_card_count) {
+    // A color count of at least 5 gets bit 3 set by adding 3.
+    typename L::M is_flush_color = L::non_zero(L::vand(
+            L::vadd(colors, L::set1(0x03 << (8 * COLOR))),
+            L::set1(0x08 << (8 * COLOR))));
+    flush_cards = L::select(is_flush_color, word, flush_cards);
+    flush_card_count = L::select(is_flush_color,
+            L::vand(L::template shr<8 * COLOR>(colors), L::set1(0xff)),
+            flush_card_count);
+}
+
+// Lane-parallel version of rankTexasHoldem(). Stores the upper and lower 32
+// bits of the HandRanking value of every lane in hi and lo.
+template<typename L, int DROP>
+inline typename L::V erase_lowest_bits_lanes(typename L::V v) {
+    for (int i = 0; i < DROP; ++i) {
+        v = erase_lowest_bit_lanes<L>(v);
+    }
+    return v;
+}
+
+template<typename L, bool SHORT_DECK>
+inline typename L::V low_ace_lanes(typename L::V colorless) {
+    return SHORT_DECK ?
+            L::vand(L::template shr<18>(colorless), L::set1(1 << 9)) :
+            L::template shr<26>(colorless);
+}
+
+template<typename L, bool SHORT_DECK>
+inline typename L::V low_ace_word_lanes(typename L::V cards) {
+    return SHORT_DECK ?
+            L::vand(L::template shr<9>(cards), L::set1(1 << 4)) :
+            L::template shr<13>(cards);
+}
+
+template<typename L, int DROP, bool SHORT_DECK>
+inline void rank_lanes(typename L::V sum, typename L::V colors,
+        typename L::V words_lo, typename L::V words_hi, typename L::V& hi,
+        typename L::V& lo) {
+    typedef typename L::V V;
+    typedef typename L::M M;
+    const V odd_bits = L::set1(0x2aaaaaaa);
+    const V zero = L::set1(0);
+    const V one = L::set1(1);
+
+    V w0 = L::vand(words_lo, L::set1(0xffff));
+    V w1 = L::template shr<16>(words_lo);
+    V w2 = L::vand(words_hi, L::set1(0xffff));
+    V w3 = L::template shr<16>(words_hi);
+
+    V flush_cards = zero;
+    V flush_card_count = zero;
+    select_flush_color<L, 0>(colors, w0, flush_cards, flush_card_count);
+    select_flush_color<L, 1>(colors, w1, flush_cards, flush_card_count);
+    select_flush_color<L, 2>(colors, w2, flush_cards, flush_card_count);
+    select_flush_color<L, 3>(colors, w3, flush_cards, flush_card_count);
+    M is_flush = L::non_zero(flush_cards);
+
+    V flush_cards_dup = L::vor(flush_cards,
+            low_ace_word_lanes<L, SHORT_DECK>(flush_cards));
+    V straight_flush = L::vand(flush_cards,
+            L::template shl<1>(flush_cards_dup));
+    straight_flush = L::vand(straight_flush,
+            L::template shl<2>(straight_flush));
+    straight_flush = L::vand(straight_flush,
+            L::template shl<4>(flush_cards_dup));
+    M is_straight_flush = L::non_zero(straight_flush);
+
+    flush_cards = L::select(L::greater(flush_card_count, L::set1(5)),
+            erase_lowest_bit_lanes<L>(flush_cards), flush_cards);
+    flush_cards = L::select(L::greater(flush_card_count, L::set1(6)),
+            erase_lowest_bit_lanes<L>(flush_cards), flush_cards);
+
+    // Four of a kind. The poker has a single bit, so its count bit in the sum
+    // is the square of that bit shifted by two.
+    V fok = L::vand(L::vand(w0, w1), L::vand(w2, w3));
+    M is_four_of_a_kind = L::non_zero(fok);
+    V fok_sum = L::vsub(sum, L::template shl<2>(L::vmul(fok, fok)));
+    V fok_side_cards = L::vand(L::vor(fok_sum, L::template shl<1>(fok_sum)),
+            odd_bits);
+
+    V one_of_a_kind = L::vand(L::template shl<1>(sum), odd_bits);
+    V two_of_a_kind = L::vand(sum, odd_bits);
+    V colorless = L::vor(one_of_a_kind, two_of_a_kind);
+
+    V straight_bits = L::vor(colorless,
+            low_ace_lanes<L, SHORT_DECK>(colorless));
+    V straight = L::vand(colorless, L::template shl<2>(straight_bits));
+    straight = L::vand(straight, L::template shl<4>(straight));
+    straight = L::vand(straight, L::template shl<8>(straight_bits));
+    M is_straight = L::non_zero(straight);
+
+    V three_of_a_kind = L::vand(one_of_a_kind, two_of_a_kind);
+    M is_three_of_a_kind = L::non_zero(three_of_a_kind);
+    M two_threes = L::non_zero(erase_lowest_bit_lanes<L>(three_of_a_kind));
+    V lowest_three = lowest_bit_lanes<L>(three_of_a_kind);
+    V fh_pairs = L::select(two_threes, lowest_three,
+            L::vxor(two_of_a_kind, three_of_a_kind));
+    V fh_three = L::select(two_threes, L::vxor(three_of_a_kind, lowest_three),
+            three_of_a_kind);
+    M is_full_house = L::mand(is_three_of_a_kind, L::non_zero(fh_pairs));
+
+    V second_pair = erase_lowest_bit_lanes<L>(two_of_a_kind);
+    M has_three_pairs = L::non_zero(erase_lowest_bit_lanes<L>(second_pair));
+    V lowest_pair = lowest_bit_lanes<L>(two_of_a_kind);
+
+    // Zero to two pairs.
+    V category = L::vadd(L::select(L::non_zero(two_of_a_kind), one, zero),
+            L::select(L::non_zero(second_pair), one, zero));
+    V height = two_of_a_kind;
+    V side = erase_lowest_bits_lanes<L, DROP>(
+            L::vxor(colorless, two_of_a_kind));
+
+    category = L::select(has_three_pairs, L::set1(HandRanking::TWO_PAIRS),
+            category);
+    height = L::select(has_three_pairs, L::vxor(two_of_a_kind, lowest_pair),
+            height);
+    side = L::select(has_three_pairs,
+            L::vmax(L::vxor(colorless, two_of_a_kind), lowest_pair), side);
+
+    category = L::select(is_three_of_a_kind,
+            L::set1(HandRanking::THREE_OF_A_KIND), category);
+    height = L::select(is_three_of_a_kind, three_of_a_kind, height);
+    side = L::select(is_three_of_a_kind,
+            erase_lowest_bits_lanes<L, DROP>(
+                    L::vxor(colorless, three_of_a_kind)), side);
+
+    // The categories from here on are mutually exclusive, except for
+    // straights which are overruled by flushes. All but the flush use the
+    // highest bit ranking of a single mask as side cards.
+    category = L::select(is_full_house,
+            L::set1(full_house_category<SHORT_DECK>()), category);
+    height = L::select(is_full_house, fh_three, height);
+    V ranked = fh_pairs;
+
+    category = L::select(is_straight, L::set1(HandRanking::STRAIGHT),
+            category);
+    height = L::select(is_straight, zero, height);
+    ranked = L::select(is_straight, straight, ranked);
+
+    category = L::select(is_four_of_a_kind,
+            L::set1(HandRanking::FOUR_OF_A_KIND), category);
+    height = L::select(is_four_of_a_kind, fok, height);
+    ranked = L::select(is_four_of_a_kind, fok_side_cards, ranked);
+
+    category = L::select(is_straight_flush,
+            L::set1(HandRanking::STRAIGHT_FLUSH), category);
+    ranked = L::select(is_straight_flush, straight_flush, ranked);
+
+    M use_ranked = L::mor(L::mor(is_full_house, is_straight),
+            L::mor(is_four_of_a_kind, is_straight_flush));
+    side = L::select(use_ranked, L::highest_bit_ranking(ranked), side);
+
+    M is_plain_flush = L::mandnot(is_straight_flush, is_flush);
+    category = L::select(is_plain_flush,
+            L::set1(flush_category<SHORT_DECK>()), category);
+    side = L::select(is_plain_flush, flush_cards, side);
+    height = L::select(is_flush, zero, height);
+
+    hi = L::vor(L::template shl<HandRanking::RANKING_SHIFT - 32>(category),
+            height);
+    lo = side;
+}
+
+template<typename L, int DROP, bool SHORT_DECK>
+inline size_t rank_batch(const __m128i* in, uint64_t* out, size_t n) {
+    typedef typename L::V V;
+    size_t i = 0;
+    for (; i + L::WIDTH <= n; i += L::WIDTH) {
+        V sum, colors, words_lo, words_hi, hi, lo;
+        L::load(in + i, sum, colors, words_lo, words_hi);
+        rank_lanes<L, DROP, SHORT_DECK>(sum, colors, words_lo, words_hi, hi,
+                lo);
+        L::store(out + i, hi, lo);
+    }
+    return i;
+}
+#endif
+
+template<int DROP, bool SHORT_DECK = false>
+inline void rank_cards_batch(const __m128i* in, uint64_t* out, size_t n) {
+    size_t done = 0;
+#if defined(RANK_KERNEL_AVX512)
+    done = rank_batch<Avx512Lanes, DROP, SHORT_DECK>(in, out, n);
+#elif defined(RANK_KERNEL_AVX2)
+    done = rank_batch<Avx2Lanes, DROP, SHORT_DECK>(in, out, n);
+#endif
+    for (size_t i = done; i < n; ++i) {
+        out[i] = rank_cards<DROP, SHORT_DECK>(in[i]);
+    }
+}
+
+void rankTexasHoldemBatch(const __m128i* in, uint64_t* out, size_t n) {
+    rank_cards_batch<2>(in, out, n);
+}
+
+void rankFiveCardsBatch(const __m128i* in, uint64_t* out, size_t n) {
+    rank_cards_batch<0>(in, out, n);
+}
+
+void rankSixCardsBatch(const __m128i* in, uint64_t* out, size_t n) {
+    rank_cards_batch<1>(in, out, n);
+}
+
+void rankShortDeckBatch(const __m128i* in, uint64_t* out, size_t n) {
+    rank_cards_batch<2, true>(in, out, n);
+}
+
+#if defined(RANK_KERNEL_AVX2) || defined(RANK_KERNEL_AVX512)
+// Ranks up to detail::MAX_SHOWDOWN hands in lanes and picks the winners without
+// leaving them: the maximum of the upper halves of the rankings first, then
+// of the lower halves of the hands that reach it.
+template<typename L>
+inline uint32_t showdown_lanes(const __m128i* in, size_t n, uint64_t* out) {
+    typedef typename L::V V;
+    constexpr size_t MAX_SHOWDOWN = detail::MAX_SHOWDOWN;
+    constexpr size_t BLOCKS = MAX_SHOWDOWN / L::WIDTH;
+    __m128i hands[MAX_SHOWDOWN];
+    size_t blocks = (n + L::WIDTH - 1) / L::WIDTH;
+    std::copy(in, in + n, hands);
+    // Repeating a hand does not change the winning ranking.
+    std::fill(hands + n, hands + blocks * L::WIDTH, in[0]);
+
+    V his[BLOCKS], los[BLOCKS];
+    uint64_t rankings[MAX_SHOWDOWN];
+    V max_hi = L::set1(0);
+    for (size_t b = 0; b < blocks; ++b) {
+        V sum, colors, words_lo, words_hi;
+        L::load(hands + b * L::WIDTH, sum, colors, words_lo, words_hi);
+        rank_lanes<L, 2, false>(sum, colors, words_lo, words_hi, his[b],
+                los[b]);
+        max_hi = L::vmax(max_hi, his[b]);
+        if (out) {
+            L::store(rankings + b * L::WIDTH, his[b], los[b]);
+        }
+    }
+    max_hi = L::hmax(max_hi);
+
+    V max_lo = L::set1(0);
+    for (size_t b = 0; b < blocks; ++b) {
+        los[b] = L::select(L::equal(his[b], max_hi), los[b], L::set1(0));
+        max_lo = L::vmax(max_lo, los[b]);
+    }
+    max_lo = L::hmax(max_lo);
+
+    uint64_t winners = 0;
+    for (size_t b = 0; b < blocks; ++b) {
+        uint64_t block = L::bits(L::mand(L::equal(his[b], max_hi),
+                L::equal(los[b], max_lo)));
+        winners |= block << (b * L::WIDTH);
+    }
+    if (out) {
+        std::copy(rankings, rankings + n, out);
+    }
+    return winners & ((static_cast<uint64_t>(1) << n) - 1);
+}
+#endif
+
+// Bit i set for every one of the n seven card hands that has the highest
+// ranking. Stores the rankings to out, unless it is null.
+uint32_t showdown(const __m128i* in, size_t n, uint64_t* out) {
+    if (n == 0) {
+        return 0;
+    }
+#if defined(RANK_KERNEL_AVX512)
+    return showdown_lanes<Avx512Lanes>(in, n, out);
+#elif defined(RANK_KERNEL_AVX2)
+    return showdown_lanes<Avx2Lanes>(in, n, out);
+#else
+    uint64_t best = 0;
+    uint32_t winners = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t ranking = rankTexasHoldem(in[i]);
+        if (out) {
+            out[i] = ranking;
+        }
+        if (ranking > best) {
+            best = ranking;
+            winners = 0;
+        }
+        winners |= ranking == best ? 1u << i : 0;
+    }
+    return winners;
+#endif
+}
+
+} // namespace RANK_KERNEL_NAMESPACE
+} // namespace poker
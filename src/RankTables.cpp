@@ -0,0 +1,218 @@
+#include "RankTables.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <string.h>
+
+namespace poker {
+namespace detail {
+
+namespace {
+
+constexpr uint32_t CARDS = 7;
+constexpr uint32_t RANKS = 13;
+
+// Card vector of a single card, see CardSet::internalToCardVec().
+__m128i cardVec(uint32_t rank, uint32_t color) {
+    constexpr uint64_t one = 1;
+    return _mm_set_epi64x(one << (16 * color + rank + 1),
+            (one << (2 * rank + 2)) | (one << (8 * color + 32)));
+}
+
+// Number of rank count sequences of the given length with counts from zero
+// to four that sum up to cards.
+class MultisetCounts {
+public:
+    MultisetCounts() {
+        memset(counts, 0, sizeof(counts));
+        counts[0][0] = 1;
+        for (uint32_t length = 1; length <= RANKS; ++length) {
+            for (uint32_t cards = 0; cards <= CARDS; ++cards) {
+                for (uint32_t c = 0; c <= std::min(4u, cards); ++c) {
+                    counts[length][cards] += counts[length - 1][cards - c];
+                }
+            }
+        }
+    }
+
+    uint32_t operator()(uint32_t length, uint32_t cards) const {
+        return counts[length][cards];
+    }
+
+    // Part of the lexicographic index contributed by the counts of ranks
+    // [first, first + ranks) with cards still to come before them, or -1 if
+    // there are not enough cards.
+    int32_t part(uint32_t first, uint32_t ranks, uint32_t cards,
+            uint32_t digits) const {
+        int32_t index = 0;
+        for (uint32_t r = first; r < first + ranks; ++r) {
+            uint32_t count = (digits >> (2 * (r - first))) & 3;
+            if (count > cards) {
+                return -1;
+            }
+            // All sequences with a smaller count for this rank come first.
+            for (uint32_t c = 0; c < count; ++c) {
+                index += counts[RANKS - 1 - r][cards - c];
+            }
+            cards -= count;
+        }
+        return index;
+    }
+
+private:
+    uint32_t counts[RANKS + 1][CARDS + 1];
+};
+
+// Calls f with the 2-bit counts of every way to distribute the remaining
+// cards over the ranks from rank on, at most three per rank.
+template<typename F>
+void forEachMultiset(uint32_t rank, uint32_t cards, uint32_t digits, F f) {
+    if (rank == RANKS) {
+        if (cards == 0) {
+            f(digits);
+        }
+        return;
+    }
+    for (uint32_t count = 0; count <= std::min(3u, cards); ++count) {
+        forEachMultiset(rank + 1, cards - count, digits | count << (2 * rank),
+                f);
+    }
+}
+
+}
+
+RankTables::RankTables(uint64_t (*rank)(__m128i cv)) :
+        data(loadTable("rank_tables", VERSION, sizeof(Layout),
+                [rank](void* payload) {
+                    fill(*static_cast<Layout*>(payload), rank);
+                })) {
+    for (std::atomic<const Layout*>& tables : node_tables) {
+        tables.store(data.as<Layout>(), std::memory_order_relaxed);
+    }
+}
+
+void RankTables::replicate() {
+    if (!replicas.empty()) {
+        return;
+    }
+    for (uint32_t node = 0; node < getNumaNodeCount(); ++node) {
+        if (getNumaNodeCpus(node).empty()) {
+            continue;
+        }
+        replicas.push_back(TableData::generate(sizeof(Layout),
+                [this](void* payload) {
+                    memcpy(payload, data.data(), sizeof(Layout));
+                }, node));
+        node_tables[node].store(replicas.back().as<Layout>(),
+                std::memory_order_release);
+    }
+}
+
+void RankTables::fill(Layout& tables, uint64_t (*rank)(__m128i cv)) {
+    MultisetCounts multisets;
+    for (uint32_t digits = 0; digits < (1 << 12); ++digits) {
+        int32_t index = multisets.part(0, 6, CARDS, digits);
+        tables.low_ranks[digits] = std::max(index, 0);
+    }
+    for (uint32_t digits = 0; digits < (1 << 14); ++digits) {
+        uint32_t cards = 0;
+        for (uint32_t r = 0; r < 7; ++r) {
+            cards += (digits >> (2 * r)) & 3;
+        }
+        int32_t index =
+                cards > CARDS ? -1 : multisets.part(6, 7, cards, digits);
+        tables.high_ranks[digits] = std::max(index, 0);
+    }
+
+    // Values of all entries first, the classes are assigned once all values
+    // are known.
+    std::vector<uint64_t> flush_values(8192, 0);
+    std::vector<uint64_t> quad_values(RANKS * RANKS, 0);
+    std::vector<uint64_t> other_values(multisets(RANKS, CARDS), 0);
+
+    for (uint32_t word = 0; word < 8192; ++word) {
+        uint32_t bits = __builtin_popcount(word);
+        if (bits < 5 || bits > CARDS) {
+            continue;
+        }
+        // Flush cards in clubs, topped up with non-clubs of the same ranks.
+        // Neither a full house nor quads fit next to five flush cards.
+        __m128i cv = _mm_setzero_si128();
+        uint32_t fillers = CARDS - bits;
+        for (uint32_t r = 0; r < RANKS; ++r) {
+            if (word & (1 << r)) {
+                cv = _mm_add_epi64(cv, cardVec(r, 0));
+                if (fillers > 0) {
+                    cv = _mm_add_epi64(cv, cardVec(r, fillers--));
+                }
+            }
+        }
+        flush_values[word] = rank(cv);
+    }
+
+    for (uint32_t quad = 0; quad < RANKS; ++quad) {
+        for (uint32_t kicker = 0; kicker < RANKS; ++kicker) {
+            if (quad == kicker) {
+                continue;
+            }
+            // Trips of the kicker rank do not matter next to the quads.
+            __m128i cv = _mm_setzero_si128();
+            for (uint32_t c = 0; c < 4; ++c) {
+                cv = _mm_add_epi64(cv, cardVec(quad, c));
+            }
+            for (uint32_t c = 0; c < 3; ++c) {
+                cv = _mm_add_epi64(cv, cardVec(kicker, c));
+            }
+            quad_values[quad * RANKS + kicker] = rank(cv);
+        }
+    }
+
+    // All rank multisets without quads. The colors are dealt round robin, so
+    // no color gets more than two cards.
+    forEachMultiset(0, CARDS, 0, [&](uint32_t digits) {
+        __m128i cv = _mm_setzero_si128();
+        uint32_t color = 0;
+        for (uint32_t r = 0; r < RANKS; ++r) {
+            for (uint32_t c = 0; c < ((digits >> (2 * r)) & 3); ++c) {
+                cv = _mm_add_epi64(cv, cardVec(r, color++ % 4));
+            }
+        }
+        other_values[tables.low_ranks[digits & 0xfff]
+                + tables.high_ranks[digits >> 12]] = rank(cv);
+    });
+
+    std::vector<uint64_t> values;
+    values.insert(values.end(), flush_values.begin(), flush_values.end());
+    values.insert(values.end(), quad_values.begin(), quad_values.end());
+    values.insert(values.end(), other_values.begin(), other_values.end());
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    // Zero marks unused entries, no hand ranks that low.
+    if (!values.empty() && values.front() == 0) {
+        values.erase(values.begin());
+    }
+
+    if (values.size() > MAX_CLASSES) {
+        throw new std::runtime_error("Too many hand classes");
+    }
+    std::copy(values.begin(), values.end(), tables.values);
+    tables.class_count = values.size();
+
+    auto classOf = [&values](uint64_t value) {
+        return static_cast<uint16_t>(std::lower_bound(values.begin(),
+                values.end(), value) - values.begin());
+    };
+    for (uint32_t i = 0; i < 8192; ++i) {
+        tables.flushes[i] = classOf(flush_values[i]);
+    }
+    for (uint32_t i = 0; i < RANKS * RANKS; ++i) {
+        tables.quads[i] = classOf(quad_values[i]);
+    }
+    for (size_t i = 0; i < other_values.size(); ++i) {
+        tables.others[i] = classOf(other_values[i]);
+    }
+}
+
+} // namespace detail
+} // namespace poker
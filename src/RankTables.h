@@ -0,0 +1,153 @@
+#ifndef RANKTABLES_H_
+#define RANKTABLES_H_
+
+#include "Numa.h"
+#include "TableFile.h"
+
+#include <atomic>
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <emmintrin.h>
+
+namespace poker {
+namespace detail {
+
+// Table driven ranking of seven cards, the alternative to the computing
+// kernels in RankKernels.h. Hands map to a 16-bit equivalence class, the
+// classes are numbered in ascending order of their HandRanking value:
+//
+// - Flushes by the 13-bit word of the flush color (8192 entries).
+// - Four of a kind by the rank of the quads and of the kicker (13 * 13).
+// - Everything else by its rank multiset. Without quads every rank count
+//   fits into the 2-bit fields of the card counts, which are read in two
+//   halves. Each half table adds its part of the lexicographic index of the
+//   multiset among all 49205 seven card multisets, so the sum is a minimal
+//   perfect hash.
+//
+// The tables are filled by evaluating one hand per entry with the given
+// computing kernel, so both backends agree by construction. They are loaded
+// through loadTable(), so processes can share them from a table file. On
+// hosts with several NUMA nodes they can be replicated, each thread then
+// reads the copy of the node it was pinned to.
+class RankTables {
+public:
+    // Bump when the layout or the HandRanking encoding changes.
+    constexpr static uint32_t VERSION = 1;
+
+    // Distinct five card hand values, an upper bound of the classes.
+    constexpr static uint32_t MAX_CLASSES = 7462;
+
+    explicit RankTables(uint64_t (*rank)(__m128i cv));
+
+    uint16_t getClass(__m128i cv) const {
+        return getClass(*local(), cv);
+    }
+
+    uint64_t getValue(uint16_t hand_class) const {
+        return local()->values[hand_class];
+    }
+
+    uint64_t rankTexasHoldem(__m128i cv) const {
+        const Layout* tables = local();
+        return tables->values[getClass(*tables, cv)];
+    }
+
+    // Looks up the local tables once for all hands.
+    void getClasses(const __m128i* in, uint16_t* out, size_t n) const {
+        const Layout* tables = local();
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = getClass(*tables, in[i]);
+        }
+    }
+
+    void rankTexasHoldem(const __m128i* in, uint64_t* out, size_t n) const {
+        const Layout* tables = local();
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = tables->values[getClass(*tables, in[i])];
+        }
+    }
+
+    // Number of distinct classes seven card hands fall into.
+    size_t getClassCount() const {
+        return local()->class_count;
+    }
+
+    bool isMapped() const {
+        return data.isMapped();
+    }
+
+    // Copies the tables into the memory of every NUMA node with CPUs. The
+    // copies are used from then on and kept for the lifetime of the tables.
+    // Not to be called concurrently with itself.
+    void replicate();
+
+    // Nodes with a copy of their own.
+    size_t getReplicaCount() const {
+        return replicas.size();
+    }
+
+private:
+    // Payload of the table file.
+    struct Layout {
+        uint64_t values[MAX_CLASSES];
+        uint32_t class_count;
+        // Parts of the lexicographic index contributed by the deuces to
+        // sevens and by the eights to aces. The cards left for the high
+        // ranks are their own count, so the two lookups are independent.
+        uint16_t low_ranks[1 << 12];
+        uint16_t high_ranks[1 << 14];
+        uint16_t flushes[8192];
+        uint16_t quads[13 * 13];
+        uint16_t others[49205];
+    };
+
+    static void fill(Layout& tables, uint64_t (*rank)(__m128i cv));
+
+    static uint16_t getClass(const Layout& tables, __m128i cv) {
+        uint64_t low = _mm_cvtsi128_si64x(cv);
+        uint64_t words = _mm_cvtsi128_si64x(_mm_unpackhi_epi64(cv, cv));
+
+        // Bytes of the color counts get their top bit set from five on.
+        uint32_t flush = ((low >> 32) + 0x7b7b7b7b) & 0x80808080;
+        if (flush) {
+            uint32_t shift = __builtin_ctz(flush) * 2 - 13;
+            return tables.flushes[(words >> shift) & 0x1fff];
+        }
+
+        uint64_t quads = words & (words >> 16) & (words >> 32) & (words >> 48)
+                & 0xffff;
+        if (__builtin_expect(quads != 0, 0)) {
+            uint32_t colorless = (words | (words >> 16) | (words >> 32)
+                    | (words >> 48)) & 0xffff;
+            uint32_t quad_rank = __builtin_ctz(quads) - 1;
+            uint32_t kicker = 31 - __builtin_clz(colorless & ~quads) - 1;
+            return tables.quads[quad_rank * 13 + kicker];
+        }
+
+        return tables.others[multisetIndex(tables, (low & 0xffffffff) >> 2)];
+    }
+
+    // Index of the rank multiset given by 2-bit counts, starting with deuces.
+    static uint32_t multisetIndex(const Layout& tables, uint32_t counts) {
+        return tables.low_ranks[counts & 0xfff]
+                + tables.high_ranks[counts >> 12];
+    }
+
+    // The tables for the node of the calling thread.
+    const Layout* local() const {
+        return node_tables[getThreadNumaNode()].load(
+                std::memory_order_acquire);
+    }
+
+    TableData data;
+    std::vector<TableData> replicas;
+    std::atomic<const Layout*> node_tables[MAX_NUMA_NODES];
+};
+
+} // namespace detail
+} // namespace poker
+
+#endif /* RANKTABLES_H_ */
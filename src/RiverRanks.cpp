@@ -0,0 +1,212 @@
+#include "RiverRanks.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace poker {
+
+namespace {
+
+// Weights and numbers of combinations of a range, in total and of those
+// holding each card.
+struct Mass {
+    void add(double weight, uint8_t first, uint8_t second) {
+        total += weight;
+        cards[first] += weight;
+        cards[second] += weight;
+        count++;
+        counts[first]++;
+        counts[second]++;
+    }
+
+    // Of the combinations sharing no card with first and second, duplicate
+    // being the mass of the combination of both, which is subtracted twice.
+    double without(uint8_t first, uint8_t second, double duplicate) const {
+        return total - cards[first] - cards[second] + duplicate;
+    }
+
+    // Resets the totals and the entries of the two cards. Done for every
+    // combination added, it empties the mass without a pass over all cards.
+    void clear(uint8_t first, uint8_t second) {
+        total = 0;
+        cards[first] = cards[second] = 0;
+        count = 0;
+        counts[first] = counts[second] = 0;
+    }
+
+    uint64_t countWithout(uint8_t first, uint8_t second,
+            uint64_t duplicate) const {
+        return count - counts[first] - counts[second] + duplicate;
+    }
+
+    double total = 0;
+    double cards[Range::CARD_VALUES] = { };
+    uint64_t count = 0;
+    uint64_t counts[Range::CARD_VALUES] = { };
+};
+
+}
+
+constexpr uint32_t RiverRanks::COMBOS;
+
+RiverRanks::RiverRanks(const CardSet& board) :
+        board(board) {
+    if (board.size() != 5) {
+        throw new std::runtime_error(
+                "Invalid board size: " + std::to_string(board.size()));
+    }
+    // The board plus each combination, by a vector add of the card sets.
+    CardSet hands[COMBOS];
+    uint16_t unsorted[COMBOS];
+    uint64_t board_bits = board.cardBits();
+    size_t count = 0;
+    for (size_t c = 0; c < Range::COMBOS; ++c) {
+        const CardSet& combo = Range::comboCards(c);
+        if (combo.cardBits() & board_bits) {
+            continue;
+        }
+        hands[count] = board;
+        hands[count].addAll(combo);
+        unsorted[count++] = c;
+    }
+    HandRanking ranked[COMBOS];
+    CardSet::rankTexasHoldemBatch(hands, ranked, COMBOS);
+    HandRankIndex indexes[COMBOS];
+    HandRankIndex::fromHandRankings(ranked, indexes, COMBOS);
+
+    // Two stable counting passes over the low and high byte of the index.
+    uint16_t low_combos[COMBOS];
+    HandRankIndex low_rankings[COMBOS];
+    uint32_t offsets[257];
+    for (int pass = 0; pass < 2; ++pass) {
+        const uint16_t* from_combos = pass == 0 ? unsorted : low_combos;
+        const HandRankIndex* from = pass == 0 ? indexes : low_rankings;
+        uint16_t* to_combos = pass == 0 ? low_combos : combos;
+        HandRankIndex* to = pass == 0 ? low_rankings : rankings;
+        uint32_t shift = 8 * pass;
+        std::fill(offsets, offsets + 257, 0);
+        for (size_t i = 0; i < COMBOS; ++i) {
+            offsets[((from[i].getIndex() >> shift) & 0xff) + 1]++;
+        }
+        for (int b = 0; b < 256; ++b) {
+            offsets[b + 1] += offsets[b];
+        }
+        for (size_t i = 0; i < COMBOS; ++i) {
+            uint32_t slot = offsets[(from[i].getIndex() >> shift) & 0xff]++;
+            to_combos[slot] = from_combos[i];
+            to[slot] = from[i];
+        }
+    }
+
+    for (size_t i = 0; i < COMBOS; ++i) {
+        if (i == 0 || rankings[i] != rankings[i - 1]) {
+            groups.push_back(i);
+        }
+    }
+    groups.push_back(COMBOS);
+}
+
+EquityResult RiverRanks::equity(const Range& first,
+        const Range& second) const {
+    const Range::ComboCardValues& cards = Range::comboCardValues();
+    // Of the second range: all combinations, those of lower groups and
+    // those of the current one.
+    Mass all;
+    Mass below;
+    Mass group;
+    for (size_t i = 0; i < COMBOS; ++i) {
+        uint16_t c = combos[i];
+        if (second.getWeight(c) > 0) {
+            all.add(second.getWeight(c), cards.first[c], cards.second[c]);
+        }
+    }
+
+    double win = 0;
+    double tie = 0;
+    double total = 0;
+    uint64_t trials = 0;
+    for (size_t g = 0; g + 1 < groups.size(); ++g) {
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            uint16_t c = combos[i];
+            if (second.getWeight(c) > 0) {
+                group.add(second.getWeight(c), cards.first[c],
+                        cards.second[c]);
+            }
+        }
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            uint16_t c = combos[i];
+            double weight = first.getWeight(c);
+            if (weight == 0) {
+                continue;
+            }
+            uint8_t a = cards.first[c];
+            uint8_t b = cards.second[c];
+            double same = second.getWeight(c);
+            win += weight * below.without(a, b, 0);
+            tie += weight * group.without(a, b, same);
+            total += weight * all.without(a, b, same);
+            trials += all.countWithout(a, b, same > 0);
+        }
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            uint16_t c = combos[i];
+            if (second.getWeight(c) > 0) {
+                below.add(second.getWeight(c), cards.first[c],
+                        cards.second[c]);
+                group.clear(cards.first[c], cards.second[c]);
+            }
+        }
+    }
+    if (trials == 0) {
+        throw new std::runtime_error("No matchups of the ranges");
+    }
+
+    EquityResult result;
+    result.trials = trials;
+    result.players.resize(2);
+    result.players[0].win = win / total;
+    result.players[1].win = (total - win - tie) / total;
+    result.players[0].tie = result.players[1].tie = tie / total;
+    for (PlayerEquity& player : result.players) {
+        player.equity = player.win + player.tie / 2;
+    }
+    return result;
+}
+
+void RiverRanks::compare(const double* weights, double* beaten,
+        double* tied, double* dealt) const {
+    const Range::ComboCardValues& cards = Range::comboCardValues();
+    Mass all;
+    Mass below;
+    Mass group;
+    for (size_t i = 0; i < COMBOS; ++i) {
+        uint16_t c = combos[i];
+        if (weights[c] != 0) {
+            all.add(weights[c], cards.first[c], cards.second[c]);
+        }
+    }
+    for (size_t g = 0; g + 1 < groups.size(); ++g) {
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            uint16_t c = combos[i];
+            if (weights[c] != 0) {
+                group.add(weights[c], cards.first[c], cards.second[c]);
+            }
+        }
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            uint16_t c = combos[i];
+            uint8_t a = cards.first[c];
+            uint8_t b = cards.second[c];
+            beaten[c] = below.without(a, b, 0);
+            tied[c] = group.without(a, b, weights[c]);
+            dealt[c] = all.without(a, b, weights[c]);
+        }
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            uint16_t c = combos[i];
+            if (weights[c] != 0) {
+                below.add(weights[c], cards.first[c], cards.second[c]);
+                group.clear(cards.first[c], cards.second[c]);
+            }
+        }
+    }
+}
+
+} /* namespace poker */
@@ -0,0 +1,74 @@
+#ifndef RIVERRANKS_H_
+#define RIVERRANKS_H_
+
+#include "EquityCalculator.h"
+#include "HandRankIndex.h"
+#include "Range.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// The rankings of all hole card combinations on a complete board, sorted.
+//
+// The board is added to every combination not sharing a card with it, the
+// hands are ranked in SIMD batches and radix sorted by their HandRankIndex.
+// Combinations of equal ranking form a tie group. With the combinations in
+// order, the showdown of two ranges is a single sweep over the groups
+// instead of comparing every pair of combinations.
+class RiverRanks {
+public:
+    // Combinations not sharing a card with the board, C(47, 2).
+    constexpr static uint32_t COMBOS = 1081;
+
+    // Ranks all combinations on the board. Throws unless it has five cards.
+    explicit RiverRanks(const CardSet& board);
+
+    const CardSet& getBoard() const {
+        return board;
+    }
+
+    // Range::comboIndex() of the combination at position i, by ascending
+    // ranking.
+    uint16_t getCombo(size_t i) const {
+        return combos[i];
+    }
+
+    HandRankIndex getRanking(size_t i) const {
+        return rankings[i];
+    }
+
+    // Positions the tie groups start at, ascending, and COMBOS after the
+    // last one.
+    const std::vector<uint16_t>& getGroups() const {
+        return groups;
+    }
+
+    // Exact equity of the ranges against each other at showdown, weighting
+    // every matchup of combinations not sharing cards by the product of
+    // their weights, like RangeEquityCalculator::enumerate(). Card removal
+    // is accounted for by per-card sums of the second range, so the sweep
+    // is linear in the combinations. Throws if there is no such matchup.
+    EquityResult equity(const Range& first, const Range& second) const;
+
+    // For every combination, the weight of the combinations it beats and
+    // ties among those of the other range not sharing a card with it, and
+    // their total weight. All arrays are indexed by Range::comboIndex(),
+    // entries of combinations blocked by the board are left alone. Also one
+    // sweep, e.g. for the showdowns of a solver.
+    void compare(const double* weights, double* beaten, double* tied,
+            double* dealt) const;
+
+private:
+    CardSet board;
+    uint16_t combos[COMBOS];
+    HandRankIndex rankings[COMBOS];
+    std::vector<uint16_t> groups;
+};
+
+} /* namespace poker */
+
+#endif /* RIVERRANKS_H_ */
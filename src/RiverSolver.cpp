@@ -0,0 +1,367 @@
+#include "RiverSolver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace poker {
+
+namespace {
+
+// Bet sizes closer than this are the same.
+constexpr double SIZE_EPSILON = 1e-9;
+
+// Discounted CFR parameters, see RiverSolver::Algorithm.
+constexpr double DCFR_ALPHA = 1.5;
+constexpr double DCFR_BETA = 0;
+constexpr double DCFR_GAMMA = 2;
+
+}
+
+constexpr uint32_t RiverSolver::ROOT;
+constexpr size_t RiverSolver::HANDS;
+
+RiverSolver::RiverSolver(const CardSet& board, const Range& first,
+        const Range& second, const Config& config) :
+        ranks(board), config(config), matchups(0), cards(
+                Range::comboCardValues()) {
+    if (!(config.pot > 0) || !(config.stack > 0)) {
+        throw new std::runtime_error("Pot and stack must be positive");
+    }
+    const Range* ranges[2] = { &first, &second };
+    for (uint32_t p = 0; p < 2; ++p) {
+        weights[p].assign(HANDS, 0);
+        for (size_t c : ranges[p]->liveCombos(board)) {
+            weights[p][c] = ranges[p]->getWeight(c);
+        }
+    }
+    double totals[Range::CARD_VALUES] = { };
+    double total = 0;
+    for (size_t c = 0; c < HANDS; ++c) {
+        totals[cards.first[c]] += weights[1][c];
+        totals[cards.second[c]] += weights[1][c];
+        total += weights[1][c];
+    }
+    for (size_t c = 0; c < HANDS; ++c) {
+        matchups += weights[0][c] * (total - totals[cards.first[c]]
+                - totals[cards.second[c]] + weights[1][c]);
+    }
+    if (!(matchups > 0)) {
+        throw new std::runtime_error("No matchups of the ranges");
+    }
+
+    double bets[2] = { 0, 0 };
+    build(0, bets, 0, false);
+    size_t size = 0;
+    for (Node& node : nodes) {
+        node.offset = size;
+        size += node.actions.size() * HANDS;
+    }
+    regrets.assign(size, 0);
+    strategy_sums.assign(size, 0);
+}
+
+uint32_t RiverSolver::build(uint32_t player, const double* bets,
+        uint32_t raises, bool checked) {
+    uint32_t index = nodes.size();
+    nodes.emplace_back();
+    nodes[index].player = player;
+    nodes[index].fold = false;
+    std::copy(bets, bets + 2, nodes[index].bets);
+
+    uint32_t other = 1 - player;
+    double pot = config.pot + bets[0] + bets[1];
+    std::vector<Action> actions;
+    std::vector<uint32_t> children;
+    double next[2] = { bets[0], bets[1] };
+    if (bets[other] == bets[player]) {
+        actions.push_back(Action { Action::CHECK, bets[player] });
+        children.push_back(checked ? terminal(player, bets, false) :
+                build(other, bets, 0, true));
+    } else {
+        actions.push_back(Action { Action::FOLD, bets[player] });
+        children.push_back(terminal(player, bets, true));
+        next[player] = bets[other];
+        actions.push_back(Action { Action::CALL, bets[other] });
+        children.push_back(terminal(player, next, false));
+    }
+
+    // Bets, or raises if there is a bet to call, by the amount the player
+    // has in the pot afterwards.
+    bool raise = bets[other] > bets[player];
+    std::vector<double> amounts;
+    if (!raise || raises < config.max_raises) {
+        const std::vector<double>& sizes = raise ?
+                config.raise_sizes : config.bet_sizes;
+        double base = raise ? pot + bets[other] - bets[player] : pot;
+        for (double size : sizes) {
+            amounts.push_back(
+                    std::min(bets[other] + size * base, config.stack));
+        }
+        if (config.all_in) {
+            amounts.push_back(config.stack);
+        }
+    }
+    std::sort(amounts.begin(), amounts.end());
+    double previous = bets[other];
+    for (double amount : amounts) {
+        if (amount <= previous + SIZE_EPSILON) {
+            continue;
+        }
+        previous = amount;
+        next[player] = amount;
+        actions.push_back(Action { raise ? Action::RAISE : Action::BET,
+                amount });
+        children.push_back(build(other, next, raise ? raises + 1 : 0, false));
+    }
+
+    nodes[index].actions = actions;
+    nodes[index].children = children;
+    return index;
+}
+
+uint32_t RiverSolver::terminal(uint32_t player, const double* bets,
+        bool fold) {
+    uint32_t index = nodes.size();
+    nodes.emplace_back();
+    nodes[index].player = player;
+    nodes[index].fold = fold;
+    std::copy(bets, bets + 2, nodes[index].bets);
+    return index;
+}
+
+void RiverSolver::solve(uint32_t count) {
+    ScratchArena::Scope scope(arena);
+    double* values = arena.allocate<double>(HANDS);
+    for (uint32_t i = 0; i < count; ++i) {
+        iterations++;
+        for (uint32_t p = 0; p < 2; ++p) {
+            traverse(ROOT, p, weights[p].data(), weights[1 - p].data(),
+                    values);
+        }
+    }
+}
+
+void RiverSolver::traverse(uint32_t index, uint32_t traverser,
+        const double* reach, const double* other_reach, double* values) {
+    const Node& node = nodes[index];
+    ScratchArena::Scope scope(arena);
+    if (node.actions.empty()) {
+        terminalValues(node, traverser, other_reach, values, arena);
+        return;
+    }
+    size_t actions = node.actions.size();
+    double* strategy = arena.allocate<double>(actions * HANDS);
+    currentStrategy(node, strategy);
+    double* child_reach = arena.allocate<double>(HANDS);
+
+    if (node.player != traverser) {
+        double* child_values = arena.allocate<double>(HANDS);
+        std::fill(values, values + HANDS, 0);
+        for (size_t a = 0; a < actions; ++a) {
+            const double* s = strategy + a * HANDS;
+            for (size_t h = 0; h < HANDS; ++h) {
+                child_reach[h] = other_reach[h] * s[h];
+            }
+            traverse(node.children[a], traverser, reach, child_reach,
+                    child_values);
+            for (size_t h = 0; h < HANDS; ++h) {
+                values[h] += child_values[h];
+            }
+        }
+        return;
+    }
+
+    double* action_values = arena.allocate<double>(actions * HANDS);
+    for (size_t a = 0; a < actions; ++a) {
+        const double* s = strategy + a * HANDS;
+        for (size_t h = 0; h < HANDS; ++h) {
+            child_reach[h] = reach[h] * s[h];
+        }
+        traverse(node.children[a], traverser, child_reach, other_reach,
+                action_values + a * HANDS);
+    }
+    std::fill(values, values + HANDS, 0);
+    for (size_t a = 0; a < actions; ++a) {
+        const double* s = strategy + a * HANDS;
+        const double* v = action_values + a * HANDS;
+        for (size_t h = 0; h < HANDS; ++h) {
+            values[h] += s[h] * v[h];
+        }
+    }
+
+    double t = iterations;
+    double positive_discount = 1;
+    double negative_discount = 1;
+    double average_weight = t;
+    if (algorithm == Algorithm::DISCOUNTED) {
+        // Discounts the regrets up to the previous iteration.
+        double a = std::pow(t - 1, DCFR_ALPHA);
+        double b = std::pow(t - 1, DCFR_BETA);
+        positive_discount = a / (a + 1);
+        negative_discount = b / (b + 1);
+        average_weight = std::pow(t, DCFR_GAMMA);
+    }
+    for (size_t a = 0; a < actions; ++a) {
+        double* r = regrets.data() + node.offset + a * HANDS;
+        double* sums = strategy_sums.data() + node.offset + a * HANDS;
+        const double* s = strategy + a * HANDS;
+        const double* v = action_values + a * HANDS;
+        for (size_t h = 0; h < HANDS; ++h) {
+            if (algorithm == Algorithm::CFR_PLUS) {
+                r[h] = std::max(r[h] + v[h] - values[h], 0.0);
+            } else {
+                r[h] *= r[h] > 0 ? positive_discount : negative_discount;
+                r[h] += v[h] - values[h];
+            }
+            sums[h] += average_weight * reach[h] * s[h];
+        }
+    }
+}
+
+void RiverSolver::evaluate(uint32_t index, uint32_t player,
+        const double* other_reach, double* values, bool best_response,
+        ScratchArena& scratch) const {
+    const Node& node = nodes[index];
+    ScratchArena::Scope scope(scratch);
+    if (node.actions.empty()) {
+        terminalValues(node, player, other_reach, values, scratch);
+        return;
+    }
+    size_t actions = node.actions.size();
+    double* strategy = scratch.allocate<double>(actions * HANDS);
+    averageStrategy(node, strategy);
+    double* child_reach = scratch.allocate<double>(HANDS);
+    double* child_values = scratch.allocate<double>(HANDS);
+    for (size_t a = 0; a < actions; ++a) {
+        const double* s = strategy + a * HANDS;
+        if (node.player == player) {
+            evaluate(node.children[a], player, other_reach, child_values,
+                    best_response, scratch);
+        } else {
+            for (size_t h = 0; h < HANDS; ++h) {
+                child_reach[h] = other_reach[h] * s[h];
+            }
+            evaluate(node.children[a], player, child_reach, child_values,
+                    best_response, scratch);
+        }
+        for (size_t h = 0; h < HANDS; ++h) {
+            double v = child_values[h];
+            if (node.player != player) {
+                values[h] = a == 0 ? v : values[h] + v;
+            } else if (best_response) {
+                values[h] = a == 0 ? v : std::max(values[h], v);
+            } else {
+                values[h] = a == 0 ? s[h] * v : values[h] + s[h] * v;
+            }
+        }
+    }
+}
+
+void RiverSolver::terminalValues(const Node& node, uint32_t player,
+        const double* other_reach, double* values,
+        ScratchArena& scratch) const {
+    uint32_t other = 1 - player;
+    if (node.fold) {
+        // Reach of the other player's hands not sharing a card.
+        double totals[Range::CARD_VALUES] = { };
+        double total = 0;
+        for (size_t h = 0; h < HANDS; ++h) {
+            totals[cards.first[h]] += other_reach[h];
+            totals[cards.second[h]] += other_reach[h];
+            total += other_reach[h];
+        }
+        double payoff = node.player == other ?
+                config.pot + node.bets[other] : -node.bets[player];
+        for (size_t h = 0; h < HANDS; ++h) {
+            values[h] = payoff * (total - totals[cards.first[h]]
+                    - totals[cards.second[h]] + other_reach[h]);
+        }
+        return;
+    }
+
+    double* beaten = scratch.allocate<double>(HANDS);
+    double* tied = scratch.allocate<double>(HANDS);
+    double* dealt = scratch.allocate<double>(HANDS);
+    ranks.compare(other_reach, beaten, tied, dealt);
+    double bet = node.bets[player];
+    double win = config.pot + bet;
+    double tie = config.pot / 2;
+    for (size_t h = 0; h < HANDS; ++h) {
+        values[h] = beaten[h] * win + tied[h] * tie
+                - (dealt[h] - beaten[h] - tied[h]) * bet;
+    }
+}
+
+void RiverSolver::currentStrategy(const Node& node, double* strategy) const {
+    size_t actions = node.actions.size();
+    const double* r = regrets.data() + node.offset;
+    for (size_t h = 0; h < HANDS; ++h) {
+        double sum = 0;
+        for (size_t a = 0; a < actions; ++a) {
+            sum += std::max(r[a * HANDS + h], 0.0);
+        }
+        for (size_t a = 0; a < actions; ++a) {
+            strategy[a * HANDS + h] = sum > 0 ?
+                    std::max(r[a * HANDS + h], 0.0) / sum : 1.0 / actions;
+        }
+    }
+}
+
+void RiverSolver::averageStrategy(const Node& node, double* strategy) const {
+    size_t actions = node.actions.size();
+    const double* sums = strategy_sums.data() + node.offset;
+    for (size_t h = 0; h < HANDS; ++h) {
+        double sum = 0;
+        for (size_t a = 0; a < actions; ++a) {
+            sum += sums[a * HANDS + h];
+        }
+        for (size_t a = 0; a < actions; ++a) {
+            strategy[a * HANDS + h] = sum > 0 ?
+                    sums[a * HANDS + h] / sum : 1.0 / actions;
+        }
+    }
+}
+
+double RiverSolver::rangeValue(uint32_t player, bool best_response) const {
+    ScratchArena local;
+    double* values = local.allocate<double>(HANDS);
+    evaluate(ROOT, player, weights[1 - player].data(), values, best_response,
+            local);
+    double value = 0;
+    for (size_t h = 0; h < HANDS; ++h) {
+        value += weights[player][h] * values[h];
+    }
+    return value / matchups;
+}
+
+double RiverSolver::getExploitability() const {
+    // The values of both players sum to the pot.
+    return (rangeValue(0, true) + rangeValue(1, true) - config.pot) / 2;
+}
+
+double RiverSolver::getValue(uint32_t player) const {
+    return rangeValue(player, false);
+}
+
+std::vector<double> RiverSolver::getStrategy(uint32_t index,
+        const HoleCards& hand) const {
+    const Node& node = nodes[index];
+    if (node.actions.empty()) {
+        throw new std::runtime_error("No decision at a terminal node");
+    }
+    size_t h = Range::comboIndex(hand.getFirst(), hand.getSecond());
+    const double* sums = strategy_sums.data() + node.offset;
+    size_t actions = node.actions.size();
+    double sum = 0;
+    for (size_t a = 0; a < actions; ++a) {
+        sum += sums[a * HANDS + h];
+    }
+    std::vector<double> result;
+    for (size_t a = 0; a < actions; ++a) {
+        result.push_back(sum > 0 ? sums[a * HANDS + h] / sum : 1.0 / actions);
+    }
+    return result;
+}
+
+} /* namespace poker */
@@ -0,0 +1,171 @@
+#ifndef RIVERSOLVER_H_
+#define RIVERSOLVER_H_
+
+#include "Range.h"
+#include "RiverRanks.h"
+#include "TaskScheduler.h"
+
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// Equilibrium strategies of a heads-up river subgame by counterfactual
+// regret minimization.
+//
+// The game tree follows the bet sizes of the configuration: the first
+// player (out of position) acts first, a check behind or a call ends the
+// hand at showdown, a fold gives the pot to the other player. Regrets and
+// strategies of every decision are vectors over all Range::COMBOS hole card
+// combinations, so each iteration is a few passes over flat arrays per
+// node. Showdowns are evaluated by RiverRanks::compare(), a linear sweep
+// over the combinations sorted once for the board, and folds by per-card
+// sums of the opponent's reach, so card removal is exact.
+//
+// Values are in chips relative to the start of the river: the player
+// winning the pot gets the pot of the river plus the opponent's bets, and
+// every player loses their own bets.
+class RiverSolver {
+public:
+    struct Config {
+        // Pot at the start of the river.
+        double pot = 1;
+        // Chips either player can still bet.
+        double stack = 10;
+        // Bets as fractions of the pot.
+        std::vector<double> bet_sizes = { 0.5, 1 };
+        // Raises as fractions of the pot after calling.
+        std::vector<double> raise_sizes = { 1 };
+        // Raises allowed after a bet.
+        uint32_t max_raises = 1;
+        // Whether betting the whole stack is always an option.
+        bool all_in = true;
+    };
+
+    struct Action {
+        enum Type {
+            FOLD, CHECK, CALL, BET, RAISE,
+        };
+
+        Type type;
+        // Chips of the player in the pot after the action.
+        double amount;
+    };
+
+    enum class Algorithm {
+        // Regrets floored at zero, strategies averaged linearly.
+        CFR_PLUS,
+        // Discounted CFR with alpha 1.5, beta 0 and gamma 2.
+        DISCOUNTED,
+    };
+
+    constexpr static uint32_t ROOT = 0;
+    // Hands the solver plays, one per Range::comboIndex().
+    constexpr static size_t HANDS = Range::COMBOS;
+
+    // Builds the game tree. The ranges are the hands the players reach the
+    // river with, weighted. Throws unless the board has five cards, both
+    // ranges have hands not blocked by it and the pot and stack are
+    // positive.
+    RiverSolver(const CardSet& board, const Range& first, const Range& second,
+            const Config& config);
+
+    void setAlgorithm(Algorithm algorithm) {
+        this->algorithm = algorithm;
+    }
+
+    // Runs the iterations, each updating both players once.
+    void solve(uint32_t iterations);
+
+    uint32_t getIterations() const {
+        return iterations;
+    }
+
+    // Chips the average strategies lose against best responses, averaged
+    // over both players. Zero at an equilibrium.
+    double getExploitability() const;
+
+    // Value of the average strategies for the player, in chips per matchup
+    // of hands, weighted like the ranges.
+    double getValue(uint32_t player) const;
+
+    size_t getNodeCount() const {
+        return nodes.size();
+    }
+
+    bool isTerminal(uint32_t node) const {
+        return nodes[node].actions.empty();
+    }
+
+    // Player to act.
+    uint32_t getPlayer(uint32_t node) const {
+        return nodes[node].player;
+    }
+
+    const std::vector<Action>& getActions(uint32_t node) const {
+        return nodes[node].actions;
+    }
+
+    uint32_t getChild(uint32_t node, size_t action) const {
+        return nodes[node].children[action];
+    }
+
+    // Average strategy of the hand, a probability per action.
+    std::vector<double> getStrategy(uint32_t node, const HoleCards& hand)
+            const;
+
+private:
+    struct Node {
+        // Acting player, the one who folded for folds.
+        uint32_t player;
+        bool fold;
+        // Chips of each player in the pot.
+        double bets[2];
+        std::vector<Action> actions;
+        std::vector<uint32_t> children;
+        // Of the regrets and strategy sums, actions * HANDS.
+        size_t offset;
+    };
+
+    uint32_t build(uint32_t player, const double* bets, uint32_t raises,
+            bool checked);
+    uint32_t terminal(uint32_t player, const double* bets, bool fold);
+
+    // Counterfactual values of the traverser's hands at the node given the
+    // reach of both players, updating the traverser's regrets and strategy
+    // sums on the way.
+    void traverse(uint32_t node, uint32_t traverser, const double* reach,
+            const double* other_reach, double* values);
+    // Values against the average strategy of the other player, playing the
+    // average strategy too or, with best_response, the best action.
+    void evaluate(uint32_t node, uint32_t player, const double* other_reach,
+            double* values, bool best_response, ScratchArena& scratch) const;
+    void terminalValues(const Node& node, uint32_t player,
+            const double* other_reach, double* values,
+            ScratchArena& scratch) const;
+    void currentStrategy(const Node& node, double* strategy) const;
+    void averageStrategy(const Node& node, double* strategy) const;
+    // Value of the player's range, in chips per matchup.
+    double rangeValue(uint32_t player, bool best_response) const;
+
+    RiverRanks ranks;
+    Config config;
+    std::vector<double> weights[2];
+    // Weight of the matchups not sharing cards.
+    double matchups;
+    // Card::getValue() of both cards per hand.
+    const Range::ComboCardValues& cards;
+
+    std::vector<Node> nodes;
+    ScratchArena arena;
+    std::vector<double> regrets;
+    std::vector<double> strategy_sums;
+    Algorithm algorithm = Algorithm::CFR_PLUS;
+    uint32_t iterations = 0;
+};
+
+} /* namespace poker */
+
+#endif /* RIVERSOLVER_H_ */
@@ -0,0 +1,188 @@
+#include "SfmtJump.h"
+#include "SfmtJumpParams.h"
+#include "SFMT-params.h"
+#include "SFMT-common.h"
+
+#include <string.h>
+
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace poker {
+
+namespace {
+
+// Polynomials over GF(2), bit i is the coefficient of x^i.
+typedef std::vector<uint64_t> Bits;
+
+bool get(const Bits& b, size_t i) {
+    return b[i / 64] >> (i % 64) & 1;
+}
+
+void flip(Bits& b, size_t i) {
+    b[i / 64] ^= 1ull << (i % 64);
+}
+
+// a ^= b * x^shift, cut off at the size of a.
+void xorShifted(Bits& a, const Bits& b, size_t shift) {
+    size_t words = shift / 64;
+    uint32_t bits = shift % 64;
+    for (size_t i = 0; i < b.size() && i + words < a.size(); ++i) {
+        a[i + words] ^= b[i] << bits;
+        if (bits && i + words + 1 < a.size()) {
+            a[i + words + 1] ^= b[i] >> (64 - bits);
+        }
+    }
+}
+
+// Advances the state by one step, the recursion of sfmt_gen_rand_all() on a
+// single 128-bit word of the circular state array.
+void nextState(sfmt_t& sfmt) {
+    int idx = (sfmt.idx / 4) % SFMT_N;
+    w128_t* state = sfmt.state;
+    do_recursion(&state[idx], &state[idx], &state[(idx + SFMT_POS1) % SFMT_N],
+            &state[(idx + SFMT_N - 2) % SFMT_N],
+            &state[(idx + SFMT_N - 1) % SFMT_N]);
+    sfmt.idx = (sfmt.idx + 4) % SFMT_N32;
+}
+
+// dest ^= src, lining up the oldest words of both circular arrays.
+void addState(sfmt_t& dest, const sfmt_t& src) {
+    int diff = ((src.idx / 4) - (dest.idx / 4) + SFMT_N) % SFMT_N;
+    for (int i = 0; i < SFMT_N; ++i) {
+        for (int k = 0; k < 4; ++k) {
+            dest.state[i].u[k] ^= src.state[(i + diff) % SFMT_N].u[k];
+        }
+    }
+}
+
+size_t degreeOf(const Bits& b) {
+    for (size_t i = b.size(); i-- > 0;) {
+        if (b[i]) {
+            return i * 64 + 63 - __builtin_clzll(b[i]);
+        }
+    }
+    return 0;
+}
+
+// Bits 0..31 of a word spread to the even bits.
+uint64_t spread(uint64_t x) {
+    x = (x | x << 16) & 0x0000ffff0000ffffull;
+    x = (x | x << 8) & 0x00ff00ff00ff00ffull;
+    x = (x | x << 4) & 0x0f0f0f0f0f0f0f0full;
+    x = (x | x << 2) & 0x3333333333333333ull;
+    x = (x | x << 1) & 0x5555555555555555ull;
+    return x;
+}
+
+static_assert(SFMT_SUBSTREAM_LOG2 == 64,
+        "SFMT_SUBSTREAM_JUMP is a jump by 2^64 steps");
+
+class Jumps {
+public:
+    Jumps() :
+            p(std::begin(SFMT_CHARACTERISTIC), std::end(SFMT_CHARACTERISTIC)),
+            degree(degreeOf(p)), words(degree / 64 + 1) {
+        p.resize(words + 1);
+        substreams.reserve(64);
+        substreams.push_back(Bits(std::begin(SFMT_SUBSTREAM_JUMP),
+                std::end(SFMT_SUBSTREAM_JUMP)));
+        substreams.back().resize(words);
+    }
+
+    // x^n modulo the characteristic polynomial.
+    Bits power(uint64_t n) const {
+        Bits q(words, 0);
+        flip(q, 0);
+        for (int bit = 63; bit >= 0; --bit) {
+            q = square(q);
+            if (n >> bit & 1) {
+                Bits shifted(words + 1, 0);
+                xorShifted(shifted, q, 1);
+                q = reduce(shifted);
+            }
+        }
+        return q;
+    }
+
+    // x^(k 2^64) for k a power of two up to 2^63. The powers above the
+    // shipped one are squared on first use.
+    const Bits& substream(uint32_t log2_k) {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (substreams.size() <= log2_k) {
+            // Reserved, so references handed out earlier stay valid.
+            substreams.push_back(square(substreams.back()));
+        }
+        return substreams[log2_k];
+    }
+
+    // Replaces the state by q(T) of it, T being one step.
+    void apply(sfmt_t& sfmt, const Bits& q) const {
+        int index = sfmt.idx;
+        sfmt_t work;
+        memset(&work, 0, sizeof(work));
+        // The state array is ordered oldest first between generations,
+        // wherever idx points into it.
+        sfmt.idx = SFMT_N32;
+        size_t last = degreeOf(q);
+        for (size_t i = 0; i <= last; ++i) {
+            if (get(q, i)) {
+                addState(work, sfmt);
+            }
+            nextState(sfmt);
+        }
+        sfmt = work;
+        sfmt.idx = index;
+    }
+
+private:
+    // Squaring over GF(2) just spreads the bits apart.
+    Bits square(const Bits& q) const {
+        Bits result(2 * q.size(), 0);
+        for (size_t i = 0; i < q.size(); ++i) {
+            result[2 * i] = spread(q[i] & 0xffffffff);
+            result[2 * i + 1] = spread(q[i] >> 32);
+        }
+        return reduce(result);
+    }
+
+    Bits reduce(Bits q) const {
+        for (size_t i = q.size() * 64; i-- > degree;) {
+            if (get(q, i)) {
+                xorShifted(q, p, i - degree);
+            }
+        }
+        q.resize(words);
+        return q;
+    }
+
+    Bits p;
+    size_t degree;
+    size_t words;
+    std::mutex mutex;
+    std::vector<Bits> substreams;
+};
+
+Jumps& jumps() {
+    static Jumps instance;
+    return instance;
+}
+
+}
+
+void sfmtJump(sfmt_t& sfmt, uint64_t steps) {
+    Jumps& j = jumps();
+    j.apply(sfmt, j.power(steps));
+}
+
+void sfmtJumpSubstreams(sfmt_t& sfmt, uint64_t k) {
+    Jumps& j = jumps();
+    for (uint32_t bit = 0; bit < 64; ++bit) {
+        if (k >> bit & 1) {
+            j.apply(sfmt, j.substream(bit));
+        }
+    }
+}
+
+} /* namespace poker */
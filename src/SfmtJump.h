@@ -0,0 +1,34 @@
+#ifndef SFMTJUMP_H_
+#define SFMTJUMP_H_
+
+#include "SFMT.h"
+
+#include <stdint.h>
+
+namespace poker {
+
+// Jump-ahead for SFMT, in the manner of the upstream SFMT-jump: advancing the
+// generator by n steps multiplies its state by x^n modulo the characteristic
+// polynomial of the recursion. The characteristic polynomial and the jump by
+// one substream are precomputed for each supported SFMT_MEXP, see
+// SfmtJumpParams.h.
+//
+// A step generates 128 bits, four 32-bit random words. The generator must
+// have been initialized with sfmt_init_gen_rand() or sfmt_init_by_array().
+
+// Substreams are this many steps apart, far more than any run consumes.
+constexpr uint32_t SFMT_SUBSTREAM_LOG2 = 64;
+
+// Leaves the generator where it would be after generating the given number
+// of steps, in O(MEXP^2 log(steps)) bit operations.
+void sfmtJump(sfmt_t& sfmt, uint64_t steps);
+
+// Advances the generator by k substreams of 2^64 steps. The polynomials of
+// the powers of two are cached, so this takes one pass over the state per
+// set bit of k. Substreams 0, 1, 2, ... of one seed never overlap, which
+// gives parallel workers reproducible and independent random numbers.
+void sfmtJumpSubstreams(sfmt_t& sfmt, uint64_t k);
+
+} /* namespace poker */
+
+#endif /* SFMTJUMP_H_ */
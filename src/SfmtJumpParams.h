@@ -0,0 +1,262 @@
+#ifndef SFMTJUMPPARAMS_H_
+#define SFMTJUMPPARAMS_H_
+
+// Jump polynomials of SfmtJump.cpp for the SFMT_MEXP of the build, the
+// counterpart of upstream SFMT-jump's characteristic.<MEXP>.txt and of the
+// jump strings its calc-jump prints. Both are polynomials over GF(2), 64
+// coefficients per word with the lowest first:
+//
+//   SFMT_CHARACTERISTIC  characteristic polynomial of one step of the
+//                        recursion on the whole state, of degree 128 SFMT_N
+//   SFMT_SUBSTREAM_JUMP  x^(2^64) modulo it, one substream
+//
+// They were computed once with Berlekamp-Massey on the parities of the state
+// words, and a jump by any number of steps reduces modulo the first.
+
+#include "SFMT-params.h"
+
+#include <stdint.h>
+
+namespace poker {
+
+#if SFMT_MEXP == 607
+
+constexpr uint64_t SFMT_CHARACTERISTIC[] = {
+        0x7694aeb652080001ull, 0xac73f24e6c97cdbaull, 0x2fea8839f424b3fbull,
+        0x02c6de5b62400646ull, 0xc61956887e99c7d0ull, 0xdd9728818451796aull,
+        0x849fa116f22626a7ull, 0x82bf7581a75565ffull, 0xa28084502e9e6665ull,
+        0x0000000011835b37ull, 0x0000000000000001ull
+};
+
+constexpr uint64_t SFMT_SUBSTREAM_JUMP[] = {
+        0xf364923834f47451ull, 0x241a4e70e5ba7196ull, 0x1d5f6ee1908f9e57ull,
+        0xa2555e5afbe38048ull, 0x889b3b6b67ba0a78ull, 0x040405da4c3649a6ull,
+        0x460250e6e8f62b57ull, 0x0f0a8b6db7641d8full, 0xaa67daa3b57fb2a0ull,
+        0xa799c37f168b4703ull, 0x0000000000000000ull
+};
+
+#elif SFMT_MEXP == 19937
+
+constexpr uint64_t SFMT_CHARACTERISTIC[] = {
+        0x0000000000000001ull, 0x0000000000000000ull, 0x0000000000000000ull,
+        0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+        0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+        0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+        0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+        0x0000000000000000ull, 0x0000000000020000ull, 0x0000000000000000ull,
+        0x0000280000000000ull, 0x0000100000010000ull, 0x0000000000000000ull,
+        0x00000000000000a0ull, 0x0000000000000140ull, 0x0000000a00000000ull,
+        0x1100001400000000ull, 0x8200000000000000ull, 0x0000000000200000ull,
+        0x0000000000540001ull, 0x0000800008280000ull, 0x0011400000000000ull,
+        0x00a0800000000000ull, 0x0000400000000000ull, 0x0000000400000040ull,
+        0x00000088000a0800ull, 0x1000004400000500ull, 0x000080a000000200ull,
+        0x4400001400000020ull, 0x0000002004400010ull, 0x5008800108000808ull,
+        0x0010000105500001ull, 0x000200a0a2200002ull, 0x0441000011008200ull,
+        0x0802804020810400ull, 0x011100880008000aull, 0x000a040001054100ull,
+        0x2020000082a20805ull, 0x400040500015140aull, 0x8820000810002804ull,
+        0x0009415808808808ull, 0xa00102a400010500ull, 0xc2800000a0a0202aull,
+        0x000404440002d011ull, 0x0a8200020ad444a2ull, 0x0111040115028080ull,
+        0x028c170826050105ull, 0x1512280000828020ull, 0x4220144044141282ull,
+        0x8008200044880c20ull, 0x04d0501029419208ull, 0x2260a9a201342400ull,
+        0x42b011808200a0a0ull, 0x6043668044470047ull, 0x02800a0280028a42ull,
+        0x101448840d038108ull, 0x8a0249858605200full, 0x0614be1144282080ull,
+        0x982846067854480eull, 0x005aa00480a040d4ull, 0x24915400e1456171ull,
+        0x41a8002841a1a172ull, 0x8236063b70e58020ull, 0x045a0e4302c2c14eull,
+        0x1e1281a00c8a020eull, 0x363f214518ba8948ull, 0x0271812261458186ull,
+        0x1cc00e4401222930ull, 0x2854d800a7263278ull, 0x68b8aa40a02c9855ull,
+        0x0373450904111bdcull, 0x2600f3a0602350a0ull, 0x644f4c31b0bb80a5ull,
+        0xd20a1d4608ef2560ull, 0x8a0b4b9211312406ull, 0x82ae7517009f9982ull,
+        0x601756539a200074ull, 0x640a70122436867cull, 0x8020484dc862a715ull,
+        0xe2e2e81b48d8b424ull, 0x72b122c30548ac38ull, 0xd2a3870790381012ull,
+        0xcb56e0eece1c70b7ull, 0x3502990347470682ull, 0xa8601f8b5c7411e1ull,
+        0x3775a12a833a30b5ull, 0x052143a0016f9a44ull, 0xce3b6a1212780c22ull,
+        0xc05c5070c11b954eull, 0xa6b0b13223bc8d00ull, 0x26110291d7d998c0ull,
+        0x2097e7a161246d50ull, 0x8d4d25c4574d475cull, 0x152e14187c8b1e6bull,
+        0xda950b3fcb88e537ull, 0x835944751836d521ull, 0x2636a40253002240ull,
+        0xffef9c51964912a5ull, 0x7d4964adc523308cull, 0x69f98f32aa726ab9ull,
+        0x47130b37425091ddull, 0x401ab0ff24e21061ull, 0x9453c512e050cd4bull,
+        0x1ac684510d88fa5full, 0xa16ca218b2933017ull, 0x5424cd6cea03afbaull,
+        0x3df8a93b3b286b75ull, 0x32873ba3471bc681ull, 0x5b798315ecd48145ull,
+        0xb45a9468ba2e3b9eull, 0xd571d4457ecae4b2ull, 0xc9d63e3bd3bbfa43ull,
+        0x192bea7fa9441ce2ull, 0x79b6d1bcc6cfa705ull, 0xd63fc57efa82ca0bull,
+        0xc839574ca64d7f35ull, 0xecf5868d70ee9058ull, 0x29f4a75568cf95dbull,
+        0x67a6382493eac127ull, 0xd196437f9f4a71cbull, 0x1b3022c27d461c7full,
+        0xa6a567ce4085d0bcull, 0xae311af7b7278a1eull, 0xa48c600294a94bfcull,
+        0xd624ca7a2f95b256ull, 0x560241615d847f18ull, 0xc6371879a520d42cull,
+        0xd08d5f07d17e3abdull, 0x3df9d3be7ad73124ull, 0xc33686612cb4cbfaull,
+        0x2dbe79740e8090c0ull, 0x30a4a80f6d4c79ecull, 0x5519d7912ce7f435ull,
+        0xc764fa909d0b2688ull, 0x27c655cfecc233f7ull, 0xe85987a8af20a5f9ull,
+        0xd411bc7314c8d5dcull, 0x93899b016b45a3f0ull, 0x61f5d113c20b0df0ull,
+        0xb25da61e4a096903ull, 0x0dbe028d6d3567afull, 0x9fa2ffe90c694a8bull,
+        0xddbc8fc13fbb001bull, 0xd4f0394b007675b1ull, 0x82a77db81439b4c5ull,
+        0xe3926b17cba15b02ull, 0x8c9459c774f90065ull, 0xc96951bd97a7280dull,
+        0xd05abe912bca7f94ull, 0x60711d1a815f1c57ull, 0x042d25ce0d6cfd66ull,
+        0xe26807fc63178c4full, 0x7ce8a197b575c993ull, 0x40b7cd97348c4e6eull,
+        0x4121abca0b44faf6ull, 0xe52018057e436e7cull, 0xeee29d71348ff820ull,
+        0x5897af73be049411ull, 0x0a6fdc8a2abfe601ull, 0x9927489f06e9acb9ull,
+        0x212a9e204d2b3555ull, 0x726f34b152c7e23bull, 0xba18032b9081e787ull,
+        0x1e6fd7621f8d4fceull, 0xddc1ca0a680b74f2ull, 0x0b73fbbb3926fb78ull,
+        0x99f11bf5fbcb7c8cull, 0xfa95b50d32e55b88ull, 0x898481c3f32feb9full,
+        0x0c5530801a0da142ull, 0xe8d7a917f97df770ull, 0x4875f816a8423596ull,
+        0xdbb428b030a50aa9ull, 0x0e3950a4612c5231ull, 0xe3e8182323c04d1dull,
+        0x391f65dd70a31febull, 0xd0037d2ea87036c2ull, 0x585cb2a68d024115ull,
+        0x3ca80652b82e08daull, 0x1222a69b8994a108ull, 0x4de6d9cdceae67bcull,
+        0xddca8edabd55bf58ull, 0xf6a0757e4667e48eull, 0x9b32d9f9b71a27e7ull,
+        0x40f2769f8f20f8f8ull, 0x45043e807c88737full, 0xb8ee0dd038f6f4afull,
+        0x1484c5e77d62c435ull, 0x8dd2569dfa4d9131ull, 0x5f523ec999db3861ull,
+        0x3418fa6737e8b00dull, 0x269f5801674ff9a5ull, 0x0cd977b54925f868ull,
+        0x0efe2aca2f5aac13ull, 0x56317da6a2f6b8c4ull, 0xe534d38250fa24ddull,
+        0xdfa8dc9afeb39524ull, 0xf68b95bdbfe9f66full, 0xcd69cc6772132bd7ull,
+        0xb5b4dfded98e8544ull, 0x0387409dcb87d8d7ull, 0x8f0023832ffcb147ull,
+        0x2765011aafc4140full, 0x83081b652eca2bddull, 0x4d14a10e4b5b0ac3ull,
+        0x7c88af6e819ec2c9ull, 0x0e191e6f25748090ull, 0xd6495ebd110a22f4ull,
+        0xdbf1f3cefb3cbcdfull, 0x9448bef759c292caull, 0xa5634a3ae4d4acfbull,
+        0x7164a8c8c26ad6a4ull, 0x965e5a7cfb55c640ull, 0xdcf519a0992e424eull,
+        0x8f610efdff342da1ull, 0xf9242248af2415d8ull, 0x10c4b695164603b8ull,
+        0x1e87d6082fa1757bull, 0x7a57a7a99015387cull, 0x286a730fd18197c4ull,
+        0x337303598db3d5d7ull, 0xfec20b20ffa6cb03ull, 0x420ebf29112f2932ull,
+        0x854a5d8b53939260ull, 0xcb1a14d9f27695a2ull, 0x70d1a3a726ac668eull,
+        0xf1b6da4284c007a7ull, 0x72a04fdc5cb3134eull, 0x2a3d847fe51d6b08ull,
+        0x3b3b804a91cea167ull, 0xc59263aa363cac3bull, 0x034e799408af0885ull,
+        0x006262ed52a6fa26ull, 0xe0acc024778a11e8ull, 0xcd4d4ab18447afcaull,
+        0x576f160423a6c70cull, 0x10631e8624500040ull, 0x02221f668cc007feull,
+        0x4b061c0105120745ull, 0x2b15ed7d4b520260ull, 0x20410d99d63883d1ull,
+        0xe3375e48c3b54b20ull, 0xcc86a05034ecdea6ull, 0xced1542ae91014a1ull,
+        0x622980024f61246eull, 0x08b013659c68f806ull, 0xf5909002f128b242ull,
+        0x67d3234a7a8458beull, 0x201ac293eeaa9176ull, 0x0cb848026d5fa140ull,
+        0x5c02883711114816ull, 0x1c518a7c4631ec3aull, 0x164ab085407e6130ull,
+        0x00609822b1288189ull, 0x420e03588aad0882ull, 0xa0558040a144a900ull,
+        0x0054b1a8b0022848ull, 0x0a974810486c5464ull, 0x20406990422a4880ull,
+        0x04201d5a0c864f08ull, 0x00a14580208b518bull, 0x2020d0b080740015ull,
+        0xc000b3323000a400ull, 0x13011049400a9948ull, 0x8348220c6a884c49ull,
+        0x91500a5781080941ull, 0x16a001b492002140ull, 0x00a480923051a804ull,
+        0x1b11001460854081ull, 0x010442001c20810aull, 0x001a4d8101a30803ull,
+        0x4552001182b32021ull, 0x900000c8b61000a0ull, 0x4831008010402074ull,
+        0xa9d1000a00180808ull, 0x2040020c42038108ull, 0x80400040a0a03122ull,
+        0x448808048a111020ull, 0x0e8a1110001440a0ull, 0x0889100200080804ull,
+        0x2201120805400101ull, 0x2000000040888030ull, 0x0450880048841500ull,
+        0x0408801100800028ull, 0x00a8414002010808ull, 0x2220010280560201ull,
+        0x000000020000a804ull, 0x20050080000a0050ull, 0x01000a0000000000ull,
+        0x1100800400000008ull, 0x0022000000004020ull, 0x0000000000100080ull,
+        0x0000000000000004ull, 0x0800000000000000ull, 0x0010000040000000ull,
+        0x0000200000000002ull, 0x0000000000000000ull, 0x0000000000000000ull,
+        0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+        0x0000000000000000ull, 0x0000000000000000ull, 0x0000000000000000ull,
+        0x0000000000000001ull
+};
+
+constexpr uint64_t SFMT_SUBSTREAM_JUMP[] = {
+        0x5e225ed151444563ull, 0x830bec40b8b108e7ull, 0x77d7bd160b54d1d0ull,
+        0x3f9a0f6da03b13e3ull, 0x98b16b79294d2bf3ull, 0x9c2df76ea586f706ull,
+        0xc90c4264c4e0d3bcull, 0xca63a0cebe95446bull, 0xe36af88b91694922ull,
+        0xae02b4a4eb79fa19ull, 0x9b8fcd6149ad9ab2ull, 0xc9552d634edaa24bull,
+        0xa83c3f4c7bb28451ull, 0x6e709ffcf79f4275ull, 0x85390e45f1c34cc9ull,
+        0xb4d2d8f4567fe386ull, 0xf2abf93ca5926a0bull, 0x5894f0e2606d99daull,
+        0x1a70b3afb56d0dd4ull, 0x3ec19c1cf0e89bcaull, 0xc34a8c00f8714761ull,
+        0x7d8b1ec1a6d78e5dull, 0xf826a6feb84ee67full, 0x6097e28a06cff033ull,
+        0x669d48ddceb035a7ull, 0xdba943a7c7b202ccull, 0x2e65293d7379f98cull,
+        0xaf9da2ac7a00d998ull, 0x5013579ce01c1c17ull, 0x991c24197de08444ull,
+        0x6876b33a39ddaa18ull, 0xaa0d8a1f397d341aull, 0xd2c9cbf6a2ade65dull,
+        0xb7eb819b8e90d644ull, 0x5b22dd95c1e8d58cull, 0xea140c1335d6e87aull,
+        0x5bdf18d7033f420cull, 0xd5f5d19691833505ull, 0xf86a6066c249f812ull,
+        0x8c51c8ca31bd5ed3ull, 0xc59ef69d05eef629ull, 0x16d3906474a89d90ull,
+        0xb27886aabed5f7a5ull, 0xd2f72f40c7566008ull, 0x887671cc4166c5f7ull,
+        0x321e022de3afbeaaull, 0x98599c5b719fcc41ull, 0x05dc3c0492af7d46ull,
+        0x52958c262c42241dull, 0x5242bba63dc31257ull, 0x07da96a0fb307a93ull,
+        0xc3b3e17731c08e25ull, 0x08eb134251891a71ull, 0x379cf73d3b73fd24ull,
+        0x1b0be713228b24cbull, 0x7df38f2b100b1b44ull, 0xeb8dd0f6bda02d77ull,
+        0x0be314f124cdb658ull, 0x99d25dc99cc442cbull, 0xf6b6b6ca7030d3e3ull,
+        0x8044e5bc8e8c97acull, 0xf0cfce87afc06393ull, 0x7a30e7bdf94b201dull,
+        0x05526fba8d2294f7ull, 0xa075abed36fef39eull, 0xa15c1a1e471d3b9cull,
+        0xaf0255dc61b031faull, 0x4d09e04b50395df7ull, 0x56d213d10fa02e68ull,
+        0xb4f9a97eb791304cull, 0x5d5e302a3cf5d4d2ull, 0x4a000e6960020baeull,
+        0x02439c20e8928227ull, 0xe10f1a05d041a0e7ull, 0x8bd5d50e6e80fc94ull,
+        0x581bcf6c2af35820ull, 0xf50f6ba0cb05f538ull, 0x8a11e78fd267320full,
+        0xc761df5607cd7c68ull, 0x19c232d9d106f844ull, 0xae0d7a778bd075deull,
+        0x8166a4f10293d569ull, 0xd4588804d5d9ef6bull, 0x13a44dc9e566b890ull,
+        0x1944f063b457b033ull, 0x279e88fb1ef7b2f7ull, 0x2f41a3df2a55b25dull,
+        0x900b05e6410c8303ull, 0xab0d0660e4548ba9ull, 0xe1da68dacf71ad7full,
+        0x9c865edf3b565adbull, 0x618a2ac0d85f7673ull, 0x25c669c789632447ull,
+        0x16eabaf97384ec03ull, 0x483cfceae8cb3e49ull, 0xdccde2962036f18bull,
+        0x2f4070d3336f83cfull, 0x708dd9244a7dcd16ull, 0x267f10bd5b104dabull,
+        0xda1a542c41e9653bull, 0x8d15d273a47b23abull, 0x1391e311839cd017ull,
+        0x5b08dce82dd198ecull, 0xe61a358ca4ee7eeaull, 0xd826efea977684d1ull,
+        0x7f921f1ddeea8d7bull, 0x9542b399e0cbf868ull, 0x6202cafb857594c3ull,
+        0x34e46ff8ee863beaull, 0x128f2b032ff83571ull, 0xd8bcda3113149bf6ull,
+        0x7be2f9a61f1e611cull, 0x7c41fa963fb2572full, 0x2e7c5077287ab047ull,
+        0xd6aa00702751c1c1ull, 0x73393e18811f6bffull, 0xf65c676785e46aeeull,
+        0x1867f706d7cb63e9ull, 0x8672ee1bae8813b8ull, 0x813bd7d6f345099full,
+        0xe13b57e505d8122aull, 0xa92b63e8b915e0b2ull, 0xdf4d0fc49aa3c98dull,
+        0x9abb199960777a52ull, 0xd699f346b6eaeabeull, 0x370663c072780f99ull,
+        0x5bb79563d81872e8ull, 0x726e37e60cde7b7eull, 0x4b982abbdf58b81dull,
+        0xde56f975d9e839f5ull, 0x074684e28c7bc6ceull, 0x6dfbd02d02eb40c9ull,
+        0x8d1cd0b082bc0a89ull, 0xfb376ea380c34387ull, 0xd68696864e012262ull,
+        0x04a31a1e839a3cb3ull, 0x28a4c850943fc8c0ull, 0x97c3e67a93a05be4ull,
+        0xaac73e8ddf8db946ull, 0x71cc5c38ad0bbf61ull, 0x0df222adca27d494ull,
+        0x798e6cd135f38d97ull, 0xec63e7c66955928cull, 0xcb93ca939392ffbcull,
+        0x842f020e08a7c468ull, 0xcab759cc9a3531a2ull, 0x5e00adbb9e7ea1bcull,
+        0xfacf97bdd88726faull, 0x9a992357f024d632ull, 0x59c81140890fe9fcull,
+        0x5342a1831b28272aull, 0xd257bce2b0802f26ull, 0xcb8d60d65bf6ab7bull,
+        0x2f5e7d366943d633ull, 0x159d6ec9db7855b5ull, 0xec3ee696faffccedull,
+        0x6195772e236236d0ull, 0x854c37c9bf6397caull, 0xf45a7095592bdf2bull,
+        0x06834abde9ba07fcull, 0xccf5d87ce5772591ull, 0x54fd86790249ad29ull,
+        0x64a29b8ce27b9673ull, 0x5c321fbdea51f51bull, 0x2aa061a81dca5917ull,
+        0x926168e616739306ull, 0x185e52675442c6a1ull, 0x01f8f574811772f1ull,
+        0xf96f5e938b0584acull, 0x2c73305e2dff1c19ull, 0x50a61fc301790059ull,
+        0xd0d5fbaa81fddfa3ull, 0x4593a539c27befc0ull, 0xceed93ee06824818ull,
+        0x9d4f77ed7f03f13cull, 0x0c8e8cd3150aa920ull, 0x5c4c58b362afa15bull,
+        0xdf2980b2a821922eull, 0xaf46837f93992917ull, 0x92371033b2a7e134ull,
+        0x1b1619da06a5dd82ull, 0xdc9a893f29131cd2ull, 0xacd34b59d1ee5050ull,
+        0xd456bc877fc32a81ull, 0xa9763efaf51da4d5ull, 0xa50980bab2e65dc5ull,
+        0x0a764d5b257b2f32ull, 0xd1dc03d542116805ull, 0x1add0c5fa66931b5ull,
+        0x22598e3a3565100dull, 0xf5894abeb31c307cull, 0x5cbd62683d8eb941ull,
+        0x69bb9ada84748ed7ull, 0x4b383dcf4419802full, 0x802a7dd73e76f970ull,
+        0xe75763ade3f0ab97ull, 0xa1fc7037ee074084ull, 0x22e2a81090228a56ull,
+        0xbdc9f6a5f32f691dull, 0xd6e543b1440471cfull, 0x7fbbda2548fd0789ull,
+        0xdddb141d5a87ff1aull, 0xc47bfce525dece22ull, 0x0137c8fd5b3c650full,
+        0xde30e7f0bf7568bdull, 0xe76954a887da4ebaull, 0x9aab774af54291b5ull,
+        0x51c159165f083c7full, 0xab54952b18f298c4ull, 0x78d78e09285fa8e0ull,
+        0x4c504d3a9311b6c8ull, 0xdd9d8cd6ec71e051ull, 0x0a8d61a72b336e76ull,
+        0xeb564dd6551e4f81ull, 0xe88f97630686e386ull, 0xbd41dcaf962b1416ull,
+        0x550de574c1beed38ull, 0x5acc77f14117de90ull, 0xe828061135c8aaadull,
+        0x038d493c0c4de34bull, 0xfa9176a3dd997398ull, 0x4eed43a4049dde91ull,
+        0x6beecfcb8fbe72d7ull, 0x6c5821cdda5f4ce7ull, 0x3138bc34abb4b1d3ull,
+        0x176338f651d57a1full, 0x7f617cfa1ee3aec8ull, 0x46d74b5098f9853dull,
+        0xfa05009c50df7038ull, 0xa041512dde6238b8ull, 0xe2baf988bdd74577ull,
+        0xf47b01f08c500da9ull, 0x01d41b4e5076a999ull, 0x16d1fc39c9627ae0ull,
+        0x695a1d501b336484ull, 0x06c93c592d527640ull, 0x201dcc7b6892b83full,
+        0x607c20a024205de1ull, 0x2dbd8fe376366c3eull, 0xf3c0b4b0a365bde1ull,
+        0x3da11549bbf1b9d1ull, 0x4378316c1866e3b7ull, 0x513982c05e223668ull,
+        0x97b38b8b3db377b9ull, 0x4ea710d495334733ull, 0x155cad4e98cd178bull,
+        0x32863da85129ea5eull, 0x6e32d4a7b7d32da2ull, 0x186276326c6fc862ull,
+        0x08e7277035af7d2dull, 0x0e42b424e04a81bcull, 0x76335b915d47f5b7ull,
+        0x16e2af9086be70d5ull, 0x5aa596d03f35c274ull, 0x84c4af07b26f6b9aull,
+        0x004223ca313678c6ull, 0x70d43b4924f7eef0ull, 0x036acaa7591bd392ull,
+        0x55507ca64b5c009cull, 0xa45480118f879f79ull, 0x92399e93cf13174dull,
+        0x9608df429719a07bull, 0x8fe0ffa0bea08f9full, 0xf529d7f6caf2a78cull,
+        0xbae6621e1925f6e7ull, 0x13490f279d80451aull, 0x5f44d1f30f02a6adull,
+        0x73eff2f801d00a32ull, 0x677f4cdf4cee3b54ull, 0x8daba7d0394ca69aull,
+        0xb314ea7b27d3e1e7ull, 0xf5a631cd0d73e07cull, 0x472dc2282898f6fdull,
+        0xadafa9fa87a1edaaull, 0x12f69cdf7d848121ull, 0xd483367a9c37a7ebull,
+        0xe06d4eb6f4b86d6cull, 0x4264dad94c0df914ull, 0x510640bbf9a268feull,
+        0x07705e0311de7e69ull, 0x0afc006266845abdull, 0x7a57641a81cb625cull,
+        0x8d78f8a2caf689e1ull, 0x1af64f4582c31fc9ull, 0x1e0342e069f1e710ull,
+        0x646bdfe5b8a9ffd7ull, 0x5a8a5747b2b564dfull, 0x693a01c868eea7baull,
+        0x4b00f88f8929d1d0ull, 0x8a0aa9ca3c2e8c55ull, 0x0641b4683dd1e114ull,
+        0xc44e4703e2297656ull, 0x749c78cf14e865fdull, 0x18557e33a58a9c03ull,
+        0xddcaef375f9251abull, 0x8c92cac4140c3abaull, 0xb4db80b8a6c828cdull,
+        0x331231d638438624ull, 0x46457e2b196e0386ull, 0xcf8ecdfba21cfe35ull,
+        0x34d8a259d17241b0ull, 0xd3dd6961c0c89372ull, 0x7c7d550196247e23ull,
+        0x08133f3307ee8b3aull, 0x896fcd94b224fff7ull, 0x8a5208f2072a59bdull,
+        0xf826a56b0b272ae2ull, 0xdde0ba933519a4f1ull, 0x82afb23d9815e196ull,
+        0x5189e52776c73e60ull, 0x51114ee85d05453bull, 0x52a8099f5395ac22ull,
+        0x0000000000000000ull
+};
+
+#else
+#error "No jump polynomials for this SFMT_MEXP"
+#endif
+
+} /* namespace poker */
+
+#endif /* SFMTJUMPPARAMS_H_ */
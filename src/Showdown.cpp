@@ -0,0 +1,31 @@
+#include "Showdown.h"
+#include "CpuDispatch.h"
+
+#include <stdexcept>
+
+namespace poker {
+
+uint32_t Showdown::resolve(const CardSet& board, const HoleCards* players,
+        int n, HandRanking* rankings) {
+#ifdef CARD_CHECKS
+    if (n < 0 || n > MAX_PLAYERS) {
+        throw new std::runtime_error(
+                "Invalid number of players: " + std::to_string(n));
+    }
+    if (board.size() != 5) {
+        throw new std::runtime_error("Incomplete board");
+    }
+#endif
+    static_assert(MAX_PLAYERS <= detail::MAX_SHOWDOWN, "Showdown size");
+    CardSet hands[MAX_PLAYERS];
+    for (int p = 0; p < n; ++p) {
+        hands[p] = board;
+        hands[p].add(players[p].getFirst());
+        hands[p].add(players[p].getSecond());
+    }
+    return detail::rankKernels().showdown(
+            reinterpret_cast<const __m128i*>(hands), n,
+            reinterpret_cast<uint64_t*>(rankings));
+}
+
+} /* namespace poker */
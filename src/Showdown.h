@@ -0,0 +1,27 @@
+#ifndef SHOWDOWN_H_
+#define SHOWDOWN_H_
+
+#include "CardSet.h"
+
+#include <stdint.h>
+
+namespace poker {
+
+// Decides who wins the pot once the board is complete.
+class Showdown {
+public:
+    // As many as the deck has hole cards for next to the board.
+    constexpr static int MAX_PLAYERS = (Card::COUNT - 5) / 2;
+
+    // Returns a mask with bit p set for every one of the n players holding
+    // the best hand, several bits mean a split pot. The board is added to the
+    // hole cards once per player and all hands are ranked together in SIMD
+    // lanes, the winners are picked without sorting the rankings. If rankings
+    // is not null, it receives the ranking of every player.
+    static uint32_t resolve(const CardSet& board, const HoleCards* players,
+            int n, HandRanking* rankings = nullptr);
+};
+
+} /* namespace poker */
+
+#endif /* SHOWDOWN_H_ */
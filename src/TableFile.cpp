@@ -0,0 +1,272 @@
+#include "TableFile.h"
+#include "Numa.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace poker {
+
+namespace {
+
+static_assert(sizeof(TableFileHeader) == 64, "TableFileHeader layout");
+
+// FNV-1a over 64-bit words rather than bytes, so verifying a mapped table
+// costs a fraction of generating it.
+uint64_t checksum(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = 0xcbf29ce484222325;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * 0x100000001b3;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3;
+    }
+    return hash;
+}
+
+std::runtime_error* invalid(const std::string& path, const std::string& why) {
+    return new std::runtime_error("Invalid table file " + path + ": " + why);
+}
+
+// Policy of mbind(2), from the kernel's mempolicy.h: allocate on the node
+// while it has free memory.
+constexpr int MPOL_PREFERRED = 1;
+
+std::mutex directory_mutex;
+
+std::string& directory() {
+    static std::string dir = getenv("POKER_TABLE_DIR") ?
+            getenv("POKER_TABLE_DIR") : "";
+    return dir;
+}
+
+}
+
+TableData::TableData() :
+        mapping(nullptr), mapping_size(0), anonymous(false), payload(nullptr),
+        length(0) {
+}
+
+TableData::TableData(TableData&& other) :
+        heap(std::move(other.heap)), mapping(other.mapping), mapping_size(
+                other.mapping_size), anonymous(other.anonymous), payload(
+                other.payload), length(other.length) {
+    other.mapping = nullptr;
+    other.payload = nullptr;
+    other.length = 0;
+}
+
+TableData& TableData::operator=(TableData&& other) {
+    if (this != &other) {
+        if (mapping) {
+            munmap(mapping, mapping_size);
+        }
+        heap = std::move(other.heap);
+        mapping = other.mapping;
+        mapping_size = other.mapping_size;
+        anonymous = other.anonymous;
+        payload = other.payload;
+        length = other.length;
+        other.mapping = nullptr;
+        other.payload = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+TableData::~TableData() {
+    if (mapping) {
+        munmap(mapping, mapping_size);
+    }
+}
+
+TableData TableData::generate(size_t size,
+        const std::function<void(void*)>& fill) {
+    TableData table;
+    size_t blocks = (size + sizeof(Block) - 1) / sizeof(Block);
+    table.heap.reset(new Block[blocks]);
+    memset(table.heap.get(), 0, blocks * sizeof(Block));
+    fill(table.heap.get());
+    table.payload = table.heap.get();
+    table.length = size;
+    return table;
+}
+
+TableData TableData::generate(size_t size,
+        const std::function<void(void*)>& fill, uint32_t numa_node) {
+    TableData table;
+    table.mapping_size = std::max<size_t>(size, 1);
+    table.mapping = mmap(nullptr, table.mapping_size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (table.mapping == MAP_FAILED) {
+        table.mapping = nullptr;
+        throw new std::runtime_error(
+                std::string("Cannot allocate table: ") + strerror(errno));
+    }
+    table.anonymous = true;
+    if (numa_node < MAX_NUMA_NODES) {
+        // Without libnuma and its numaif.h. Fails e.g. in containers that
+        // do not allow it, first touch still applies then. The kernel reads
+        // one bit less than the given node count.
+        unsigned long mask[MAX_NUMA_NODES / 64] = { };
+        mask[numa_node / 64] = 1ul << (numa_node % 64);
+        syscall(SYS_mbind, table.mapping, table.mapping_size, MPOL_PREFERRED,
+                mask, MAX_NUMA_NODES + 1, 0);
+    }
+    void* payload = table.mapping;
+    std::thread([&]() {
+        pinThreadToNumaNode(numa_node);
+        fill(payload);
+    }).join();
+    table.payload = payload;
+    table.length = size;
+    return table;
+}
+
+TableData TableData::map(const std::string& path, const std::string& name,
+        uint32_t version) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw invalid(path, strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 0
+            || static_cast<size_t>(st.st_size) < sizeof(TableFileHeader)) {
+        close(fd);
+        throw invalid(path, "truncated header");
+    }
+    TableData table;
+    table.mapping_size = st.st_size;
+    table.mapping = mmap(nullptr, table.mapping_size, PROT_READ, MAP_SHARED,
+            fd, 0);
+    close(fd);
+    if (table.mapping == MAP_FAILED) {
+        table.mapping = nullptr;
+        throw invalid(path, strerror(errno));
+    }
+
+    const TableFileHeader* header =
+            static_cast<const TableFileHeader*>(table.mapping);
+    if (header->magic != TableFileHeader::MAGIC) {
+        throw invalid(path, "bad magic");
+    }
+    if (strncmp(header->name, name.c_str(), sizeof(header->name)) != 0) {
+        throw invalid(path, "holds " + std::string(header->name,
+                strnlen(header->name, sizeof(header->name))));
+    }
+    if (header->version != version) {
+        throw invalid(path, "version " + std::to_string(header->version)
+                + " instead of " + std::to_string(version));
+    }
+    if (header->size != table.mapping_size - sizeof(TableFileHeader)) {
+        throw invalid(path, "truncated payload");
+    }
+    table.payload = header + 1;
+    table.length = header->size;
+    if (checksum(table.payload, table.length) != header->checksum) {
+        throw invalid(path, "checksum mismatch");
+    }
+    return table;
+}
+
+void TableData::write(const std::string& path, const std::string& name,
+        uint32_t version, const void* data, size_t size) {
+    TableFileHeader header;
+    memset(&header, 0, sizeof(header));
+    if (name.size() >= sizeof(header.name)) {
+        throw new std::runtime_error("Table name too long: " + name);
+    }
+    header.magic = TableFileHeader::MAGIC;
+    memcpy(header.name, name.data(), name.size());
+    header.version = version;
+    header.size = size;
+    header.checksum = checksum(data, size);
+
+    std::string temp = path + ".tmp" + std::to_string(getpid());
+    int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw new std::runtime_error(
+                "Cannot write table file " + temp + ": " + strerror(errno));
+    }
+    const char* parts[] = { reinterpret_cast<const char*>(&header),
+            static_cast<const char*>(data) };
+    size_t sizes[] = { sizeof(header), size };
+    for (int p = 0; p < 2; ++p) {
+        size_t done = 0;
+        while (done < sizes[p]) {
+            ssize_t n = ::write(fd, parts[p] + done, sizes[p] - done);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                std::string error = strerror(errno);
+                close(fd);
+                unlink(temp.c_str());
+                throw new std::runtime_error(
+                        "Cannot write table file " + temp + ": " + error);
+            }
+            done += n;
+        }
+    }
+    close(fd);
+    if (rename(temp.c_str(), path.c_str()) != 0) {
+        std::string error = strerror(errno);
+        unlink(temp.c_str());
+        throw new std::runtime_error(
+                "Cannot write table file " + path + ": " + error);
+    }
+}
+
+std::string getTableDirectory() {
+    std::lock_guard<std::mutex> lock(directory_mutex);
+    return directory();
+}
+
+void setTableDirectory(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(directory_mutex);
+    directory() = dir;
+}
+
+TableData loadTable(const std::string& name, uint32_t version, size_t size,
+        const std::function<void(void*)>& fill) {
+    std::string dir = getTableDirectory();
+    if (dir.empty()) {
+        return TableData::generate(size, fill);
+    }
+    std::string path = dir + "/" + name + ".tbl";
+    try {
+        TableData table = TableData::map(path, name, version);
+        if (table.size() == size) {
+            return table;
+        }
+    } catch (std::runtime_error* e) {
+        // Missing or stale, generated below.
+        delete e;
+    }
+    TableData table = TableData::generate(size, fill);
+    try {
+        TableData::write(path, name, version, table.data(), table.size());
+        return TableData::map(path, name, version);
+    } catch (std::runtime_error* e) {
+        // E.g. a read-only directory, the process keeps its own copy.
+        delete e;
+        return table;
+    }
+}
+
+} /* namespace poker */
@@ -0,0 +1,106 @@
+#ifndef TABLEFILE_H_
+#define TABLEFILE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// Header in front of the payload of a table file. All fields are stored in
+// the byte order of the host, which the magic doubles as a check for.
+struct TableFileHeader {
+    constexpr static uint64_t MAGIC = 0x31454c4254524b50; // "PKRTBLE1"
+
+    uint64_t magic;
+    char name[32];      // Kind of table, zero padded.
+    uint32_t version;   // Layout version of the payload.
+    uint32_t reserved;
+    uint64_t size;      // Payload bytes following the header.
+    uint64_t checksum;  // FNV-1a of the payload words.
+};
+
+// Block of read-only lookup data, either generated on the heap or mapped
+// from a table file. Mapped tables live in the page cache, so any number of
+// processes on a host share one copy and skip the generation.
+class TableData {
+public:
+    TableData();
+    TableData(TableData&& other);
+    TableData& operator=(TableData&& other);
+    ~TableData();
+
+    TableData(const TableData&) = delete;
+    TableData& operator=(const TableData&) = delete;
+
+    // Allocates size bytes, 16-byte aligned and zeroed, and passes them to
+    // fill.
+    static TableData generate(size_t size,
+            const std::function<void(void*)>& fill);
+
+    // Like generate(), but in the memory of the NUMA node: the pages are
+    // bound to the node where the kernel allows it, and fill runs on a
+    // thread pinned to the node, so that first touch places them there
+    // otherwise. Fill must not throw.
+    static TableData generate(size_t size,
+            const std::function<void(void*)>& fill, uint32_t numa_node);
+
+    // Maps the payload of the table file read-only. Throws if the file is
+    // missing, of a different kind or version, or corrupt.
+    static TableData map(const std::string& path, const std::string& name,
+            uint32_t version);
+
+    // Writes a table file with the payload. The file is replaced atomically,
+    // so processes mapping it concurrently see either the old or new table.
+    static void write(const std::string& path, const std::string& name,
+            uint32_t version, const void* data, size_t size);
+
+    const void* data() const {
+        return payload;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    template<typename T>
+    const T* as() const {
+        return static_cast<const T*>(payload);
+    }
+
+    bool isMapped() const {
+        return mapping != nullptr && !anonymous;
+    }
+
+private:
+    struct alignas(16) Block {
+        char bytes[16];
+    };
+
+    std::unique_ptr<Block[]> heap;
+    void* mapping;
+    size_t mapping_size;
+    // The mapping is memory of a NUMA node rather than a file.
+    bool anonymous;
+    const void* payload;
+    size_t length;
+};
+
+// Directory table files are kept in. Defaults to $POKER_TABLE_DIR, empty
+// disables the files.
+std::string getTableDirectory();
+
+void setTableDirectory(const std::string& directory);
+
+// Maps the table <name>.tbl from the table directory. If there is no
+// directory, the table is generated in memory. If the file is missing or
+// unusable, it is generated and written for the next process.
+TableData loadTable(const std::string& name, uint32_t version, size_t size,
+        const std::function<void(void*)>& fill);
+
+} /* namespace poker */
+
+#endif /* TABLEFILE_H_ */
@@ -0,0 +1,255 @@
+#include "TaskScheduler.h"
+#include "Numa.h"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <thread>
+
+namespace poker {
+
+namespace {
+
+// Rounds of looking for work before an idle worker goes to sleep.
+constexpr uint32_t SPIN_ROUNDS = 64;
+
+}
+
+void* ScratchArena::allocateBytes(size_t size) {
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    for (; block < blocks.size(); ++block, offset = 0) {
+        if (offset + size <= blocks[block].size) {
+            void* result = blocks[block].begin + offset;
+            offset += size;
+            return result;
+        }
+    }
+    Block added;
+    added.size = std::max(size, block_size);
+    added.memory.reset(new char[added.size + ALIGNMENT]);
+    uintptr_t address = reinterpret_cast<uintptr_t>(added.memory.get());
+    added.begin = added.memory.get()
+            + ((ALIGNMENT - address % ALIGNMENT) % ALIGNMENT);
+    blocks.push_back(std::move(added));
+    block = blocks.size() - 1;
+    offset = size;
+    return blocks[block].begin;
+}
+
+// A call of parallelFor, lives on the stack of the caller.
+struct TaskScheduler::Request {
+    Request(const Body& body, uint64_t grain, uint64_t size) :
+            body(body), grain(grain), remaining(size) {
+    }
+
+    const Body& body;
+    uint64_t grain;
+    // Items not yet done, or skipped after a failure.
+    std::atomic<uint64_t> remaining;
+    std::atomic<bool> failed { false };
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = false;
+    std::exception_ptr error;
+};
+
+struct TaskScheduler::Worker {
+    Worker(TaskScheduler& scheduler, uint32_t index, int32_t node) :
+            scheduler(scheduler), index(index), node(node) {
+    }
+
+    TaskScheduler& scheduler;
+    uint32_t index;
+    // NUMA node the worker is pinned to, -1 if not pinned.
+    int32_t node;
+
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    ScratchArena arena;
+    std::thread thread;
+
+    // The worker running on this thread, if any.
+    static thread_local Worker* current;
+};
+
+thread_local TaskScheduler::Worker* TaskScheduler::Worker::current = nullptr;
+
+TaskScheduler::TaskScheduler(uint32_t threads, bool pin_to_numa_nodes) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<int32_t> nodes;
+    for (uint32_t node = 0; pin_to_numa_nodes && node < getNumaNodeCount();
+            ++node) {
+        if (!getNumaNodeCpus(node).empty()) {
+            nodes.push_back(node);
+        }
+    }
+    for (uint32_t w = 0; w < threads; ++w) {
+        // Consecutive workers share a node, and so are stolen from first.
+        int32_t node = nodes.empty() ? -1 : nodes[w * nodes.size() / threads];
+        workers.emplace_back(new Worker(*this, w, node));
+    }
+    // All deques exist before any worker tries to steal.
+    for (std::unique_ptr<Worker>& worker : workers) {
+        worker->thread = std::thread(&TaskScheduler::runWorker, this,
+                std::ref(*worker));
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping.store(true);
+    }
+    wake.notify_all();
+    for (std::unique_ptr<Worker>& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+void TaskScheduler::run(uint64_t begin, uint64_t end, uint64_t grain,
+        const Body& body) {
+    if (begin >= end) {
+        return;
+    }
+    Request request(body, std::max<uint64_t>(grain, 1), end - begin);
+    Worker* self = Worker::current;
+    if (self && &self->scheduler != this) {
+        self = nullptr;
+    }
+    if (self) {
+        push(*self, Task { &request, begin, end });
+        // Runs tasks, most likely those of this request, until it is done.
+        Task task;
+        while (request.remaining.load() != 0) {
+            if (pop(*self, task) || steal(*self, task)) {
+                execute(*self, task);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    } else {
+        uint32_t w = next_worker.fetch_add(1, std::memory_order_relaxed)
+                % workers.size();
+        push(*workers[w], Task { &request, begin, end });
+    }
+
+    // Also after the last items are counted, the worker finishing them still
+    // signals under the lock.
+    std::unique_lock<std::mutex> lock(request.mutex);
+    request.finished.wait(lock, [&]() {
+        return request.done;
+    });
+    if (request.error) {
+        std::rethrow_exception(request.error);
+    }
+}
+
+void TaskScheduler::runWorker(Worker& worker) {
+    Worker::current = &worker;
+    if (worker.node >= 0) {
+        pinThreadToNumaNode(worker.node);
+    }
+    Task task;
+    uint32_t idle = 0;
+    for (;;) {
+        if (pop(worker, task) || steal(worker, task)) {
+            execute(worker, task);
+            idle = 0;
+            continue;
+        }
+        if (++idle < SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+        idle = 0;
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleeping++;
+        wake.wait(lock, [&]() {
+            return queued.load() != 0 || stopping.load();
+        });
+        sleeping--;
+        if (stopping.load()) {
+            return;
+        }
+    }
+}
+
+void TaskScheduler::push(Worker& worker, const Task& task) {
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(task);
+    }
+    queued++;
+    // A worker about to sleep counts itself as sleeping before it checks
+    // for queued tasks, so either it sees this task or this sees it.
+    if (sleeping.load() != 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+        }
+        wake.notify_one();
+    }
+}
+
+bool TaskScheduler::pop(Worker& worker, Task& task) {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = worker.tasks.back();
+    worker.tasks.pop_back();
+    queued--;
+    return true;
+}
+
+bool TaskScheduler::steal(Worker& thief, Task& task) {
+    // Workers of the same node first, which is all of them unless pinned.
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = 1; i < workers.size(); ++i) {
+            Worker& victim = *workers[(thief.index + i) % workers.size()];
+            if ((victim.node == thief.node) != (pass == 0)) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.front();
+                victim.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::execute(Worker& worker, Task task) {
+    Request& request = *task.request;
+    while (task.end - task.begin > request.grain) {
+        uint64_t middle = task.begin + (task.end - task.begin) / 2;
+        push(worker, Task { &request, middle, task.end });
+        task.end = middle;
+    }
+    if (!request.failed.load(std::memory_order_relaxed)) {
+        ScratchArena::Scope scope(worker.arena);
+        try {
+            request.body(task.begin, task.end, worker.arena);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(request.mutex);
+            if (!request.error) {
+                request.error = std::current_exception();
+            }
+            request.failed.store(true, std::memory_order_relaxed);
+        }
+    }
+    uint64_t items = task.end - task.begin;
+    if (request.remaining.fetch_sub(items) == items) {
+        // The caller may return as soon as the lock is released.
+        std::lock_guard<std::mutex> lock(request.mutex);
+        request.done = true;
+        request.finished.notify_all();
+    }
+}
+
+} /* namespace poker */
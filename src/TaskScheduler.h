@@ -0,0 +1,174 @@
+#ifndef TASKSCHEDULER_H_
+#define TASKSCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace poker {
+
+// Bump allocator for scratch buffers, e.g. the CardSet and HandRanking
+// arrays of a batch. Allocations are never freed one by one, a Scope
+// rewinds everything allocated since it was opened. The blocks are kept, so
+// an arena in steady use allocates no memory at all.
+class ScratchArena {
+public:
+    constexpr static size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit ScratchArena(size_t block_size = DEFAULT_BLOCK_SIZE) :
+            block_size(block_size) {
+    }
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // Array of count default constructed objects, aligned to a cache line.
+    template<typename T>
+    T* allocate(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value,
+                "Scratch objects are never destroyed");
+        T* result = static_cast<T*>(allocateBytes(count * sizeof(T)));
+        for (size_t i = 0; i < count; ++i) {
+            new (result + i) T();
+        }
+        return result;
+    }
+
+    // Rewinds the arena to where it was on construction.
+    class Scope {
+    public:
+        explicit Scope(ScratchArena& arena) :
+                arena(arena), block(arena.block), offset(arena.offset) {
+        }
+
+        ~Scope() {
+            arena.block = block;
+            arena.offset = offset;
+        }
+
+    private:
+        ScratchArena& arena;
+        size_t block;
+        size_t offset;
+    };
+
+private:
+    constexpr static size_t ALIGNMENT = 64;
+
+    void* allocateBytes(size_t size);
+
+    struct Block {
+        std::unique_ptr<char[]> memory;
+        char* begin;
+        size_t size;
+    };
+
+    size_t block_size;
+    std::vector<Block> blocks;
+    // Allocations continue at offset into blocks[block].
+    size_t block = 0;
+    size_t offset = 0;
+};
+
+// Work-stealing scheduler for ranges of independent work items, such as the
+// board indices of an enumeration or the chunks of a simulation. Meant to be
+// shared by all requests of a process, so small requests are not stuck
+// behind large ones and all workers stay busy.
+//
+// Every worker owns a deque of tasks. A task is a subrange of a request; the
+// worker running it splits off the upper half onto the back of its deque
+// until no more than the grain is left, runs that and then pops the most
+// recent task again. Idle workers steal from the front of other deques,
+// which holds the oldest and so the largest ranges. New requests are pushed
+// onto the back of a deque round robin, so they run as soon as the task in
+// progress there is done. The deques have a lock each, taken by the owner
+// and by thieves only, there is no shared queue.
+//
+// Tasks get the scratch arena of the worker running them, rewound once they
+// return.
+//
+// On hosts with several NUMA nodes the workers can be pinned, spread evenly
+// over the nodes. They read the tables of their node then, see
+// replicateRankTables(), and steal from workers of the same node first.
+class TaskScheduler {
+public:
+    // Defaults to the number of hardware threads.
+    explicit TaskScheduler(uint32_t threads = 0, bool pin_to_numa_nodes =
+            false);
+
+    // Stops the workers, no request may be running.
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    uint32_t getThreads() const {
+        return workers.size();
+    }
+
+    // Calls f(uint64_t begin, uint64_t end, ScratchArena&) for disjoint
+    // subranges of [begin, end), each at most grain items long, and returns
+    // once all are done. Can be called from any thread, also from within a
+    // task; a worker waiting for a request runs tasks in the meantime. If a
+    // call of f throws, the remaining subranges are skipped and the first
+    // exception is rethrown.
+    template<typename F>
+    void parallelFor(uint64_t begin, uint64_t end, uint64_t grain, F f) {
+        run(begin, end, grain, f);
+    }
+
+private:
+    typedef std::function<void(uint64_t, uint64_t, ScratchArena&)> Body;
+
+    struct Request;
+    struct Worker;
+
+    struct Task {
+        Request* request;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    void run(uint64_t begin, uint64_t end, uint64_t grain, const Body& body);
+    void runWorker(Worker& worker);
+
+    void push(Worker& worker, const Task& task);
+    bool pop(Worker& worker, Task& task);
+    bool steal(Worker& thief, Task& task);
+    void execute(Worker& worker, Task task);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<uint32_t> next_worker { 0 };
+
+    // Tasks in all deques, for idle workers to know when to sleep.
+    std::atomic<uint64_t> queued { 0 };
+    std::atomic<uint32_t> sleeping { 0 };
+    std::atomic<bool> stopping { false };
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+};
+
+// Calls f(TaskScheduler&) on the scheduler or, if it is null, on one of the
+// given number of threads (all hardware threads for 0) started for the call.
+// Returns what f returns.
+template<typename F>
+auto withScheduler(TaskScheduler* scheduler, F f, uint32_t threads = 0)
+        -> decltype(f(*scheduler)) {
+    if (scheduler) {
+        return f(*scheduler);
+    }
+    TaskScheduler local(threads);
+    return f(local);
+}
+
+} /* namespace poker */
+
+#endif /* TASKSCHEDULER_H_ */
@@ -0,0 +1,72 @@
+#include "BoardEnumerator.h"
+#include "AllCards.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <set>
+
+namespace poker {
+
+TEST(BoardEnumerator, binomial) {
+    EXPECT_EQ(1, BoardEnumerator::binomial(0, 0));
+    EXPECT_EQ(1, BoardEnumerator::binomial(48, 0));
+    EXPECT_EQ(48, BoardEnumerator::binomial(48, 1));
+    EXPECT_EQ(0, BoardEnumerator::binomial(3, 4));
+    EXPECT_EQ(1712304, BoardEnumerator::binomial(48, 5));
+    EXPECT_EQ(2598960, BoardEnumerator::binomial(52, 5));
+}
+
+TEST(BoardEnumerator, allBoards) {
+    CardSet board( { _AS, _KS, _QS });
+    CardSet excluded( { _AS, _KS, _QS, _2C, _2D, _7H });
+    BoardEnumerator boards(board, excluded, 2);
+    ASSERT_EQ(BoardEnumerator::binomial(46, 2), boards.size());
+
+    std::set<std::string> seen;
+    boards.forEach([&](const CardSet& cs) {
+        ASSERT_EQ(5, cs.size());
+        ASSERT_TRUE(cs.contains(_AS) && cs.contains(_KS) && cs.contains(_QS));
+        ASSERT_FALSE(cs.contains(_2C) || cs.contains(_2D) || cs.contains(_7H));
+        seen.insert(cs.toString());
+    });
+    ASSERT_EQ(boards.size(), seen.size());
+}
+
+TEST(BoardEnumerator, ranges) {
+    CardSet excluded( { _AS, _KD, _QS, _JH, _7C, _2C, _9D, _8D, _TH, _6S });
+    BoardEnumerator boards(CardSet(), excluded, 3);
+
+    std::vector<std::string> all;
+    boards.forEach([&](const CardSet& cs) {
+        all.push_back(cs.toString());
+    });
+    ASSERT_EQ(BoardEnumerator::binomial(42, 3), all.size());
+
+    // Walking arbitrary index ranges visits the same boards in order.
+    std::vector<std::string> split;
+    uint64_t bounds[] = { 0, 1, 17, 820, 821, 5000, boards.size() };
+    for (size_t i = 0; i + 1 < sizeof(bounds) / sizeof(bounds[0]); ++i) {
+        boards.forEach(bounds[i], bounds[i + 1], [&](const CardSet& cs) {
+            split.push_back(cs.toString());
+        });
+    }
+    ASSERT_EQ(all, split);
+}
+
+TEST(BoardEnumerator, nothingToAdd) {
+    CardSet board( { _AS, _KS, _QS, _2C, _2D });
+    BoardEnumerator boards(board, board, 0);
+    ASSERT_EQ(1, boards.size());
+
+    int calls = 0;
+    boards.forEach([&](const CardSet& cs) {
+        EXPECT_EQ(5, cs.size());
+        calls++;
+    });
+    EXPECT_EQ(1, calls);
+
+    EXPECT_THROW(BoardEnumerator(board, board, 6), std::runtime_error*);
+}
+
+}
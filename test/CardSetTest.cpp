@@ -4,6 +4,9 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include <cmath>
+#include <map>
+
 namespace poker {
 
 TEST(Card, RankAndColor) {
@@ -73,6 +76,24 @@ TEST(CardSet, addCard) {
     ASSERT_EQ(4, cs.size());
 }
 
+TEST(CardSet, removeCard) {
+    CardSet cs( { _QD, _5H, _AH, _KD, _5C, _5S, _9D, _2D });
+    cs.remove(_2D);
+    ASSERT_EQ(7, cs.size());
+    ASSERT_FALSE(cs.contains(_2D));
+    ASSERT_EQ(HandRanking::THREE_OF_A_KIND, cs.rankTexasHoldem().getRanking());
+
+    cs.remove(_9D);
+    cs.add(_5D);
+    ASSERT_THAT(cs.toCardVector(),
+            testing::ElementsAre(_5C, _5D, _QD, _KD, _5H, _AH, _5S));
+    ASSERT_TRUE(CardSet( { _5C, _5D, _QD, _KD, _5H, _AH, _5S })
+            .rankTexasHoldem() == cs.rankTexasHoldem());
+    ASSERT_EQ(HandRanking::FOUR_OF_A_KIND, cs.rankTexasHoldem().getRanking());
+
+    EXPECT_THROW(cs.remove(_9D), std::runtime_error*);
+}
+
 TEST(CardSet, addAllCardSet) {
     CardSet cs1;
     CardSet cs2;
@@ -95,6 +116,15 @@ TEST(CardSet, addAllCardSet) {
     ASSERT_EQ(4, cs1.size());
 }
 
+TEST(CardSet, ToString) {
+    EXPECT_EQ("", CardSet().toString());
+    CardSet cs;
+    cs.add(Card(Rank::_3, Color::HEARTS));
+    cs.add(Card(Rank::A, Color::CLUBS));
+    cs.add(Card(Rank::Q, Color::CLUBS));
+    EXPECT_EQ("QCAC3H", cs.toString());
+}
+
 TEST(FastDeck, deal) {
     FastDeck deck;
     CardSet cs;
@@ -112,6 +142,149 @@ TEST(FastDeck, deal) {
     ASSERT_EQ(52, cs.size());
 }
 
+TEST(FastDeck, dealExcluded) {
+    CardSet excluded( { _AS, _AH, _2C, _TD });
+    FastDeck deck(excluded, 42);
+    ASSERT_EQ(48, deck.size());
+
+    for (int round = 0; round < 2; ++round) {
+        deck.shuffle();
+        CardSet cs;
+        for (int i = 0; i < 48; ++i) {
+            Card c = deck.deal();
+            ASSERT_FALSE(excluded.contains(c)) << c.toString();
+            cs.add(c);
+        }
+        ASSERT_EQ(48, cs.size());
+    }
+}
+
+TEST(FastDeck, dealN) {
+    FastDeck deck(3);
+    for (int round = 0; round < 3; ++round) {
+        deck.shuffle();
+        HoleCards hands[23];
+        deck.dealHands(hands, 23);
+        Card rest[6];
+        deck.dealN(rest, 6);
+
+        CardSet cs;
+        for (const HoleCards& hand : hands) {
+            cs.addAll(hand.toCardSet());
+        }
+        for (Card c : rest) {
+            cs.add(c);
+        }
+        ASSERT_EQ(52, cs.size());
+    }
+#ifdef CARD_CHECKS
+    deck.shuffle();
+    Card cards[53];
+    EXPECT_THROW(deck.dealN(cards, 53), std::runtime_error*);
+#endif
+}
+
+TEST(FastDeck, split) {
+    FastDeck deck(3);
+    FastDeck jumped(3);
+    jumped.jump();
+    jumped.jump();
+    FastDeck split = deck.split(2);
+    FastDeck other = deck.split(1);
+
+    int same = 0;
+    for (int i = 0; i < 100; ++i) {
+        deck.shuffle();
+        jumped.shuffle();
+        split.shuffle();
+        other.shuffle();
+        Card card = split.deal();
+        ASSERT_EQ(jumped.deal(), card);
+        same += other.deal() == card;
+    }
+    EXPECT_LT(same, 20);
+}
+
+namespace {
+
+// All six orders of a three card deck are equally likely.
+template<typename Deck>
+void expectUniform() {
+    CardSet excluded = CardSet::fullDeck();
+    for (Card c : { _2C, _7D, _AS }) {
+        excluded.remove(c);
+    }
+    Deck deck(excluded, 7);
+    std::map<std::string, int> orders;
+    const int shuffles = 60000;
+    for (int i = 0; i < shuffles; ++i) {
+        deck.shuffle();
+        Card cards[3];
+        deck.dealN(cards, 3);
+        orders[cards[0].toString() + cards[1].toString()
+                + cards[2].toString()]++;
+    }
+    ASSERT_EQ(6, orders.size());
+    double expected = shuffles / 6.0;
+    double sigma = sqrt(expected * 5 / 6);
+    for (const auto& order : orders) {
+        EXPECT_NEAR(expected, order.second, 5 * sigma) << order.first;
+    }
+}
+
+}
+
+TEST(FastDeck, uniform) {
+    expectUniform<FastDeck>();
+}
+
+TEST(PhiloxDeck, uniform) {
+    expectUniform<PhiloxDeck>();
+}
+
+TEST(PhiloxDeck, split) {
+    PhiloxDeck deck(5);
+    PhiloxDeck jumped(5);
+    for (int i = 0; i < 3; ++i) {
+        jumped.jump();
+    }
+    // Far away substreams cost the same, each trial can have one.
+    PhiloxDeck far = deck.split(1000000);
+    PhiloxDeck near_far = deck.split(999999).split(1);
+
+    PhiloxDeck split = deck.split(3);
+    for (PhiloxDeck* d : { &split, &jumped, &far, &near_far }) {
+        d->shuffle();
+    }
+
+    HoleCards hands[26], expected[26], far_hands[26], near_far_hands[26];
+    split.dealHands(hands, 26);
+    jumped.dealHands(expected, 26);
+    far.dealHands(far_hands, 26);
+    near_far.dealHands(near_far_hands, 26);
+    CardSet all;
+    for (int i = 0; i < 26; ++i) {
+        EXPECT_EQ(expected[i].toString(), hands[i].toString());
+        EXPECT_EQ(near_far_hands[i].toString(), far_hands[i].toString());
+        all.addAll(hands[i].toCardSet());
+    }
+    EXPECT_EQ(52, all.size());
+}
+
+TEST(HoleCards, toCardSet) {
+    HoleCards hole(_AS, _KD);
+    EXPECT_EQ(_AS, hole.getFirst());
+    EXPECT_EQ(_KD, hole.getSecond());
+    EXPECT_EQ("ASKD", hole.toString());
+
+    CardSet cs = hole.toCardSet();
+    EXPECT_EQ(2, cs.size());
+    EXPECT_TRUE(cs.contains(_AS));
+    EXPECT_TRUE(cs.contains(_KD));
+
+    EXPECT_THROW(HoleCards(_AS, _AS), std::runtime_error*);
+}
+
 TEST(CardSet, contains) {
     CardSet cs( { _JC, _8H, _4H, _AD, _AS });
     ASSERT_TRUE(cs.contains(_JC));
@@ -402,4 +575,202 @@ TEST(CardSet, rankTH_StraightFlush) {
 }
 
 
+TEST(CardSet, rankTH_Batch) {
+    // Odd count so that the scalar remainder is covered as well.
+    constexpr size_t count = 8 * 1000 + 13;
+    FastDeck deck;
+    std::vector<CardSet> hands;
+    for (size_t i = 0; i < count; ++i) {
+        deck.shuffle();
+        CardSet cs;
+        for (int c = 0; c < 7; ++c) {
+            cs.add(deck.deal());
+        }
+        hands.push_back(cs);
+    }
+    hands[0] = CardSet({_4H, _4S, _4D, _4C, _8H, _JC, _AC});
+    hands[1] = CardSet({_2D, _3D, _4D, _5D, _QS, _KD, _AD});
+    hands[2] = CardSet({_KD, _KH, _KS, _9C, _9H, _9D, _AD});
+    hands[3] = CardSet({_9C, _9D, _QD, _AH, _7H, _QC, _AD});
+    hands[4] = CardSet({_4S, _5S, _3H, _9H, _QH, _KH, _AH});
+    hands[5] = CardSet({_2H, _3H, _4D, _5D, _6H, _JC, _AC});
+    hands[6] = CardSet({_AC, _AD, _5D, _6D, _7D, _8D, _9D});
+
+    std::vector<HandRanking> batch(count);
+    CardSet::rankTexasHoldemBatch(hands.data(), batch.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(hands[i].rankTexasHoldem(), batch[i]) << "Hand " << i;
+    }
+}
+
+TEST(CardSet, rankFewerCards) {
+    EXPECT_EQ(HandRanking::FLUSH,
+            CardSet({_2D, _7D, _QD, _AD, _5D}).rank<5>().getRanking());
+    EXPECT_EQ(HandRanking::STRAIGHT,
+            CardSet({_AD, _2C, _3D, _4H, _5D, _5S}).rank<6>().getRanking());
+    EXPECT_EQ(CardSet({_KD, _KH, _KS, _9C, _9H}).rank<5>(),
+            CardSet({_KD, _KH, _KS, _9C, _9H, _2D}).rank<6>());
+    EXPECT_EQ(CardSet({_AC, _AD, _5D, _6D, _7D, _8D, _9D}).rankTexasHoldem(),
+            CardSet({_AC, _AD, _5D, _6D, _7D, _8D, _9D}).rank<7>());
+    EXPECT_THROW(CardSet({_2D, _7D, _QD, _AD}).rank<5>(),
+            std::runtime_error*);
+    EXPECT_THROW(CardSet({_2D, _7D, _QD, _AD, _5D}).rank<6>(),
+            std::runtime_error*);
+
+    // The best five of six or seven cards is their best five card subset,
+    // one by one and in batches.
+    constexpr size_t count = 1000 + 13;
+    FastDeck deck;
+    std::vector<CardSet> fives(count), sixes(count);
+    std::vector<HandRanking> best5(count), best6(count);
+    for (size_t i = 0; i < count; ++i) {
+        deck.shuffle();
+        Card cards[7];
+        deck.dealN(cards, 7);
+        HandRanking best;
+        for (int skip0 = 0; skip0 < 7; ++skip0) {
+            for (int skip1 = skip0 + 1; skip1 < 7; ++skip1) {
+                CardSet five;
+                for (int c = 0; c < 7; ++c) {
+                    if (c != skip0 && c != skip1) {
+                        five.add(cards[c]);
+                    }
+                }
+                best = std::max(best, five.rank<5>());
+            }
+        }
+        ASSERT_EQ(best, CardSet(cards).rank<7>());
+
+        fives[i] = CardSet(std::vector<Card>(cards, cards + 5));
+        sixes[i] = CardSet(std::vector<Card>(cards, cards + 6));
+        best5[i] = fives[i].rank<5>();
+        HandRanking six;
+        for (int skip = 0; skip < 6; ++skip) {
+            CardSet five = sixes[i];
+            five.remove(cards[skip]);
+            six = std::max(six, five.rank<5>());
+        }
+        best6[i] = sixes[i].rank<6>();
+        ASSERT_EQ(six, best6[i]);
+    }
+    std::vector<HandRanking> batch(count);
+    CardSet::rankBatch<5>(fives.data(), batch.data(), count);
+    EXPECT_EQ(best5, batch);
+    CardSet::rankBatch<6>(sixes.data(), batch.data(), count);
+    EXPECT_EQ(best6, batch);
+}
+
+namespace {
+
+std::vector<Card> allCards() {
+    std::vector<Card> cards;
+    for (uint8_t c = 0; c < 4; ++c) {
+        for (uint8_t r = 0; r < 13; ++r) {
+            cards.push_back(Card(static_cast<Rank>(r), static_cast<Color>(c)));
+        }
+    }
+    return cards;
+}
+
+}
+
+TEST(SuitPermutation, apply) {
+    CardSet cs( { _AS, _KS, _2D });
+    CardSet canonical;
+    SuitPermutation permutation;
+    std::tie(canonical, permutation) = cs.canonicalize();
+
+    EXPECT_EQ(Color::CLUBS, permutation.apply(Color::SPADES));
+    EXPECT_EQ(Color::DIAMONDS, permutation.apply(Color::DIAMONDS));
+    EXPECT_EQ(_KC, permutation.apply(_KS));
+    EXPECT_EQ(Color::SPADES, permutation.inverse().apply(Color::CLUBS));
+    EXPECT_FALSE(SuitPermutation() == permutation);
+    EXPECT_TRUE(permutation.inverse().inverse() == permutation);
+    EXPECT_THAT(canonical.toCardVector(), testing::ElementsAre(_KC, _AC, _2D));
+}
+
+TEST(CardSet, canonicalize) {
+    FastDeck deck;
+    for (int i = 0; i < 2000; ++i) {
+        deck.shuffle();
+        CardSet cs;
+        for (int c = 0; c < 7; ++c) {
+            cs.add(deck.deal());
+        }
+        CardSet canonical;
+        SuitPermutation permutation;
+        std::tie(canonical, permutation) = cs.canonicalize();
+
+        ASSERT_EQ(7, canonical.size());
+        ASSERT_EQ(cs.rankTexasHoldem(), canonical.rankTexasHoldem());
+        for (const Card& card : cs.toCardVector()) {
+            ASSERT_TRUE(canonical.contains(permutation.apply(card)));
+        }
+        ASSERT_EQ(canonical.cardBits(),
+                std::get<0>(canonical.canonicalize()).cardBits());
+        ASSERT_EQ(cs.cardBits(),
+                canonical.permute(permutation.inverse()).cardBits());
+    }
+}
+
+TEST(CardSet, canonicalFlops) {
+    std::vector<Card> cards = allCards();
+    std::map<uint64_t, uint32_t> classes;
+    std::map<uint64_t, uint32_t> multiplicities;
+    for (size_t a = 0; a < 52; ++a) {
+        for (size_t b = a + 1; b < 52; ++b) {
+            for (size_t c = b + 1; c < 52; ++c) {
+                CardSet flop( { cards[a], cards[b], cards[c] });
+                uint64_t key = std::get<0>(flop.canonicalize()).cardBits();
+                classes[key]++;
+                multiplicities[key] = flop.multiplicity();
+            }
+        }
+    }
+    ASSERT_EQ(1755, classes.size());
+    for (const auto& entry : classes) {
+        ASSERT_EQ(entry.second, multiplicities[entry.first]);
+    }
+}
+
+TEST(CardSet, canonicalizeWithSecondary) {
+    std::vector<Card> cards = allCards();
+    CardSet empty;
+    CardSet flop( { _7H, _7D, _2S });
+
+    std::map<uint64_t, uint32_t> preflop;
+    std::map<std::pair<uint64_t, uint64_t>, uint32_t> postflop;
+    std::map<std::pair<uint64_t, uint64_t>, uint32_t> multiplicities;
+    for (size_t a = 0; a < 52; ++a) {
+        for (size_t b = a + 1; b < 52; ++b) {
+            CardSet hole( { cards[a], cards[b] });
+            preflop[std::get<1>(empty.canonicalize(hole)).cardBits()]++;
+            if (flop.cardBits() & hole.cardBits()) {
+                continue;
+            }
+            CardSet canonical_flop, canonical_hole;
+            SuitPermutation permutation;
+            std::tie(canonical_flop, canonical_hole, permutation) =
+                    flop.canonicalize(hole);
+            ASSERT_EQ(std::get<0>(flop.canonicalize()).cardBits(),
+                    canonical_flop.cardBits());
+            std::pair<uint64_t, uint64_t> key(canonical_flop.cardBits(),
+                    canonical_hole.cardBits());
+            postflop[key]++;
+            multiplicities[key] = flop.multiplicity(hole);
+        }
+    }
+    ASSERT_EQ(169, preflop.size());
+
+    // Hearts and diamonds are interchangeable on this flop.
+    uint32_t combos = 0;
+    for (const auto& entry : postflop) {
+        ASSERT_EQ(entry.second * flop.multiplicity(),
+                multiplicities[entry.first]);
+        combos += entry.second;
+    }
+    ASSERT_EQ(49 * 48 / 2, combos);
+    ASSERT_EQ(12, flop.multiplicity());
+}
+
 } // namespace poker
@@ -0,0 +1,76 @@
+#include "CardSet.h"
+#include "CpuDispatch.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+class SimdLevelGuard {
+public:
+    SimdLevelGuard() : level(getSimdLevel()) {}
+    ~SimdLevelGuard() {
+        setSimdLevel(level);
+    }
+private:
+    SimdLevel level;
+};
+
+std::vector<CardSet> dealHands(size_t count) {
+    FastDeck deck;
+    std::vector<CardSet> hands;
+    for (size_t i = 0; i < count; ++i) {
+        deck.shuffle();
+        CardSet cs;
+        for (int c = 0; c < 7; ++c) {
+            cs.add(deck.deal());
+        }
+        hands.push_back(cs);
+    }
+    return hands;
+}
+
+}
+
+TEST(CpuDispatch, DetectedLevelIsActive) {
+    EXPECT_EQ(detectSimdLevel(), getSimdLevel());
+}
+
+TEST(CpuDispatch, SetUnsupportedLevel) {
+    SimdLevelGuard guard;
+    setSimdLevel(SimdLevel::SSE2);
+    EXPECT_EQ(SimdLevel::SSE2, getSimdLevel());
+    if (detectSimdLevel() != SimdLevel::AVX512) {
+        EXPECT_THROW(setSimdLevel(SimdLevel::AVX512), std::runtime_error*);
+    }
+}
+
+TEST(CpuDispatch, KernelsAgree) {
+    SimdLevelGuard guard;
+    constexpr size_t count = 16 * 500 + 11;
+    std::vector<CardSet> hands = dealHands(count);
+
+    setSimdLevel(SimdLevel::SSE2);
+    std::vector<HandRanking> expected;
+    for (const CardSet& hand : hands) {
+        expected.push_back(hand.rankTexasHoldem());
+    }
+
+    int max_level = static_cast<int>(detectSimdLevel());
+    for (int l = 0; l <= max_level; ++l) {
+        SimdLevel level = static_cast<SimdLevel>(l);
+        setSimdLevel(level);
+        std::vector<HandRanking> batch(count);
+        CardSet::rankTexasHoldemBatch(hands.data(), batch.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(expected[i], hands[i].rankTexasHoldem())
+                    << toString(level) << " hand " << i;
+            ASSERT_EQ(expected[i], batch[i])
+                    << toString(level) << " hand " << i;
+        }
+    }
+}
+
+} // namespace poker
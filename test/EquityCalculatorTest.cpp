@@ -0,0 +1,150 @@
+#include "EquityCalculator.h"
+#include "AllCards.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+TEST(EquityCalculator, PocketPairs) {
+    // Aces against kings without a shared suit, 81.26% by enumeration.
+    EquityCalculator calc( { HoleCards(_AC, _AD), HoleCards(_KH, _KS) });
+    calc.setMaxTrials(200000);
+    EquityResult result = calc.calculate();
+
+    ASSERT_EQ(200000, result.trials);
+    ASSERT_EQ(2, result.players.size());
+    EXPECT_NEAR(0.8126, result.players[0].equity, 0.005);
+    EXPECT_NEAR(0.1874, result.players[1].equity, 0.005);
+    EXPECT_NEAR(1.0, result.players[0].equity + result.players[1].equity,
+            1e-9);
+    EXPECT_GT(result.players[0].std_error, 0);
+    EXPECT_LT(result.players[0].std_error, 0.002);
+}
+
+TEST(EquityCalculator, CompleteBoard) {
+    EquityCalculator calc( { HoleCards(_AC, _AD), HoleCards(_KH, _KS),
+            HoleCards(_2C, _7D) }, CardSet( { _KC, _8H, _9S, _3D, _4C }));
+    calc.setMaxTrials(1000);
+    EquityResult result = calc.calculate();
+
+    EXPECT_DOUBLE_EQ(0, result.players[0].win);
+    EXPECT_DOUBLE_EQ(1, result.players[1].win);
+    EXPECT_DOUBLE_EQ(1, result.players[1].equity);
+    EXPECT_DOUBLE_EQ(0, result.players[1].std_error);
+    EXPECT_DOUBLE_EQ(0, result.players[2].equity);
+}
+
+TEST(EquityCalculator, SplitPot) {
+    // Everybody plays the royal flush on the board.
+    EquityCalculator calc( { HoleCards(_2C, _3D), HoleCards(_2H, _3S),
+            HoleCards(_4C, _4D), HoleCards(_7H, _7S) }, CardSet( { _AS, _KS,
+            _QS, _JS, _TS }));
+    calc.setMaxTrials(100);
+    EquityResult result = calc.calculate();
+
+    for (const PlayerEquity& player : result.players) {
+        EXPECT_DOUBLE_EQ(0, player.win);
+        EXPECT_DOUBLE_EQ(1, player.tie);
+        EXPECT_DOUBLE_EQ(0.25, player.equity);
+    }
+}
+
+TEST(EquityCalculator, DeadCards) {
+    // The flush draw has no outs left once the remaining spades are dead.
+    EquityCalculator calc( { HoleCards(_AS, _KS), HoleCards(_QH, _QD) },
+            CardSet( { _2S, _7S, _QC, _3H }), CardSet( { _3S, _4S, _5S, _6S,
+                    _8S, _9S, _TS, _JS, _QS }));
+    calc.setMaxTrials(5000);
+    EquityResult result = calc.calculate();
+
+    EXPECT_DOUBLE_EQ(0, result.players[0].equity);
+    EXPECT_DOUBLE_EQ(1, result.players[1].equity);
+}
+
+TEST(EquityCalculator, Reproducible) {
+    EquityCalculator calc( { HoleCards(_AC, _KC), HoleCards(_QH, _QS),
+            HoleCards(_7D, _8D) });
+    calc.setMaxTrials(50000);
+    calc.setThreads(3);
+    calc.setSeed(7);
+    EquityResult r1 = calc.calculate();
+    EquityResult r2 = calc.calculate();
+
+    ASSERT_EQ(50000, r1.trials);
+    for (size_t p = 0; p < 3; ++p) {
+        EXPECT_EQ(r1.players[p].win, r2.players[p].win);
+        EXPECT_EQ(r1.players[p].tie, r2.players[p].tie);
+        EXPECT_EQ(r1.players[p].equity, r2.players[p].equity);
+    }
+
+    // The same substreams of the seed, whatever the thread count.
+    calc.setThreads(1);
+    EquityResult r3 = calc.calculate();
+    for (size_t p = 0; p < 3; ++p) {
+        EXPECT_EQ(r1.players[p].equity, r3.players[p].equity);
+    }
+
+    calc.setSeed(8);
+    EquityResult r4 = calc.calculate();
+    EXPECT_NE(r1.players[0].equity, r4.players[0].equity);
+}
+
+TEST(EquityCalculator, EarlyStop) {
+    EquityCalculator calc( { HoleCards(_AC, _KC), HoleCards(_QH, _QS) });
+    calc.setMaxTrials(10000000);
+    calc.setThreads(2);
+    calc.setTargetStdError(0.005);
+    EquityResult result = calc.calculate();
+
+    EXPECT_LT(result.trials, 1000000);
+    for (const PlayerEquity& player : result.players) {
+        EXPECT_LE(player.std_error, 0.005);
+    }
+}
+
+TEST(EquityCalculator, EnumerateRiver) {
+    // Seven of the nine remaining spades win for the flush draw, the three
+    // and the queen of spades fill up the set.
+    EquityCalculator calc( { HoleCards(_AS, _KS), HoleCards(_QH, _QD) },
+            CardSet( { _2S, _7S, _QC, _3H }));
+    EquityResult result = calc.enumerate();
+
+    ASSERT_EQ(44, result.trials);
+    EXPECT_DOUBLE_EQ(7.0 / 44, result.players[0].equity);
+    EXPECT_DOUBLE_EQ(37.0 / 44, result.players[1].win);
+    EXPECT_DOUBLE_EQ(0, result.players[1].std_error);
+}
+
+TEST(EquityCalculator, EnumeratePreflop) {
+    EquityCalculator calc( { HoleCards(_AC, _AD), HoleCards(_KH, _KS) });
+    calc.setThreads(1);
+    EquityResult r1 = calc.enumerate();
+    calc.setThreads(3);
+    EquityResult r3 = calc.enumerate();
+
+    ASSERT_EQ(1712304, r1.trials);
+    ASSERT_EQ(1712304, r3.trials);
+    EXPECT_NEAR(0.812555, r1.players[0].equity, 1e-6);
+    for (size_t p = 0; p < 2; ++p) {
+        EXPECT_EQ(r1.players[p].win, r3.players[p].win);
+        EXPECT_EQ(r1.players[p].tie, r3.players[p].tie);
+        EXPECT_EQ(r1.players[p].equity, r3.players[p].equity);
+    }
+}
+
+TEST(EquityCalculator, InvalidInput) {
+    EXPECT_THROW(EquityCalculator( { HoleCards(_AC, _KC) }),
+            std::runtime_error*);
+    EXPECT_THROW(EquityCalculator( { HoleCards(_AC, _KC), HoleCards(_AC,
+            _QS) }), std::runtime_error*);
+    EXPECT_THROW(EquityCalculator( { HoleCards(_AC, _KC), HoleCards(_QH,
+            _QS) }, CardSet( { _QS })), std::runtime_error*);
+    EXPECT_THROW(EquityCalculator( { HoleCards(_AC, _KC), HoleCards(_QH,
+            _QS) }, CardSet(), CardSet( { _KC })), std::runtime_error*);
+    EXPECT_THROW(EquityCalculator( { HoleCards(_AC, _KC), HoleCards(_QH,
+            _QS) }, CardSet( { _2C, _3C, _4C, _5C, _6C, _7C })),
+            std::runtime_error*);
+}
+
+}
@@ -0,0 +1,86 @@
+#include "FlopEquity.h"
+#include "RangeEquityCalculator.h"
+#include "AllCards.h"
+
+#include <set>
+#include <stdexcept>
+
+#include <string.h>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+// Equity of the hand against the range by RangeEquityCalculator.
+EquityResult expected(const HoleCards& hand, const Range& range,
+        const CardSet& flop) {
+    Range single;
+    single.setWeight(hand, 1);
+    return RangeEquityCalculator( { single, range }, flop).enumerate();
+}
+
+}
+
+TEST(FlopEquity, CanonicalFlops) {
+    std::vector<CardSet> flops = FlopEquity::canonicalFlops();
+    ASSERT_EQ(FlopEquity::FLOPS, flops.size());
+    std::set<uint64_t> distinct;
+    for (const CardSet& flop : flops) {
+        EXPECT_EQ(3, flop.size());
+        EXPECT_EQ(flop.cardBits(),
+                std::get<0>(flop.canonicalize()).cardBits());
+        distinct.insert(flop.cardBits());
+    }
+    EXPECT_EQ(FlopEquity::FLOPS, distinct.size());
+}
+
+TEST(FlopEquity, Equity) {
+    CardSet flop( { _2C, _7D, _KD });
+    FlopEquity table(flop, FlopEquity::generate(flop));
+    Range range = Range::parse("QQ+, AK, KQs, 98s, 77:0.5, ThTc:0.25");
+    for (HoleCards hand : { HoleCards(_AS, _KS), HoleCards(_QD, _JD),
+            HoleCards(_7C, _7S), HoleCards(_3H, _2H) }) {
+        EquityResult result = table.equity(hand, range);
+        EquityResult reference = expected(hand, range, flop);
+        ASSERT_EQ(2, result.players.size());
+        for (int p = 0; p < 2; ++p) {
+            EXPECT_NEAR(reference.players[p].win, result.players[p].win,
+                    1e-9);
+            EXPECT_NEAR(reference.players[p].tie, result.players[p].tie,
+                    1e-9);
+            EXPECT_NEAR(reference.players[p].equity,
+                    result.players[p].equity, 1e-9);
+        }
+    }
+
+    EXPECT_THROW(table.equity(HoleCards(_KD, _AS), range),
+            std::runtime_error*);
+    EXPECT_THROW(table.equity(HoleCards(_AS, _AH), Range::parse("2c7d")),
+            std::runtime_error*);
+}
+
+// Other suits of the flop share the table of the canonical one.
+TEST(FlopEquity, SuitPermutation) {
+    CardSet flop( { _2C, _7D, _KD });
+    CardSet other( { _2S, _7H, _KH });
+    TableData data = FlopEquity::generate(flop);
+    FlopEquity table(other, TableData::generate(data.size(),
+            [&](void* payload) {
+                memcpy(payload, data.data(), data.size());
+            }));
+    Range range = Range::parse("KQ, 77, 98s, AhQh");
+    HoleCards hand(_AH, _JH);
+    EquityResult result = table.equity(hand, range);
+    EXPECT_NEAR(expected(hand, range, other).players[0].equity,
+            result.players[0].equity, 1e-9);
+    EXPECT_EQ(FlopEquity::RUNOUTS * Range::COMBOS * sizeof(HandRankIndex),
+            data.size());
+
+    EXPECT_THROW(FlopEquity(CardSet( { _2C, _7D }), std::move(data)),
+            std::runtime_error*);
+}
+
+} /* namespace poker */
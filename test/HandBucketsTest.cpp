@@ -0,0 +1,146 @@
+#include "HandBuckets.h"
+#include "AllCards.h"
+
+#include <set>
+#include <stdexcept>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+const std::vector<CardSet> TURNS = {
+    CardSet( { _9H, _8H, _2C, _KS }),
+    CardSet( { _AS, _AD, _7C, _3H }),
+};
+
+HandBuckets::Config config(HandBuckets::Metric metric) {
+    HandBuckets::Config config;
+    config.buckets = 6;
+    config.metric = metric;
+    return config;
+}
+
+// The card with clubs and hearts, and diamonds and spades, swapped.
+Card swapSuits(Card card) {
+    static const Color swapped[] = { Color::HEARTS, Color::SPADES,
+            Color::CLUBS, Color::DIAMONDS };
+    return Card(card.getRank(), swapped[static_cast<int>(card.getColor())]);
+}
+
+CardSet swapSuits(const CardSet& cards) {
+    CardSet result;
+    for (Card card : cards.toCardVector()) {
+        result.add(swapSuits(card));
+    }
+    return result;
+}
+
+}
+
+TEST(HandBuckets, CanonicalBoards) {
+    std::vector<CardSet> flops = HandBuckets::canonicalBoards(3);
+    EXPECT_EQ(1755, flops.size());
+    EXPECT_EQ(16432, HandBuckets::canonicalBoards(4).size());
+    for (size_t i = 1; i < flops.size(); ++i) {
+        EXPECT_LT(flops[i - 1].cardBits(), flops[i].cardBits());
+    }
+    EXPECT_THROW(HandBuckets::canonicalBoards(6), std::runtime_error*);
+}
+
+TEST(HandBuckets, Build) {
+    for (HandBuckets::Metric metric : { HandBuckets::Metric::FEATURES,
+            HandBuckets::Metric::EARTH_MOVER }) {
+        HandBuckets buckets(HandBuckets::build(TURNS, config(metric)));
+        EXPECT_EQ(4, buckets.getBoardCards());
+        EXPECT_EQ(2, buckets.getBoardCount());
+        EXPECT_EQ(6, buckets.getBucketCount());
+
+        std::set<uint16_t> used;
+        for (const CardSet& turn : TURNS) {
+            for (size_t c = 0; c < Range::COMBOS; ++c) {
+                HoleCards hole = Range::combo(c);
+                if (hole.toCardSet().cardBits() & turn.cardBits()) {
+                    continue;
+                }
+                uint16_t bucket = buckets.getBucket(hole, turn);
+                ASSERT_LT(bucket, 6);
+                used.insert(bucket);
+                // The same hand in other suits.
+                HoleCards swapped(swapSuits(hole.getFirst()),
+                        swapSuits(hole.getSecond()));
+                EXPECT_EQ(buckets.getHandIndex(hole, turn),
+                        buckets.getHandIndex(swapped, swapSuits(turn)));
+            }
+        }
+        EXPECT_EQ(6, used.size());
+
+        // Buckets ascend with the hand strength.
+        const CardSet& turn = TURNS[0];
+        EXPECT_EQ(5, buckets.getBucket(HoleCards(_KC, _KD), turn));
+        EXPECT_EQ(0, buckets.getBucket(HoleCards(_4C, _3D), turn));
+        EXPECT_LT(buckets.getBucket(HoleCards(_AH, _4H), turn), 5);
+    }
+}
+
+TEST(HandBuckets, Deterministic) {
+    HandBuckets::Config earth_mover = config(
+            HandBuckets::Metric::EARTH_MOVER);
+    TableData first = HandBuckets::build(TURNS, earth_mover);
+    TableData second = HandBuckets::build( { TURNS[1], TURNS[0] },
+            earth_mover);
+    ASSERT_EQ(first.size(), second.size());
+    EXPECT_EQ(0, memcmp(first.data(), second.data(), first.size()));
+}
+
+TEST(HandBuckets, TableFile) {
+    char dir[] = "/tmp/hand_buckets_testXXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(dir));
+    std::string path = std::string(dir) + "/buckets.tbl";
+    TableData built = HandBuckets::build(TURNS,
+            config(HandBuckets::Metric::FEATURES));
+    TableData::write(path, HandBuckets::TABLE_NAME, HandBuckets::VERSION,
+            built.data(), built.size());
+    HandBuckets expected(std::move(built));
+    HandBuckets mapped(TableData::map(path, HandBuckets::TABLE_NAME,
+            HandBuckets::VERSION));
+    unlink(path.c_str());
+    rmdir(dir);
+
+    for (size_t c = 0; c < Range::COMBOS; ++c) {
+        HoleCards hole = Range::combo(c);
+        if (hole.toCardSet().cardBits() & TURNS[1].cardBits()) {
+            continue;
+        }
+        EXPECT_EQ(expected.getBucket(hole, TURNS[1]),
+                mapped.getBucket(hole, TURNS[1]));
+    }
+}
+
+TEST(HandBuckets, InvalidInput) {
+    HandBuckets::Config features = config(HandBuckets::Metric::FEATURES);
+    HandBuckets buckets(HandBuckets::build( { TURNS[0] }, features));
+    EXPECT_THROW(buckets.getBucket(HoleCards(_AC, _AD), TURNS[1]),
+            std::runtime_error*);
+    EXPECT_THROW(buckets.getBucket(HoleCards(_AC, _AD),
+            CardSet( { _9H, _8H, _2C })), std::runtime_error*);
+    EXPECT_THROW(buckets.getBucket(HoleCards(_9H, _AD), TURNS[0]),
+            std::runtime_error*);
+
+    EXPECT_THROW(HandBuckets::build( { }, features), std::runtime_error*);
+    EXPECT_THROW(HandBuckets::build( { TURNS[0], CardSet( { _9H, _8H, _2C }) },
+            features), std::runtime_error*);
+    features.buckets = 0;
+    EXPECT_THROW(HandBuckets::build(TURNS, features), std::runtime_error*);
+
+    EXPECT_THROW(HandBuckets(TableData::generate(8, [](void*) {
+    })), std::runtime_error*);
+}
+
+} /* namespace poker */
@@ -0,0 +1,159 @@
+#include "HandFeatures.h"
+#include "AllCards.h"
+
+#include <stdexcept>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+// Features of one hand on a turn board by comparing it with every opponent
+// on every river.
+HandFeatures bruteForce(const HoleCards& hole, const CardSet& turn) {
+    CardSet hand = turn;
+    hand.add(hole.getFirst());
+    hand.add(hole.getSecond());
+    double potential[3][3] = { };
+    double runouts = 0;
+    HandFeatures features;
+    for (size_t r = 0; r < 52; ++r) {
+        Card river_card(static_cast<Rank>(r % 13), static_cast<Color>(r / 13));
+        if (hand.contains(river_card)) {
+            continue;
+        }
+        CardSet river = turn;
+        river.add(river_card);
+        CardSet own = hand;
+        own.add(river_card);
+        HandRanking own_now = hand.rank<6>();
+        HandRanking own_river = own.rankTexasHoldem();
+        double wins = 0;
+        double ties = 0;
+        double count = 0;
+        for (size_t c = 0; c < Range::COMBOS; ++c) {
+            const CardSet& combo = Range::comboCards(c);
+            if (combo.cardBits() & own.cardBits()) {
+                continue;
+            }
+            CardSet other_now = turn;
+            other_now.addAll(combo);
+            CardSet other_river = river;
+            other_river.addAll(combo);
+            HandRanking now = other_now.rank<6>();
+            HandRanking later = other_river.rankTexasHoldem();
+            int n = own_now > now ? 0 : own_now == now ? 1 : 2;
+            int l = own_river > later ? 0 : own_river == later ? 1 : 2;
+            potential[n][l]++;
+            wins += l == 0;
+            ties += l == 1;
+            count++;
+        }
+        double strength = (wins + ties / 2) / count;
+        features.ehs += strength;
+        features.ehs2 += strength * strength;
+        features.histogram[std::min<size_t>(strength * 10, 9)]++;
+        runouts++;
+    }
+    features.ehs /= runouts;
+    features.ehs2 /= runouts;
+    for (float& bin : features.histogram) {
+        bin /= runouts;
+    }
+    double now[3] = { };
+    for (int n = 0; n < 3; ++n) {
+        for (int l = 0; l < 3; ++l) {
+            now[n] += potential[n][l];
+        }
+    }
+    features.strength = (now[0] + now[1] / 2) / (now[0] + now[1] + now[2]);
+    if (now[2] + now[1] > 0) {
+        features.ppot = (potential[2][0] + potential[2][1] / 2
+                + potential[1][0] / 2) / (now[2] + now[1] / 2);
+    }
+    if (now[0] + now[1] > 0) {
+        features.npot = (potential[0][2] + potential[1][2] / 2
+                + potential[0][1] / 2) / (now[0] + now[1] / 2);
+    }
+    return features;
+}
+
+}
+
+TEST(HandFeatures, Turn) {
+    CardSet turn( { _9H, _8H, _2C, _KS });
+    std::vector<HandFeatures> features = HandFeatures::compute(turn);
+    ASSERT_EQ(1326, features.size());
+    EXPECT_EQ(0, features[Range::comboIndex(_9H, _AC)].ehs);
+    for (HoleCards hole : { HoleCards(_AH, _4H), HoleCards(_KC, _KD),
+            HoleCards(_TC, _JD), HoleCards(_3D, _2D), HoleCards(_9C, _8C) }) {
+        HandFeatures expected = bruteForce(hole, turn);
+        const HandFeatures& result = features[Range::comboIndex(
+                hole.getFirst(), hole.getSecond())];
+        EXPECT_NEAR(expected.strength, result.strength, 1e-12);
+        EXPECT_NEAR(expected.ehs, result.ehs, 1e-12);
+        EXPECT_NEAR(expected.ehs2, result.ehs2, 1e-12);
+        EXPECT_NEAR(expected.ppot, result.ppot, 1e-12);
+        EXPECT_NEAR(expected.npot, result.npot, 1e-12);
+        for (size_t b = 0; b < HandFeatures::HISTOGRAM_BINS; ++b) {
+            EXPECT_NEAR(expected.histogram[b], result.histogram[b], 1e-6);
+        }
+    }
+    // Draws have potential, a set has little to lose.
+    const HandFeatures& flush_draw = features[Range::comboIndex(_AH, _4H)];
+    const HandFeatures& set = features[Range::comboIndex(_KC, _KD)];
+    EXPECT_GT(flush_draw.ppot, 0.15);
+    EXPECT_GT(flush_draw.ehs, flush_draw.strength);
+    EXPECT_LT(set.npot, 0.1);
+    EXPECT_GT(set.ehs2, flush_draw.ehs2);
+}
+
+TEST(HandFeatures, River) {
+    CardSet river( { _AH, _KH, _QH, _JH, _2C });
+    std::vector<HandFeatures> features = HandFeatures::compute(river);
+    const HandFeatures& royal = features[Range::comboIndex(_TH, _3D)];
+    EXPECT_EQ(1, royal.strength);
+    EXPECT_EQ(1, royal.ehs);
+    EXPECT_EQ(1, royal.histogram[HandFeatures::HISTOGRAM_BINS - 1]);
+    for (size_t c = 0; c < Range::COMBOS; ++c) {
+        if (Range::comboCards(c).cardBits() & river.cardBits()) {
+            continue;
+        }
+        EXPECT_NEAR(features[c].strength, features[c].ehs, 1e-12);
+        EXPECT_NEAR(features[c].ehs * features[c].ehs, features[c].ehs2,
+                1e-12);
+        EXPECT_EQ(0, features[c].ppot);
+        EXPECT_EQ(0, features[c].npot);
+    }
+    EXPECT_THROW(HandFeatures::compute(CardSet( { _AH, _KH })),
+            std::runtime_error*);
+}
+
+TEST(HandFeatures, Flop) {
+    CardSet flop( { _JS, _TS, _4D });
+    std::vector<HandFeatures> features = HandFeatures::compute(flop);
+    double sum = 0;
+    for (size_t c = 0; c < Range::COMBOS; ++c) {
+        if (Range::comboCards(c).cardBits() & flop.cardBits()) {
+            EXPECT_EQ(0, features[c].ehs);
+            continue;
+        }
+        float histogram = 0;
+        for (float bin : features[c].histogram) {
+            histogram += bin;
+        }
+        EXPECT_NEAR(1, histogram, 1e-5);
+        EXPECT_GE(features[c].ehs2, features[c].ehs * features[c].ehs);
+        sum += features[c].ehs;
+    }
+    // Against a random hand, the hands on average have even equity.
+    EXPECT_NEAR(0.5, sum / 1176, 1e-9);
+    const HandFeatures& open_ended = features[Range::comboIndex(_QH, _9C)];
+    const HandFeatures& pair = features[Range::comboIndex(_JD, _2C)];
+    EXPECT_GT(open_ended.ppot, pair.ppot);
+    EXPECT_GT(pair.strength, open_ended.strength);
+}
+
+} /* namespace poker */
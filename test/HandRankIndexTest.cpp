@@ -0,0 +1,84 @@
+#include "HandRankIndex.h"
+#include "IncrementalEvaluator.h"
+#include "AllCards.h"
+
+#include <set>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+// Conversions in constant expressions.
+static_assert(HandRankIndex(HandRankIndex(0).toHandRanking()).getIndex() == 0,
+        "Lowest class");
+static_assert(HandRankIndex(HandRankIndex(HandRankIndex::COUNT - 1)
+        .toHandRanking()).getIndex() == HandRankIndex::COUNT - 1,
+        "Highest class");
+static_assert(HandRankIndex(4000).toHandRanking().getRanking()
+        == HandRanking::ONE_PAIR, "Category of a class");
+
+TEST(HandRankIndex, AllClasses) {
+    std::vector<Card> deck = CardSet::fullDeck().toCardVector();
+    std::set<HandRanking> rankings;
+    for (size_t a = 0; a < deck.size(); ++a) {
+        for (size_t b = a + 1; b < deck.size(); ++b) {
+            for (size_t c = b + 1; c < deck.size(); ++c) {
+                for (size_t d = c + 1; d < deck.size(); ++d) {
+                    for (size_t e = d + 1; e < deck.size(); ++e) {
+                        CardSet hand( { deck[a], deck[b], deck[c], deck[d],
+                                deck[e] });
+                        rankings.insert(IncrementalEvaluator(hand).rank());
+                    }
+                }
+            }
+        }
+    }
+    ASSERT_EQ(HandRankIndex::COUNT, rankings.size());
+
+    std::vector<HandRanking> sorted(rankings.begin(), rankings.end());
+    std::vector<HandRankIndex> indexes(sorted.size());
+    std::vector<HandRanking> back(sorted.size());
+    HandRankIndex::fromHandRankings(sorted.data(), indexes.data(),
+            sorted.size());
+    HandRankIndex::toHandRankings(indexes.data(), back.data(), sorted.size());
+    for (uint16_t i = 0; i < HandRankIndex::COUNT; ++i) {
+        ASSERT_EQ(i, HandRankIndex(sorted[i]).getIndex());
+        ASSERT_EQ(sorted[i], HandRankIndex(i).toHandRanking());
+        ASSERT_EQ(i, indexes[i].getIndex());
+        ASSERT_EQ(sorted[i], back[i]);
+    }
+}
+
+TEST(HandRankIndex, SevenCards) {
+    FastDeck deck(17);
+    HandRanking rankings[1000];
+    HandRankIndex indexes[1000];
+    for (HandRanking& ranking : rankings) {
+        deck.shuffle();
+        Card cards[7];
+        deck.dealN(cards, 7);
+        ranking = CardSet(cards).rankTexasHoldem();
+    }
+    HandRankIndex::fromHandRankings(rankings, indexes, 1000);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(HandRankIndex(rankings[i]), indexes[i]);
+        EXPECT_EQ(rankings[i], indexes[i].toHandRanking());
+        if (i > 0) {
+            EXPECT_EQ(rankings[i - 1] < rankings[i],
+                    indexes[i - 1] < indexes[i]);
+            EXPECT_EQ(rankings[i - 1] == rankings[i],
+                    indexes[i - 1] == indexes[i]);
+        }
+    }
+}
+
+TEST(HandRankIndex, Extremes) {
+    EXPECT_EQ(0, HandRankIndex(IncrementalEvaluator(CardSet( { _7C, _5D, _4H,
+            _3S, _2C })).rank()).getIndex());
+    EXPECT_EQ(HandRankIndex::COUNT - 1, HandRankIndex(CardSet( { _AS, _KS,
+            _QS, _JS, _TS, _2C, _2D }).rankTexasHoldem()).getIndex());
+}
+
+}
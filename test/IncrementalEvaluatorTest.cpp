@@ -0,0 +1,176 @@
+#include "IncrementalEvaluator.h"
+#include "CpuDispatch.h"
+#include "AllCards.h"
+
+#include <algorithm>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+// Best ranking among all five card subsets of the cards.
+HandRanking bestFive(const std::vector<Card>& cards) {
+    HandRanking best;
+    std::vector<bool> picked(cards.size(), false);
+    std::fill(picked.begin(), picked.begin() + 5, true);
+    do {
+        std::vector<Card> five;
+        for (size_t i = 0; i < cards.size(); ++i) {
+            if (picked[i]) {
+                five.push_back(cards[i]);
+            }
+        }
+        best = std::max(best, IncrementalEvaluator(CardSet(five)).rank());
+    } while (std::prev_permutation(picked.begin(), picked.end()));
+    return best;
+}
+
+std::vector<Card> deal(FastDeck& deck, size_t n) {
+    std::vector<Card> cards;
+    deck.shuffle();
+    for (size_t i = 0; i < n; ++i) {
+        cards.push_back(deck.deal());
+    }
+    return cards;
+}
+
+}
+
+TEST(IncrementalEvaluator, FiveCards) {
+    typedef HandRanking HR;
+    EXPECT_EQ(HR::HIGH_CARD, IncrementalEvaluator(CardSet( { _AS, _KD, _QC,
+            _JH, _9S })).rank().getRanking());
+    EXPECT_EQ(HR::STRAIGHT, IncrementalEvaluator(CardSet( { _AS, _2D, _3C,
+            _4H, _5S })).rank().getRanking());
+    EXPECT_EQ(HR::FOUR_OF_A_KIND, IncrementalEvaluator(CardSet( { _7S, _7D,
+            _7C, _7H, _5S })).rank().getRanking());
+
+    // All five cards count, where seven card ranking would drop two.
+    IncrementalEvaluator nine_high(CardSet( { _AS, _KD, _QC, _JH, _9S }));
+    IncrementalEvaluator eight_high(CardSet( { _AS, _KD, _QC, _JH, _8S }));
+    EXPECT_GT(nine_high.rank(), eight_high.rank());
+    IncrementalEvaluator three_kicker(CardSet( { _AS, _AD, _QC, _JH, _3S }));
+    IncrementalEvaluator deuce_kicker(CardSet( { _AS, _AD, _QC, _JH, _2S }));
+    EXPECT_GT(three_kicker.rank(), deuce_kicker.rank());
+}
+
+TEST(IncrementalEvaluator, BestOfSubsets) {
+    FastDeck deck(7);
+    for (int i = 0; i < 2000; ++i) {
+        std::vector<Card> cards = deal(deck, 6 + i % 2);
+        HandRanking expected = bestFive(cards);
+        IncrementalEvaluator evaluator((CardSet(cards)));
+        ASSERT_EQ(expected, evaluator.rank()) << "Hand " << i;
+        if (cards.size() == 7) {
+            ASSERT_EQ(expected, CardSet(cards).rankTexasHoldem());
+        }
+    }
+}
+
+TEST(IncrementalEvaluator, Streets) {
+    FastDeck deck(11);
+    for (int i = 0; i < 200; ++i) {
+        std::vector<Card> cards = deal(deck, 7);
+        IncrementalEvaluator evaluator(HoleCards(cards[0], cards[1]));
+        for (size_t c = 2; c < 7; ++c) {
+            evaluator.push(cards[c]);
+        }
+        ASSERT_EQ(7, evaluator.size());
+        ASSERT_EQ(CardSet(cards).rankTexasHoldem(), evaluator.rank());
+
+        // Back to the turn and a different river.
+        evaluator.pop();
+        ASSERT_EQ(6, evaluator.size());
+        Card river = deck.deal();
+        std::vector<Card> other(cards.begin(), cards.end() - 1);
+        other.push_back(river);
+        ASSERT_EQ(CardSet(other).rankTexasHoldem(), evaluator.rankWith(river));
+        evaluator.push(river);
+        ASSERT_EQ(CardSet(other).rankTexasHoldem(), evaluator.rank());
+    }
+}
+
+TEST(IncrementalEvaluator, RankWithRemaining) {
+    CardSet dead( { _AS, _KS });
+    IncrementalEvaluator evaluator(HoleCards(_QH, _QD));
+    evaluator.push(_2C);
+    evaluator.push(_7S);
+    evaluator.push(_QC);
+
+    std::vector<Card> next;
+    std::vector<HandRanking> rankings;
+    evaluator.rankWithRemaining(dead, next, rankings);
+    ASSERT_EQ(45, next.size());
+    ASSERT_EQ(45, rankings.size());
+    for (size_t i = 0; i < next.size(); ++i) {
+        EXPECT_FALSE(dead.contains(next[i]));
+        EXPECT_FALSE(evaluator.getCards().contains(next[i]));
+        if (i > 0) {
+            EXPECT_LT(next[i - 1].getValue(), next[i].getValue());
+        }
+        std::vector<Card> cards = evaluator.getCards().toCardVector();
+        cards.push_back(next[i]);
+        EXPECT_EQ(bestFive(cards), rankings[i]);
+    }
+
+    // Every river on the turn, on all kernels.
+    evaluator.push(_3D);
+    SimdLevel previous = getSimdLevel();
+    for (int level = 0; level <= static_cast<int>(detectSimdLevel()); ++level) {
+        setSimdLevel(static_cast<SimdLevel>(level));
+        evaluator.rankWithRemaining(dead, next, rankings);
+        ASSERT_EQ(44, next.size());
+        for (size_t i = 0; i < next.size(); ++i) {
+            CardSet hand = evaluator.getCards();
+            hand.add(next[i]);
+            EXPECT_EQ(hand.rankTexasHoldem(), rankings[i]);
+        }
+    }
+    setSimdLevel(previous);
+}
+
+TEST(IncrementalEvaluator, RankWithEachFlushColor) {
+    // Four and five hearts, and random hands, most without a flush color.
+    std::vector<std::vector<Card>> hands = { { _AH, _9H, _2H, _KH },
+            { _AH, _9H, _2H, _KH, _KC }, { _3H, _4H, _5H, _6H, _KC },
+            { _AH, _9H, _2H, _KH, _7H }, { _AH, _9H, _2H, _KH, _7H, _8H } };
+    FastDeck deck(5);
+    for (int i = 0; i < 300; ++i) {
+        hands.push_back(deal(deck, 4 + i % 3));
+    }
+    std::vector<Card> next;
+    std::vector<HandRanking> rankings;
+    HandRanking each[Card::COUNT];
+    for (size_t h = 0; h < hands.size(); ++h) {
+        IncrementalEvaluator evaluator((CardSet(hands[h])));
+        evaluator.rankWithRemaining(CardSet(), next, rankings);
+        ASSERT_EQ(Card::COUNT - hands[h].size(), next.size());
+        evaluator.rankWithEach(next.data(), next.size(), each);
+        for (size_t i = 0; i < next.size(); ++i) {
+            ASSERT_EQ(evaluator.rankWith(next[i]), rankings[i]) << "Hand "
+                    << h << " with " << next[i].toString();
+            ASSERT_EQ(rankings[i], each[i]);
+        }
+    }
+}
+
+#ifdef CARD_CHECKS
+TEST(IncrementalEvaluator, Checks) {
+    IncrementalEvaluator evaluator(HoleCards(_QH, _QD));
+    EXPECT_THROW(evaluator.push(_QH), std::runtime_error*);
+    EXPECT_THROW(evaluator.rank(), std::runtime_error*);
+    for (Card c : { _2C, _3C, _4C, _5C, _6C }) {
+        evaluator.push(c);
+    }
+    EXPECT_THROW(evaluator.push(_7C), std::runtime_error*);
+    for (int i = 0; i < 5; ++i) {
+        evaluator.pop();
+    }
+    EXPECT_THROW(evaluator.pop(), std::runtime_error*);
+}
+#endif
+
+}
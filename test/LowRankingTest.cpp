@@ -0,0 +1,207 @@
+#include "CardSet.h"
+#include "OmahaBoard.h"
+#include "AllCards.h"
+
+#include <algorithm>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+// Five cards as a high hand: the category followed by the ranks that break
+// ties, to be compared lexicographically. A-5 lows rank aces low and ignore
+// straights and flushes; 2-7 lows know no straight A-2-3-4-5.
+std::vector<int> highKey(const std::vector<Card>& five, bool ace_low) {
+    int counts[13] = { };
+    bool flush = !ace_low;
+    for (const Card& card : five) {
+        int rank = static_cast<int>(card.getRank());
+        counts[ace_low ? (rank + 1) % 13 : rank]++;
+        flush &= card.getColor() == five[0].getColor();
+    }
+    std::vector<std::pair<int, int>> groups;
+    for (int r = 12; r >= 0; --r) {
+        if (counts[r]) {
+            groups.push_back(std::make_pair(counts[r], r));
+        }
+    }
+    std::stable_sort(groups.begin(), groups.end(),
+            [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                return a.first > b.first;
+            });
+    std::vector<int> key;
+    bool straight = !ace_low && groups.size() == 5
+            && groups[0].second - groups[4].second == 4;
+    int category = groups[0].first == 4 ? 7 :
+            groups[0].first == 3 ? (groups[1].first == 2 ? 6 : 3) :
+            groups[0].first == 2 ? (groups[1].first == 2 ? 2 : 1) : 0;
+    if (straight) {
+        category = flush ? 8 : 4;
+    } else if (flush) {
+        category = 5;
+    }
+    key.push_back(category);
+    for (const auto& group : groups) {
+        key.push_back(group.second);
+    }
+    return key;
+}
+
+// The lowest A-5 hand of any five of the cards.
+std::vector<int> referenceA5(const std::vector<Card>& cards) {
+    std::vector<int> best;
+    std::vector<bool> picked(cards.size(), false);
+    std::fill(picked.begin(), picked.begin() + 5, true);
+    do {
+        std::vector<Card> five;
+        for (size_t i = 0; i < cards.size(); ++i) {
+            if (picked[i]) {
+                five.push_back(cards[i]);
+            }
+        }
+        std::vector<int> key = highKey(five, true);
+        if (best.empty() || key < best) {
+            best = key;
+        }
+    } while (std::prev_permutation(picked.begin(), picked.end()));
+    return best;
+}
+
+// Sorts the hands by the reference keys, worst low first, and expects the
+// same order of the rankings.
+template<typename Key>
+void expectSameOrder(const std::vector<Key>& keys,
+        const std::vector<LowRanking>& rankings) {
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return keys[b] < keys[a];
+    });
+    for (size_t i = 1; i < order.size(); ++i) {
+        size_t a = order[i - 1], b = order[i];
+        if (keys[a] == keys[b]) {
+            ASSERT_EQ(rankings[a], rankings[b]);
+        } else {
+            ASSERT_LT(rankings[a], rankings[b]);
+        }
+    }
+}
+
+}
+
+TEST(LowRanking, A5) {
+    LowRanking wheel = CardSet( { _AS, _2S, _3S, _4S, _5S }).rankLowA5();
+    LowRanking six = CardSet( { _AS, _2D, _3S, _4C, _6S, _KD, _KH })
+            .rankLowA5();
+    LowRanking eight = CardSet( { _8S, _2D, _3S, _4C, _6S }).rankLowA5();
+    LowRanking nine = CardSet( { _AS, _2D, _3S, _4C, _9S, _9D }).rankLowA5();
+    LowRanking pair = CardSet( { _AS, _AD, _2S, _3C, _4S, _4D, _2D })
+            .rankLowA5();
+    EXPECT_GT(wheel, six);
+    EXPECT_GT(six, eight);
+    EXPECT_GT(eight, nine);
+    EXPECT_GT(nine, pair);
+    EXPECT_GT(pair, LowRanking());
+    EXPECT_EQ(HandRanking::HIGH_CARD, wheel.getRanking());
+    EXPECT_EQ(HandRanking::ONE_PAIR, pair.getRanking());
+    EXPECT_TRUE(wheel.isEightOrBetter());
+    EXPECT_TRUE(eight.isEightOrBetter());
+    EXPECT_FALSE(nine.isEightOrBetter());
+    EXPECT_FALSE(pair.isEightOrBetter());
+    EXPECT_FALSE(LowRanking().isEightOrBetter());
+    EXPECT_THROW(CardSet( { _AS, _2S, _3S, _4S }).rankLowA5(),
+            std::runtime_error*);
+}
+
+TEST(LowRanking, Low27) {
+    LowRanking best = CardSet( { _2S, _3D, _4S, _5C, _7S }).rankLow27();
+    LowRanking eight = CardSet( { _2S, _3D, _4S, _5C, _8S }).rankLow27();
+    LowRanking straight = CardSet( { _2S, _3D, _4S, _5C, _6S }).rankLow27();
+    LowRanking flush = CardSet( { _2S, _3S, _4S, _5S, _7S }).rankLow27();
+    LowRanking ace = CardSet( { _AS, _2D, _3S, _4C, _5S }).rankLow27();
+    LowRanking king = CardSet( { _KS, _2D, _3S, _4C, _5S }).rankLow27();
+    LowRanking ace_flush = CardSet( { _AS, _2S, _3S, _4S, _5S }).rankLow27();
+    EXPECT_GT(best, eight);
+    EXPECT_GT(eight, king);
+    EXPECT_GT(king, ace);
+    EXPECT_GT(ace, straight);
+    EXPECT_GT(straight, flush);
+    EXPECT_EQ(HandRanking::HIGH_CARD, ace.getRanking());
+    EXPECT_EQ(HandRanking::FLUSH, ace_flush.getRanking());
+    EXPECT_GT(flush, ace_flush);
+    EXPECT_FALSE(best.isEightOrBetter());
+}
+
+TEST(LowRanking, MatchesReference) {
+    FastDeck deck(21);
+    constexpr int count = 3000;
+    std::vector<std::vector<int>> keys_a5, keys_27;
+    std::vector<LowRanking> a5, low27;
+    for (int i = 0; i < count; ++i) {
+        deck.shuffle();
+        int n = 5 + i % 3;
+        std::vector<Card> cards(n);
+        deck.dealN(cards.data(), n);
+        keys_a5.push_back(referenceA5(cards));
+        a5.push_back(CardSet(cards).rankLowA5());
+        cards.resize(5);
+        keys_27.push_back(highKey(cards, false));
+        low27.push_back(CardSet(cards).rankLow27());
+    }
+    expectSameOrder(keys_a5, a5);
+    expectSameOrder(keys_27, low27);
+}
+
+TEST(LowRanking, OmahaHiLo) {
+    CardSet board( { _AS, _2D, _7C, _9H, _KD });
+    HiLoRanking hand = rankOmahaHiLo(CardSet( { _3S, _4C, _KH, _QS }), board);
+    EXPECT_EQ(CardSet( { _KH, _KD, _AS, _QS, _9H }).rank<5>(), hand.high);
+    EXPECT_EQ(CardSet( { _AS, _2D, _3S, _4C, _7C }).rankLowA5(), hand.low);
+    // The ace pairs the board, the low needs two other ranks.
+    hand = rankOmahaHiLo(CardSet( { _AC, _3S, _QS, _QD }), board);
+    EXPECT_EQ(LowRanking(), hand.low);
+    // Two low board cards are no low.
+    hand = rankOmahaHiLo(CardSet( { _3S, _4C, _KH, _QS }), CardSet( { _AS,
+            _2D, _9C, _9H, _KD }));
+    EXPECT_EQ(LowRanking(), hand.low);
+}
+
+// The low against the best qualifying A-5 low of two hole and three board
+// cards.
+TEST(LowRanking, OmahaHiLoMatchesBruteForce) {
+    FastDeck deck(22);
+    for (int trial = 0; trial < 5000; ++trial) {
+        deck.shuffle();
+        std::vector<Card> b(3 + trial % 3);
+        std::vector<Card> h(OmahaBoard::MIN_HOLE_CARDS + trial / 3 % 3);
+        deck.dealN(b.data(), b.size());
+        deck.dealN(h.data(), h.size());
+        LowRanking best;
+        for (size_t i = 0; i < h.size(); ++i) {
+            for (size_t j = i + 1; j < h.size(); ++j) {
+                for (size_t k = 0; k < b.size(); ++k) {
+                    for (size_t l = k + 1; l < b.size(); ++l) {
+                        for (size_t m = l + 1; m < b.size(); ++m) {
+                            LowRanking low = CardSet( { h[i], h[j], b[k],
+                                    b[l], b[m] }).rankLowA5();
+                            if (low.isEightOrBetter()) {
+                                best = std::max(best, low);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        OmahaBoard omaha((CardSet(b)));
+        HiLoRanking hand = omaha.rankHiLo(CardSet(h));
+        ASSERT_EQ(best, hand.low);
+        ASSERT_EQ(omaha.rank(CardSet(h)), hand.high);
+    }
+}
+
+} /* namespace poker */
@@ -0,0 +1,115 @@
+#include "Numa.h"
+#include "CardSet.h"
+#include "CpuDispatch.h"
+#include "RankTables.h"
+#include "TableFile.h"
+
+#include <thread>
+#include <string.h>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+TEST(Numa, Topology) {
+    uint32_t nodes = getNumaNodeCount();
+    ASSERT_GE(nodes, 1);
+    ASSERT_LE(nodes, MAX_NUMA_NODES);
+    size_t cpus = 0;
+    for (uint32_t node = 0; node < nodes; ++node) {
+        cpus += getNumaNodeCpus(node).size();
+    }
+    EXPECT_GE(cpus, 1);
+    EXPECT_TRUE(getNumaNodeCpus(MAX_NUMA_NODES).empty());
+}
+
+TEST(Numa, PinThread) {
+    std::thread([]() {
+        EXPECT_EQ(0, getThreadNumaNode());
+        EXPECT_FALSE(pinThreadToNumaNode(MAX_NUMA_NODES));
+        for (uint32_t node = 0; node < getNumaNodeCount(); ++node) {
+            if (!getNumaNodeCpus(node).empty()) {
+                EXPECT_TRUE(pinThreadToNumaNode(node));
+                EXPECT_EQ(node, getThreadNumaNode());
+            }
+        }
+    }).join();
+}
+
+TEST(Numa, TableOnNode) {
+    std::vector<uint32_t> data(10000);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = i * i;
+    }
+    TableData table = TableData::generate(4 * data.size(), [&](void* payload) {
+        memcpy(payload, data.data(), 4 * data.size());
+    }, 0);
+    EXPECT_FALSE(table.isMapped());
+    ASSERT_EQ(4 * data.size(), table.size());
+    EXPECT_EQ(0, memcmp(data.data(), table.data(), table.size()));
+    TableData moved = std::move(table);
+    EXPECT_EQ(0, memcmp(data.data(), moved.data(), moved.size()));
+}
+
+TEST(Numa, ReplicatedRankTables) {
+    detail::RankTables tables(detail::rankKernels().rankTexasHoldem);
+    std::vector<uint64_t> values;
+    for (size_t c = 0; c < tables.getClassCount(); ++c) {
+        values.push_back(tables.getValue(c));
+    }
+    tables.replicate();
+    size_t nodes = 0;
+    for (uint32_t node = 0; node < getNumaNodeCount(); ++node) {
+        if (getNumaNodeCpus(node).empty()) {
+            continue;
+        }
+        nodes++;
+        std::thread([&]() {
+            ASSERT_TRUE(pinThreadToNumaNode(node));
+            ASSERT_EQ(values.size(), tables.getClassCount());
+            for (size_t c = 0; c < values.size(); ++c) {
+                ASSERT_EQ(values[c], tables.getValue(c));
+            }
+        }).join();
+    }
+    EXPECT_EQ(nodes, tables.getReplicaCount());
+}
+
+// Threads of every node rank with their copy of the backend tables, the
+// same as computed.
+TEST(Numa, TableBackend) {
+    RankBackend previous = getRankBackend();
+    FastDeck deck(17);
+    std::vector<CardSet> hands(10000);
+    std::vector<HandRanking> computed(hands.size());
+    for (CardSet& hand : hands) {
+        deck.shuffle();
+        Card cards[7];
+        deck.dealN(cards, 7);
+        hand = CardSet(cards);
+    }
+    setRankBackend(RankBackend::COMPUTED);
+    CardSet::rankTexasHoldemBatch(hands.data(), computed.data(), hands.size());
+
+    replicateRankTables();
+    setRankBackend(RankBackend::TABLE);
+    for (uint32_t node = 0; node < getNumaNodeCount(); ++node) {
+        if (getNumaNodeCpus(node).empty()) {
+            continue;
+        }
+        std::thread([&]() {
+            ASSERT_TRUE(pinThreadToNumaNode(node));
+            std::vector<HandRanking> table(hands.size());
+            CardSet::rankTexasHoldemBatch(hands.data(), table.data(),
+                    hands.size());
+            for (size_t i = 0; i < hands.size(); ++i) {
+                ASSERT_EQ(computed[i], table[i]);
+                ASSERT_EQ(computed[i], hands[i].rankTexasHoldem());
+            }
+        }).join();
+    }
+    setRankBackend(previous);
+}
+
+} /* namespace poker */
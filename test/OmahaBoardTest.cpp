@@ -0,0 +1,137 @@
+#include "OmahaBoard.h"
+#include "IncrementalEvaluator.h"
+#include "CpuDispatch.h"
+#include "AllCards.h"
+
+#include <algorithm>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+// Best of all five card hands of two hole cards and three board cards.
+HandRanking bruteForce(const CardSet& hole, const CardSet& board) {
+    std::vector<Card> h = hole.toCardVector();
+    std::vector<Card> b = board.toCardVector();
+    HandRanking best;
+    for (size_t i = 0; i < h.size(); ++i) {
+        for (size_t j = i + 1; j < h.size(); ++j) {
+            for (size_t k = 0; k < b.size(); ++k) {
+                for (size_t l = k + 1; l < b.size(); ++l) {
+                    for (size_t m = l + 1; m < b.size(); ++m) {
+                        CardSet five( { h[i], h[j], b[k], b[l], b[m] });
+                        best = std::max(best,
+                                IncrementalEvaluator(five).rank());
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+HandRanking rankFive(const CardSet& five) {
+    return IncrementalEvaluator(five).rank();
+}
+
+}
+
+TEST(OmahaBoard, ExactlyTwoHoleCards) {
+    // Four spades in the hand are no flush without three on the board.
+    CardSet board( { _2S, _7S, _QC, _JD, _3H });
+    CardSet hole( { _AS, _KS, _TS, _9S });
+    EXPECT_EQ(rankFive(CardSet( { _AS, _KS, _QC, _JD, _7S })),
+            rankOmaha(hole, board));
+
+    // Four of a kind on the board plays only one of its cards.
+    board = CardSet( { _AS, _AC, _AD, _AH, _KS });
+    hole = CardSet( { _2C, _3C, _4D, _5D });
+    EXPECT_EQ(rankFive(CardSet( { _AS, _AC, _AD, _5D, _4D })),
+            rankOmaha(hole, board));
+
+    // A flush with a paired board, beaten by the full house.
+    board = CardSet( { _2S, _7S, _QS, _QD, _3H });
+    hole = CardSet( { _AS, _KS, _7C, _7D });
+    EXPECT_EQ(rankFive(CardSet( { _7C, _7D, _7S, _QS, _QD })),
+            rankOmaha(hole, board));
+    EXPECT_EQ(HandRanking::FULL_HOUSE, rankOmaha(hole, board).getRanking());
+
+    // The straight flush of the flush pair over its plain flush.
+    board = CardSet( { _9H, _TH, _JH, _2H, _2C });
+    hole = CardSet( { _QH, _KH, _AH, _3H, _2D, _4S });
+    EXPECT_EQ(rankFive(CardSet( { _9H, _TH, _JH, _QH, _KH })),
+            rankOmaha(hole, board));
+}
+
+TEST(OmahaBoard, Invalid) {
+    CardSet board( { _2S, _7S, _QC, _JD, _3H });
+    EXPECT_THROW(rankOmaha(CardSet( { _AS, _KS, _TS }), board),
+            std::runtime_error*);
+    EXPECT_THROW(rankOmaha(CardSet( { _AS, _KS, _TS, _9S, _8S, _7C, _6C }),
+            board), std::runtime_error*);
+    EXPECT_THROW(rankOmaha(CardSet( { _AS, _KS, _TS, _2S }), board),
+            std::runtime_error*);
+    EXPECT_THROW(OmahaBoard(CardSet( { _2S, _7S })), std::runtime_error*);
+}
+
+// Random hands of every size on flops, turns and rivers, on all kernels.
+// Every other board is dealt from low clubs and diamonds only, so that it
+// pairs or allows a flush or straight most of the time.
+TEST(OmahaBoard, MatchesBruteForce) {
+    SimdLevel previous = getSimdLevel();
+    FastDeck deck(15);
+    for (int level = 0; level <= static_cast<int>(detectSimdLevel());
+            ++level) {
+        setSimdLevel(static_cast<SimdLevel>(level));
+        for (int trial = 0; trial < 3000; ++trial) {
+            deck.shuffle();
+            uint32_t board_size = 3 + trial % 3;
+            uint32_t hole_size = OmahaBoard::MIN_HOLE_CARDS + trial / 3 % 3;
+            bool narrow = trial % 2;
+            CardSet board;
+            while (board.size() < board_size) {
+                Card card = deck.deal();
+                if (!narrow || (card.getRank() <= Rank::_8
+                        && card.getColor() <= Color::DIAMONDS)) {
+                    board.add(card);
+                }
+            }
+            CardSet hole;
+            while (hole.size() < hole_size) {
+                hole.add(deck.deal());
+            }
+            ASSERT_EQ(bruteForce(hole, board), OmahaBoard(board).rank(hole))
+                    << hole.toString() << " " << board.toString();
+        }
+    }
+    setSimdLevel(previous);
+}
+
+// Every hole pair on a few boards, with the same two more cards.
+TEST(OmahaBoard, AllPairs) {
+    CardSet boards[] = { CardSet( { _2S, _7S, _QS, _QD, _3H }),
+            CardSet( { _9H, _TH, _JH, _9C, _9D }),
+            CardSet( { _AC, _2C, _3D, _4C, _KH }) };
+    for (const CardSet& board : boards) {
+        OmahaBoard omaha(board);
+        CardSet rest = CardSet::fullDeck();
+        rest.remove(_5H);
+        rest.remove(_6S);
+        std::vector<Card> cards = rest.toCardVector();
+        for (size_t i = 0; i < cards.size(); ++i) {
+            for (size_t j = i + 1; j < cards.size(); ++j) {
+                if (board.contains(cards[i]) || board.contains(cards[j])) {
+                    continue;
+                }
+                CardSet hole( { cards[i], cards[j], _5H, _6S });
+                ASSERT_EQ(bruteForce(hole, board), omaha.rank(hole))
+                        << hole.toString() << " " << board.toString();
+            }
+        }
+    }
+}
+
+} /* namespace poker */
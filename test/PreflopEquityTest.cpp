@@ -0,0 +1,152 @@
+#include "PreflopEquity.h"
+#include "AllCards.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+constexpr uint32_t AA = 0;
+constexpr uint32_t KK = 14;
+
+// Table with the pairs of aces and kings enumerated, shared by the tests.
+const PreflopEquity& acesAndKings() {
+    static TaskScheduler scheduler;
+    static const PreflopEquity equity(
+            PreflopEquity::generate( { AA, KK }, &scheduler), &scheduler);
+    return equity;
+}
+
+}
+
+TEST(PreflopEquity, HandClass) {
+    EXPECT_EQ(AA, PreflopEquity::handClass(HoleCards(_AC, _AD)));
+    EXPECT_EQ(KK, PreflopEquity::handClass(HoleCards(_KH, _KS)));
+    EXPECT_EQ(1, PreflopEquity::handClass(HoleCards(_KS, _AS)));
+    EXPECT_EQ(13, PreflopEquity::handClass(HoleCards(_AS, _KD)));
+    EXPECT_EQ(168, PreflopEquity::handClass(HoleCards(_2C, _2D)));
+    EXPECT_EQ(12, PreflopEquity::handClass(HoleCards(_AH, _2H)));
+    EXPECT_EQ(156, PreflopEquity::handClass(HoleCards(_2H, _AC)));
+}
+
+TEST(PreflopEquity, Matchups) {
+    const PreflopEquity& equity = acesAndKings();
+    uint32_t largest = 0;
+    for (size_t q = 0; q < Range::COMBOS; ++q) {
+        for (size_t p = 0; p < q; ++p) {
+            HoleCards first = Range::combo(p);
+            HoleCards second = Range::combo(q);
+            if (first.toCardSet().cardBits()
+                    & second.toCardSet().cardBits()) {
+                continue;
+            }
+            bool swapped;
+            largest = std::max(largest,
+                    equity.matchup(first, second, &swapped));
+        }
+    }
+    EXPECT_EQ(PreflopEquity::MATCHUPS, largest + 1);
+
+    // Same matchup for other suits and the other order.
+    bool swapped;
+    bool reverse;
+    uint32_t m = equity.matchup(HoleCards(_AC, _KC), HoleCards(_QD, _JH),
+            &swapped);
+    EXPECT_EQ(m, equity.matchup(HoleCards(_AS, _KS), HoleCards(_QH, _JD),
+            &reverse));
+    EXPECT_EQ(swapped, reverse);
+    EXPECT_EQ(m, equity.matchup(HoleCards(_QD, _JH), HoleCards(_KC, _AC),
+            &reverse));
+    EXPECT_NE(swapped, reverse);
+    EXPECT_NE(m, equity.matchup(HoleCards(_AC, _KC), HoleCards(_QC, _JH),
+            &reverse));
+}
+
+TEST(PreflopEquity, Lookup) {
+    const PreflopEquity& equity = acesAndKings();
+    std::vector<HoleCards> players = { HoleCards(_AC, _AD), HoleCards(_KH,
+            _KS) };
+    EquityResult expected = EquityCalculator(players).enumerate();
+    EquityResult result = equity.lookup(players[0], players[1]);
+    EXPECT_EQ(PreflopEquity::BOARDS, result.trials);
+    for (int p = 0; p < 2; ++p) {
+        EXPECT_NEAR(expected.players[p].win, result.players[p].win, 1e-12);
+        EXPECT_NEAR(expected.players[p].tie, result.players[p].tie, 1e-12);
+        EXPECT_NEAR(expected.players[p].equity, result.players[p].equity,
+                1e-12);
+    }
+    EXPECT_NEAR(0.8126, result.players[0].equity, 1e-4);
+
+    // The same boards with the suits permuted and the players swapped.
+    EquityResult swapped = equity.calculate( { HoleCards(_KD, _KC),
+            HoleCards(_AS, _AH) });
+    EXPECT_NEAR(result.players[0].equity, swapped.players[1].equity, 1e-12);
+    EXPECT_NEAR(result.players[1].win, swapped.players[0].win, 1e-12);
+    EXPECT_NEAR(result.players[1].tie, swapped.players[0].tie, 1e-12);
+
+    EXPECT_THROW(equity.lookup(HoleCards(_AC, _AD), HoleCards(_AC, _KS)),
+            std::runtime_error*);
+}
+
+TEST(PreflopEquity, Fallback) {
+    const PreflopEquity& equity = acesAndKings();
+    std::vector<HoleCards> players = { HoleCards(_AC, _KC), HoleCards(_QH,
+            _QS) };
+    EXPECT_NEAR(EquityCalculator(players).enumerate().players[0].equity,
+            equity.calculate(players).players[0].equity, 1e-12);
+
+    players = { HoleCards(_AC, _AD), HoleCards(_KH, _KS) };
+    CardSet board( { _2C, _7D, _KD });
+    EXPECT_NEAR(EquityCalculator(players, board).enumerate().players[0].equity,
+            equity.calculate(players, board).players[0].equity, 1e-12);
+    CardSet dead( { _KC });
+    EquityCalculator calc(players, CardSet(), dead);
+    EXPECT_NEAR(calc.enumerate().players[0].equity,
+            equity.calculate(players, CardSet(), dead).players[0].equity,
+            1e-12);
+}
+
+TEST(PreflopEquity, ClassEquity) {
+    const PreflopEquity& equity = acesAndKings();
+    // Every suit pattern of aces against kings wins about 82%.
+    double aces = equity.getClassEquity(AA, KK);
+    EXPECT_NEAR(0.82, aces, 0.005);
+    EXPECT_NEAR(1, aces + equity.getClassEquity(KK, AA), 1e-12);
+    EXPECT_NEAR(0.5, equity.getClassEquity(AA, AA), 1e-12);
+    EXPECT_TRUE(std::isnan(equity.getClassEquity(AA, 1)));
+    EXPECT_TRUE(std::isnan(equity.getClassEquity(168, 167)));
+}
+
+TEST(PreflopEquity, TableFile) {
+    char path[] = "/tmp/preflop_equity_testXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    TableData generated = PreflopEquity::generate( { AA, KK });
+    TableData::write(path, "preflop_equity", PreflopEquity::VERSION,
+            generated.data(), generated.size());
+    PreflopEquity mapped(
+            TableData::map(path, "preflop_equity", PreflopEquity::VERSION));
+    unlink(path);
+
+    const PreflopEquity& equity = acesAndKings();
+    HoleCards aces(_AH, _AS);
+    HoleCards kings(_KC, _KS);
+    EXPECT_EQ(equity.lookup(aces, kings).players[0].equity,
+            mapped.lookup(aces, kings).players[0].equity);
+    EXPECT_EQ(equity.getClassEquity(KK, AA), mapped.getClassEquity(KK, AA));
+
+    EXPECT_THROW(PreflopEquity(TableData::generate(16, [](void*) {
+    })), std::runtime_error*);
+}
+
+} /* namespace poker */
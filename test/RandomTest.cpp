@@ -0,0 +1,61 @@
+#include "Random.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+TEST(PhiloxRandom, KnownAnswers) {
+    // Known answer tests of Random123 for philox4x32_10, counter words
+    // (block low, block high, stream low, stream high) and key (low, high).
+    uint32_t out[4];
+    PhiloxRandom::generate(0, 0, 0, out);
+    EXPECT_THAT(out, testing::ElementsAre(0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+            0x9b00dbd8));
+    PhiloxRandom::generate(~0ull, ~0ull, ~0ull, out);
+    EXPECT_THAT(out, testing::ElementsAre(0x408f276d, 0x41c83b0e, 0xa20bc7c6,
+            0x6d5451fd));
+    PhiloxRandom::generate(0x299f31d0a4093822, 0x0370734413198a2e,
+            0x85a308d3243f6a88, out);
+    EXPECT_THAT(out, testing::ElementsAre(0xd16cfe09, 0x94fdcceb, 0x5001e420,
+            0x24126ea1));
+}
+
+TEST(PhiloxRandom, Lanes) {
+    // Four blocks per SSE2 step, the rest one by one, across a carry of the
+    // block counter.
+    uint32_t lanes[4 * 11];
+    PhiloxRandom::generate(7, 3, ~0ull - 5, 11, lanes);
+    for (uint64_t i = 0; i < 11; ++i) {
+        uint32_t out[4];
+        PhiloxRandom::generate(7, 3, ~0ull - 5 + i, out);
+        for (int k = 0; k < 4; ++k) {
+            ASSERT_EQ(out[k], lanes[4 * i + k]) << "Block " << i;
+        }
+    }
+}
+
+TEST(PhiloxRandom, Fill) {
+    PhiloxRandom random(42);
+    uint32_t first[PhiloxRandom::BUFFER_SIZE];
+    uint32_t second[PhiloxRandom::BUFFER_SIZE];
+    random.fill(first);
+    random.fill(second);
+    EXPECT_EQ(PhiloxRandom::BUFFER_SIZE / 2, random.getBlock());
+
+    // Any block of any stream directly.
+    uint32_t out[4];
+    PhiloxRandom::generate(42, 0, PhiloxRandom::BUFFER_SIZE / 4 + 1, out);
+    EXPECT_EQ(out[2], second[6]);
+    random.seek(0, PhiloxRandom::BUFFER_SIZE / 4);
+    random.fill(first);
+    EXPECT_EQ(second[0], first[0]);
+
+    random.jump(3);
+    EXPECT_EQ(3, random.getStream());
+    random.fill(first);
+    PhiloxRandom::generate(42, 3, PhiloxRandom::BUFFER_SIZE / 2, out);
+    EXPECT_EQ(out[0], first[0]);
+}
+
+}
@@ -0,0 +1,111 @@
+#include "RangeEquityCalculator.h"
+#include "AllCards.h"
+
+#include <cmath>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+TEST(RangeEquityCalculator, SingleCombos) {
+    CardSet board( { _2S, _7S, _QC });
+    RangeEquityCalculator ranges( { Range::parse("AsKs"),
+            Range::parse("QhQd") }, board);
+    EquityCalculator hands( { HoleCards(_AS, _KS), HoleCards(_QH, _QD) },
+            board);
+
+    EquityResult expected = hands.enumerate();
+    EquityResult result = ranges.enumerate();
+    ASSERT_EQ(expected.trials, result.trials);
+    for (size_t p = 0; p < 2; ++p) {
+        EXPECT_NEAR(expected.players[p].equity, result.players[p].equity,
+                1e-12);
+        EXPECT_NEAR(expected.players[p].win, result.players[p].win, 1e-12);
+    }
+}
+
+TEST(RangeEquityCalculator, EnumerateMatchesMatchups) {
+    CardSet board( { _2S, _7S, _QC, _JD });
+    Range hero = Range::parse("QQ+, AKs, JTs:0.5");
+    Range villain = Range::parse("JJ, AQo:0.25, 98s");
+    RangeEquityCalculator calc( { hero, villain }, board);
+    EquityResult result = calc.enumerate();
+
+    // Every matchup sees the same number of boards, so the range equity is
+    // the weighted mean of the single matchups.
+    double weight_sum = 0;
+    double equity_sum = 0;
+    for (size_t h : hero.liveCombos(board)) {
+        for (size_t v : villain.liveCombos(board)) {
+            HoleCards h_hole = Range::combo(h);
+            HoleCards v_hole = Range::combo(v);
+            if (h_hole.toCardSet().cardBits() & v_hole.toCardSet().cardBits()) {
+                continue;
+            }
+            double weight = hero.getWeight(h) * villain.getWeight(v);
+            EquityCalculator matchup( { h_hole, v_hole }, board);
+            equity_sum += weight * matchup.enumerate().players[0].equity;
+            weight_sum += weight;
+        }
+    }
+    EXPECT_NEAR(equity_sum / weight_sum, result.players[0].equity, 1e-9);
+    EXPECT_NEAR(1.0, result.players[0].equity + result.players[1].equity,
+            1e-9);
+}
+
+TEST(RangeEquityCalculator, SamplingMatchesEnumeration) {
+    CardSet board( { _2S, _7S, _QC });
+    RangeEquityCalculator calc( { Range::parse("QQ+, AKs, 76s"), Range::parse(
+            "TT-JJ, AQ, KQs:0.5"), Range::parse("22-55") }, board);
+    calc.setMaxTrials(200000);
+    calc.setSeed(3);
+    EquityResult sampled = calc.calculate();
+    EquityResult exact = calc.enumerate();
+
+    ASSERT_EQ(200000, sampled.trials);
+    for (size_t p = 0; p < 3; ++p) {
+        EXPECT_NEAR(exact.players[p].equity, sampled.players[p].equity,
+                5 * sampled.players[p].std_error);
+        EXPECT_GT(sampled.players[p].std_error, 0);
+        EXPECT_EQ(0, exact.players[p].std_error);
+    }
+}
+
+// The matchups drawn on one board are correlated, so the reported error
+// must match the spread of the equity across seeds, not be smaller.
+TEST(RangeEquityCalculator, StdErrorMatchesSpread) {
+    RangeEquityCalculator calc( {
+            Range::parse("22+, A2s+, KTs+, QJs, AJo+, KQo"),
+            Range::parse("55+, A8s+, KQs, AQo+") }, CardSet( { _AH, _9C,
+            _5D }));
+    calc.setMaxTrials(2048);
+    const int seeds = 300;
+    double sum = 0;
+    double squares = 0;
+    double reported = 0;
+    for (int seed = 1; seed <= seeds; ++seed) {
+        calc.setSeed(seed);
+        EquityResult result = calc.calculate();
+        sum += result.players[0].equity;
+        squares += result.players[0].equity * result.players[0].equity;
+        reported += result.players[0].std_error;
+    }
+    double mean = sum / seeds;
+    double spread = std::sqrt((squares - seeds * mean * mean) / (seeds - 1));
+    EXPECT_NEAR(1, reported / seeds / spread, 0.08);
+}
+
+TEST(RangeEquityCalculator, InvalidInput) {
+    EXPECT_THROW(RangeEquityCalculator( { Range::parse("AA") }),
+            std::runtime_error*);
+    // All aces are on the board or dead.
+    EXPECT_THROW(RangeEquityCalculator( { Range::parse("AA"), Range::parse(
+            "KK") }, CardSet( { _AS, _AH }), CardSet( { _AC })),
+            std::runtime_error*);
+    EXPECT_THROW(RangeEquityCalculator( { Range::parse("AA"), Range::parse(
+            "KK") }, CardSet( { _AS, _AH }), CardSet( { _AS })),
+            std::runtime_error*);
+}
+
+}
@@ -0,0 +1,89 @@
+#include "Range.h"
+#include "AllCards.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+TEST(Range, comboIndex) {
+    for (size_t index = 0; index < Range::COMBOS; ++index) {
+        HoleCards hole = Range::combo(index);
+        ASSERT_EQ(index, Range::comboIndex(hole.getFirst(), hole.getSecond()));
+        ASSERT_EQ(index, Range::comboIndex(hole.getSecond(), hole.getFirst()));
+    }
+    EXPECT_EQ(0, Range::comboIndex(_2C, _2D));
+    EXPECT_EQ(Range::COMBOS - 1, Range::comboIndex(_AH, _AS));
+}
+
+TEST(Range, parsePairs) {
+    EXPECT_EQ(6, Range::parse("QQ").size());
+    EXPECT_EQ(18, Range::parse("QQ+").size());
+    EXPECT_EQ(24, Range::parse("22-55").size());
+    EXPECT_EQ(24, Range::parse("55-22").size());
+
+    Range range = Range::parse("KK+");
+    EXPECT_EQ(1, range.getWeight(HoleCards(_AC, _AS)));
+    EXPECT_EQ(1, range.getWeight(HoleCards(_KD, _KH)));
+    EXPECT_EQ(0, range.getWeight(HoleCards(_QD, _QH)));
+    EXPECT_EQ(0, range.getWeight(HoleCards(_AD, _KH)));
+}
+
+TEST(Range, parseNonPairs) {
+    EXPECT_EQ(4, Range::parse("AKs").size());
+    EXPECT_EQ(12, Range::parse("AKo").size());
+    EXPECT_EQ(16, Range::parse("AK").size());
+    EXPECT_EQ(16, Range::parse("ATs+").size());
+    EXPECT_EQ(16, Range::parse("A2s-A5s").size());
+    EXPECT_EQ(48, Range::parse("K9o+").size());
+
+    Range range = Range::parse("A2s-A5s");
+    EXPECT_EQ(1, range.getWeight(HoleCards(_AH, _3H)));
+    EXPECT_EQ(0, range.getWeight(HoleCards(_AH, _3S)));
+    EXPECT_EQ(0, range.getWeight(HoleCards(_AH, _6H)));
+
+    range = Range::parse("KQo");
+    EXPECT_EQ(1, range.getWeight(HoleCards(_QC, _KD)));
+    EXPECT_EQ(0, range.getWeight(HoleCards(_QC, _KC)));
+}
+
+TEST(Range, parseCombosAndWeights) {
+    Range range = Range::parse(" QQ+, AKs , KQo:0.5, AsKd, 76s:25% ");
+    EXPECT_EQ(18 + 4 + 12 + 1 + 4, range.size());
+    EXPECT_EQ(1, range.getWeight(HoleCards(_QS, _QH)));
+    EXPECT_EQ(1, range.getWeight(HoleCards(_AS, _KD)));
+    EXPECT_EQ(0, range.getWeight(HoleCards(_AD, _KS)));
+    EXPECT_EQ(0.5, range.getWeight(HoleCards(_KH, _QS)));
+    EXPECT_EQ(0.25, range.getWeight(HoleCards(_7D, _6D)));
+
+    // Later entries override earlier ones.
+    range = Range::parse("AA, AcAd:0.5");
+    EXPECT_EQ(6, range.size());
+    EXPECT_EQ(0.5, range.getWeight(HoleCards(_AD, _AC)));
+}
+
+TEST(Range, parseInvalid) {
+    EXPECT_THROW(Range::parse("QQs"), std::runtime_error*);
+    EXPECT_THROW(Range::parse("AKx"), std::runtime_error*);
+    EXPECT_THROW(Range::parse("A"), std::runtime_error*);
+    EXPECT_THROW(Range::parse("AsAs"), std::runtime_error*);
+    EXPECT_THROW(Range::parse("AK:1.5"), std::runtime_error*);
+    EXPECT_THROW(Range::parse("AK:abc"), std::runtime_error*);
+    EXPECT_THROW(Range::parse("AKs-KQs"), std::runtime_error*);
+    EXPECT_THROW(Range::parse("AA,,KK"), std::runtime_error*);
+    EXPECT_EQ(0, Range::parse("").size());
+}
+
+TEST(Range, liveCombos) {
+    Range range = Range::parse("AA, AKs");
+    EXPECT_EQ(10, range.liveCombos(CardSet()).size());
+    // The ace of spades blocks three pairs and one suited combination.
+    std::vector<size_t> live = range.liveCombos(CardSet( { _AS, _2C }));
+    EXPECT_EQ(6, live.size());
+    for (size_t index : live) {
+        HoleCards hole = Range::combo(index);
+        EXPECT_FALSE(hole.getFirst() == _AS || hole.getSecond() == _AS);
+    }
+}
+
+}
@@ -0,0 +1,107 @@
+#include "CardSet.h"
+#include "CpuDispatch.h"
+#include "RankTables.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+class RankBackendGuard {
+public:
+    RankBackendGuard() : backend(getRankBackend()) {}
+    ~RankBackendGuard() {
+        setRankBackend(backend);
+    }
+private:
+    RankBackend backend;
+};
+
+// Ranks the hands with both backends and compares the results.
+void crossCheck(const std::vector<CardSet>& hands) {
+    std::vector<HandRanking> computed(hands.size());
+    std::vector<HandRanking> table(hands.size());
+    setRankBackend(RankBackend::COMPUTED);
+    CardSet::rankTexasHoldemBatch(hands.data(), computed.data(), hands.size());
+    setRankBackend(RankBackend::TABLE);
+    CardSet::rankTexasHoldemBatch(hands.data(), table.data(), hands.size());
+    for (size_t i = 0; i < hands.size(); ++i) {
+        ASSERT_EQ(computed[i], table[i]) << "Hand " << i;
+        ASSERT_EQ(computed[i], hands[i].rankTexasHoldem()) << "Hand " << i;
+    }
+}
+
+}
+
+TEST(RankTables, Backends) {
+    RankBackendGuard guard;
+    EXPECT_EQ(RankBackend::COMPUTED, getRankBackend());
+    setRankBackend(RankBackend::TABLE);
+    EXPECT_EQ(RankBackend::TABLE, getRankBackend());
+    EXPECT_EQ("table", toString(getRankBackend()));
+    // The SIMD level stays selectable next to the backend.
+    SimdLevel level = getSimdLevel();
+    setSimdLevel(SimdLevel::SSE2);
+    EXPECT_EQ(RankBackend::TABLE, getRankBackend());
+    setSimdLevel(level);
+}
+
+TEST(RankTables, ClassesAreOrdered) {
+    detail::RankTables tables(detail::rankKernels().rankTexasHoldem);
+    // Distinct rankings of seven card hands.
+    ASSERT_EQ(4824, tables.getClassCount());
+    for (size_t c = 1; c < tables.getClassCount(); ++c) {
+        ASSERT_LT(tables.getValue(c - 1), tables.getValue(c));
+    }
+}
+
+// Every one of the 133,784,560 seven card hands.
+TEST(RankTables, Exhaustive) {
+    RankBackendGuard guard;
+    std::vector<Card> cards;
+    for (uint8_t c = 0; c < 4; ++c) {
+        for (uint8_t r = 0; r < 13; ++r) {
+            cards.push_back(Card(static_cast<Rank>(r), static_cast<Color>(c)));
+        }
+    }
+
+    std::vector<CardSet> hands;
+    hands.reserve(1 << 16);
+    uint64_t count = 0;
+    CardSet partial[7];
+    for (int c0 = 0; c0 < 52; ++c0) {
+        partial[0] = CardSet( { cards[c0] });
+        for (int c1 = c0 + 1; c1 < 52; ++c1) {
+            partial[1] = partial[0];
+            partial[1].add(cards[c1]);
+            for (int c2 = c1 + 1; c2 < 52; ++c2) {
+                partial[2] = partial[1];
+                partial[2].add(cards[c2]);
+                for (int c3 = c2 + 1; c3 < 52; ++c3) {
+                    partial[3] = partial[2];
+                    partial[3].add(cards[c3]);
+                    for (int c4 = c3 + 1; c4 < 52; ++c4) {
+                        partial[4] = partial[3];
+                        partial[4].add(cards[c4]);
+                        for (int c5 = c4 + 1; c5 < 52; ++c5) {
+                            partial[5] = partial[4];
+                            partial[5].add(cards[c5]);
+                            for (int c6 = c5 + 1; c6 < 52; ++c6) {
+                                hands.push_back(partial[5]);
+                                hands.back().add(cards[c6]);
+                            }
+                        }
+                    }
+                }
+            }
+            count += hands.size();
+            crossCheck(hands);
+            hands.clear();
+        }
+    }
+    ASSERT_EQ(133784560, count);
+}
+
+}
@@ -0,0 +1,89 @@
+#include "RiverRanks.h"
+#include "RangeEquityCalculator.h"
+#include "AllCards.h"
+
+#include <set>
+#include <stdexcept>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+TEST(RiverRanks, Sorted) {
+    CardSet board( { _2C, _7D, _KD, _9D, _TS });
+    RiverRanks ranks(board);
+    std::set<uint16_t> combos;
+    for (size_t i = 0; i < RiverRanks::COMBOS; ++i) {
+        CardSet hand = Range::comboCards(ranks.getCombo(i));
+        EXPECT_EQ(0, hand.cardBits() & board.cardBits());
+        hand.addAll(board);
+        EXPECT_EQ(HandRankIndex(hand.rankTexasHoldem()), ranks.getRanking(i));
+        if (i > 0) {
+            EXPECT_LE(ranks.getRanking(i - 1), ranks.getRanking(i));
+        }
+        combos.insert(ranks.getCombo(i));
+    }
+    EXPECT_EQ(RiverRanks::COMBOS, combos.size());
+
+    const std::vector<uint16_t>& groups = ranks.getGroups();
+    ASSERT_LE(2, groups.size());
+    EXPECT_EQ(0, groups.front());
+    EXPECT_EQ(RiverRanks::COMBOS, groups.back());
+    for (size_t g = 0; g + 1 < groups.size(); ++g) {
+        ASSERT_LT(groups[g], groups[g + 1]);
+        for (size_t i = groups[g]; i < groups[g + 1]; ++i) {
+            EXPECT_EQ(ranks.getRanking(groups[g]), ranks.getRanking(i));
+        }
+        if (g > 0) {
+            EXPECT_LT(ranks.getRanking(groups[g] - 1),
+                    ranks.getRanking(groups[g]));
+        }
+    }
+
+    EXPECT_THROW(RiverRanks(CardSet( { _2C, _7D, _KD, _9D })),
+            std::runtime_error*);
+}
+
+// A straight on the board makes many combinations tie.
+TEST(RiverRanks, Ties) {
+    RiverRanks ranks(CardSet( { _5C, _6D, _7H, _8S, _9C }));
+    const std::vector<uint16_t>& groups = ranks.getGroups();
+    EXPECT_LT(groups.size(), 100);
+    // Most of the combinations just play the board.
+    EXPECT_EQ(HandRanking::STRAIGHT,
+            ranks.getRanking(0).toHandRanking().getRanking());
+    EXPECT_LT(600, groups[1]);
+}
+
+TEST(RiverRanks, Equity) {
+    CardSet board( { _2C, _7D, _KD, _9D, _TS });
+    RiverRanks ranks(board);
+    std::vector<std::pair<std::string, std::string>> matchups = {
+        { "QQ+, AK, KQs, 98s", "TT-JJ, AQo, KJs+, 77:0.5, 98s" },
+        { "22+, A2s+, K9o+", "AdQd, JdTd, 8d8s:0.25" },
+        { "KhKs", "KcKh, 7c7h" },
+        { "AhAs:0.3, 2d2h", "AhAs, 2d2h, 2h2s" },
+    };
+    for (const auto& matchup : matchups) {
+        Range first = Range::parse(matchup.first);
+        Range second = Range::parse(matchup.second);
+        EquityResult expected =
+                RangeEquityCalculator( { first, second }, board).enumerate();
+        EquityResult result = ranks.equity(first, second);
+        EXPECT_EQ(expected.trials, result.trials);
+        for (int p = 0; p < 2; ++p) {
+            EXPECT_NEAR(expected.players[p].win, result.players[p].win,
+                    1e-9);
+            EXPECT_NEAR(expected.players[p].tie, result.players[p].tie,
+                    1e-9);
+            EXPECT_NEAR(expected.players[p].equity,
+                    result.players[p].equity, 1e-9);
+        }
+    }
+
+    EXPECT_THROW(ranks.equity(Range::parse("AhAs"), Range::parse("AhKs")),
+            std::runtime_error*);
+}
+
+} /* namespace poker */
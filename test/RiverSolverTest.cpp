@@ -0,0 +1,158 @@
+#include "RiverSolver.h"
+#include "AllCards.h"
+
+#include <stdexcept>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+const CardSet BOARD( { _AH, _KD, _8C, _5S, _2H });
+
+RiverSolver::Config potSizedBets() {
+    RiverSolver::Config config;
+    config.bet_sizes = { 1 };
+    config.max_raises = 0;
+    config.all_in = false;
+    return config;
+}
+
+}
+
+TEST(RiverSolver, Tree) {
+    RiverSolver solver(BOARD, Range::parse("AA, 76s"), Range::parse("AQ"),
+            potSizedBets());
+    // Check, check-check, check-bet, check-bet-fold, check-bet-call, bet,
+    // bet-fold and bet-call.
+    EXPECT_EQ(9, solver.getNodeCount());
+    uint32_t root = RiverSolver::ROOT;
+    ASSERT_EQ(2, solver.getActions(root).size());
+    EXPECT_EQ(RiverSolver::Action::CHECK, solver.getActions(root)[0].type);
+    EXPECT_EQ(RiverSolver::Action::BET, solver.getActions(root)[1].type);
+    EXPECT_EQ(1, solver.getActions(root)[1].amount);
+
+    uint32_t bet = solver.getChild(root, 1);
+    EXPECT_EQ(1, solver.getPlayer(bet));
+    ASSERT_EQ(2, solver.getActions(bet).size());
+    EXPECT_EQ(RiverSolver::Action::FOLD, solver.getActions(bet)[0].type);
+    EXPECT_EQ(RiverSolver::Action::CALL, solver.getActions(bet)[1].type);
+    EXPECT_TRUE(solver.isTerminal(solver.getChild(bet, 1)));
+
+    uint32_t check = solver.getChild(root, 0);
+    EXPECT_EQ(1, solver.getPlayer(check));
+    EXPECT_TRUE(solver.isTerminal(solver.getChild(check, 0)));
+    EXPECT_EQ(0, solver.getPlayer(solver.getChild(check, 1)));
+}
+
+TEST(RiverSolver, Raises) {
+    RiverSolver::Config config;
+    config.pot = 1;
+    config.stack = 3;
+    config.bet_sizes = { 0.5, 1 };
+    config.raise_sizes = { 1 };
+    config.max_raises = 1;
+    RiverSolver solver(BOARD, Range::parse("AA, 76s"), Range::parse("AQ"),
+            config);
+    // Half pot, pot and all-in.
+    const std::vector<RiverSolver::Action>& bets = solver.getActions(
+            RiverSolver::ROOT);
+    ASSERT_EQ(4, bets.size());
+    EXPECT_EQ(0.5, bets[1].amount);
+    EXPECT_EQ(1, bets[2].amount);
+    EXPECT_EQ(3, bets[3].amount);
+
+    // A pot-sized raise of the half pot bet is to 2.5, then all-in.
+    uint32_t facing = solver.getChild(RiverSolver::ROOT, 1);
+    const std::vector<RiverSolver::Action>& raises = solver.getActions(facing);
+    ASSERT_EQ(4, raises.size());
+    EXPECT_EQ(RiverSolver::Action::RAISE, raises[2].type);
+    EXPECT_EQ(2.5, raises[2].amount);
+    EXPECT_EQ(3, raises[3].amount);
+    // No raise of the raise.
+    EXPECT_EQ(2, solver.getActions(solver.getChild(facing, 2)).size());
+    // Nothing to raise over an all-in bet.
+    EXPECT_EQ(2, solver.getActions(solver.getChild(RiverSolver::ROOT, 3))
+            .size());
+}
+
+// Nuts and air against a bluff catcher: with pot-sized bets the bettor
+// bluffs half as often as it value bets, and the bluff catcher calls half
+// of the time.
+TEST(RiverSolver, Polarized) {
+    HoleCards nuts(_AC, _AD);
+    HoleCards air(_7C, _6C);
+    HoleCards catcher(_AS, _QS);
+    Range first;
+    first.setWeight(nuts, 1);
+    first.setWeight(air, 1);
+    Range second;
+    second.setWeight(catcher, 1);
+    for (RiverSolver::Algorithm algorithm : {
+            RiverSolver::Algorithm::CFR_PLUS,
+            RiverSolver::Algorithm::DISCOUNTED }) {
+        RiverSolver solver(BOARD, first, second, potSizedBets());
+        solver.setAlgorithm(algorithm);
+        solver.solve(2000);
+        EXPECT_EQ(2000, solver.getIterations());
+        EXPECT_LT(solver.getExploitability(), 0.005);
+
+        double value_bets = solver.getStrategy(RiverSolver::ROOT, nuts)[1];
+        double bluffs = solver.getStrategy(RiverSolver::ROOT, air)[1];
+        EXPECT_NEAR(0.5, bluffs / value_bets, 0.05);
+        uint32_t bet = solver.getChild(RiverSolver::ROOT, 1);
+        EXPECT_NEAR(0.5, solver.getStrategy(bet, catcher)[1], 0.05);
+
+        // The nuts win the pot and half of the time the call, the air wins
+        // nothing on average.
+        EXPECT_NEAR(0.75, solver.getValue(0), 0.01);
+        EXPECT_NEAR(1, solver.getValue(0) + solver.getValue(1), 1e-9);
+    }
+}
+
+TEST(RiverSolver, Converges) {
+    RiverSolver::Config config;
+    config.pot = 1;
+    config.stack = 2;
+    RiverSolver solver(BOARD, Range::parse("AK, 88, 55, 22, KQ, 76s, 43s"),
+            Range::parse("AQ, AJ, KQ, QQ, 87s"), config);
+    solver.solve(20);
+    double early = solver.getExploitability();
+    solver.solve(280);
+    double late = solver.getExploitability();
+    EXPECT_GT(early, late);
+    EXPECT_LT(late, 0.01);
+    EXPECT_GT(late, -1e-9);
+
+    for (uint32_t node = 0; node < solver.getNodeCount(); ++node) {
+        if (solver.isTerminal(node)) {
+            continue;
+        }
+        std::vector<double> strategy = solver.getStrategy(node,
+                HoleCards(_AC, _KC));
+        double sum = 0;
+        for (double p : strategy) {
+            EXPECT_GE(p, 0);
+            sum += p;
+        }
+        EXPECT_NEAR(1, sum, 1e-9);
+    }
+}
+
+TEST(RiverSolver, InvalidInput) {
+    RiverSolver::Config config;
+    EXPECT_THROW(RiverSolver(CardSet( { _AH, _KD, _8C, _5S }),
+            Range::parse("AA"), Range::parse("KK"), config),
+            std::runtime_error*);
+    EXPECT_THROW(RiverSolver(BOARD, Range::parse("AhKh"),
+            Range::parse("KK"), config), std::runtime_error*);
+    EXPECT_THROW(RiverSolver(BOARD, Range::parse("AsKs"),
+            Range::parse("AsKc"), config), std::runtime_error*);
+    config.pot = 0;
+    EXPECT_THROW(RiverSolver(BOARD, Range::parse("AA"), Range::parse("KK"),
+            config), std::runtime_error*);
+}
+
+} /* namespace poker */
@@ -0,0 +1,60 @@
+#include "SfmtJump.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+TEST(SfmtJump, MatchesGeneration) {
+    for (uint64_t steps : { 0, 1, 2, 7, 100, 1000, 12345 }) {
+        // Also from the middle of a block of generated words.
+        for (int consumed : { 0, 3, 20, 77 }) {
+            sfmt_t jumped;
+            sfmt_init_gen_rand(&jumped, 99);
+            for (int i = 0; i < consumed; ++i) {
+                sfmt_genrand_uint32(&jumped);
+            }
+            sfmt_t generated = jumped;
+
+            sfmtJump(jumped, steps);
+            for (uint64_t i = 0; i < 4 * steps; ++i) {
+                sfmt_genrand_uint32(&generated);
+            }
+            for (int i = 0; i < 1000; ++i) {
+                ASSERT_EQ(sfmt_genrand_uint32(&generated),
+                        sfmt_genrand_uint32(&jumped))
+                        << steps << " steps, " << consumed << " consumed";
+            }
+        }
+    }
+}
+
+TEST(SfmtJump, Substreams) {
+    sfmt_t base;
+    sfmt_init_gen_rand(&base, 5);
+
+    sfmt_t a = base;
+    sfmtJumpSubstreams(a, 3);
+    sfmt_t b = base;
+    for (int i = 0; i < 3; ++i) {
+        sfmtJumpSubstreams(b, 1);
+    }
+    // 2^64 steps as two jumps by 2^63.
+    sfmt_t c = base;
+    sfmtJump(c, 1ull << 63);
+    sfmtJump(c, 1ull << 63);
+    sfmt_t d = base;
+    sfmtJumpSubstreams(d, 1);
+
+    for (int i = 0; i < 100; ++i) {
+        uint32_t word = sfmt_genrand_uint32(&a);
+        EXPECT_EQ(word, sfmt_genrand_uint32(&b));
+        EXPECT_EQ(sfmt_genrand_uint32(&c), sfmt_genrand_uint32(&d));
+    }
+
+    sfmt_t zero = base;
+    sfmtJumpSubstreams(zero, 0);
+    EXPECT_EQ(sfmt_genrand_uint32(&base), sfmt_genrand_uint32(&zero));
+}
+
+}
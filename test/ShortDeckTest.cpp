@@ -0,0 +1,190 @@
+#include "CardSet.h"
+#include "CpuDispatch.h"
+#include "AllCards.h"
+
+#include <algorithm>
+#include <string.h>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+// Category in short deck order followed by the ranks that break ties, to be
+// compared lexicographically.
+std::vector<int> referenceFive(const std::vector<Card>& five) {
+    int counts[13] = { };
+    bool flush = true;
+    for (const Card& card : five) {
+        counts[static_cast<int>(card.getRank())]++;
+        flush &= card.getColor() == five[0].getColor();
+    }
+    // Ranks by count, then by rank, both descending.
+    std::vector<std::pair<int, int>> groups;
+    for (int r = 12; r >= 0; --r) {
+        if (counts[r]) {
+            groups.push_back(std::make_pair(counts[r], r));
+        }
+    }
+    std::stable_sort(groups.begin(), groups.end(),
+            [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                return a.first > b.first;
+            });
+    std::vector<int> ranks;
+    for (const auto& group : groups) {
+        ranks.push_back(group.second);
+    }
+    int top = -1;
+    if (groups.size() == 5) {
+        if (ranks[0] - ranks[4] == 4) {
+            top = ranks[0];
+        } else if (ranks == std::vector<int>( { 12, 7, 6, 5, 4 })) {
+            top = 7;
+        }
+    }
+    int category;
+    if (top >= 0 && flush) {
+        category = 8;
+        ranks = { top };
+    } else if (groups[0].first == 4) {
+        category = 7;
+    } else if (flush) {
+        category = 6;
+    } else if (groups[0].first == 3 && groups[1].first == 2) {
+        category = 5;
+    } else if (top >= 0) {
+        category = 4;
+        ranks = { top };
+    } else if (groups[0].first == 3) {
+        category = 3;
+    } else if (groups[1].first == 2) {
+        category = 2;
+    } else {
+        category = groups[0].first == 2 ? 1 : 0;
+    }
+    ranks.insert(ranks.begin(), category);
+    return ranks;
+}
+
+std::vector<int> referenceSeven(const std::vector<Card>& cards) {
+    std::vector<int> best;
+    for (int skip0 = 0; skip0 < 7; ++skip0) {
+        for (int skip1 = skip0 + 1; skip1 < 7; ++skip1) {
+            std::vector<Card> five;
+            for (int c = 0; c < 7; ++c) {
+                if (c != skip0 && c != skip1) {
+                    five.push_back(cards[c]);
+                }
+            }
+            best = std::max(best, referenceFive(five));
+        }
+    }
+    return best;
+}
+
+// The reference categories in HandRanking terms.
+HandRanking::Ranking category(const std::vector<int>& reference) {
+    const HandRanking::Ranking order[] = { HandRanking::HIGH_CARD,
+            HandRanking::ONE_PAIR, HandRanking::TWO_PAIRS,
+            HandRanking::THREE_OF_A_KIND, HandRanking::STRAIGHT,
+            HandRanking::FULL_HOUSE, HandRanking::FLUSH,
+            HandRanking::FOUR_OF_A_KIND, HandRanking::STRAIGHT_FLUSH };
+    return order[reference[0]];
+}
+
+}
+
+TEST(ShortDeck, Deck) {
+    FastDeck deck = FastDeck::shortDeck(7);
+    EXPECT_EQ(36, deck.size());
+    deck.shuffle();
+    CardSet dealt;
+    for (int i = 0; i < 36; ++i) {
+        Card card = deck.deal();
+        EXPECT_GE(card.getRank(), Rank::_6);
+        dealt.add(card);
+    }
+    CardSet expected = CardSet::shortDeck();
+    EXPECT_EQ(36, expected.size());
+    EXPECT_EQ(0, memcmp(&dealt, &expected, sizeof(CardSet)));
+}
+
+TEST(ShortDeck, Order) {
+    // Ace to nine is the lowest straight, also in a flush.
+    ShortDeckRanking low_straight = CardSet( { _AS, _6C, _7D, _8H, _9S, _JC,
+            _KD }).rankShortDeck();
+    ShortDeckRanking straight = CardSet( { _TS, _6C, _7D, _8H, _9S, _QC,
+            _KD }).rankShortDeck();
+    ShortDeckRanking ace_high = CardSet( { _AS, _6C, _7D, _8H, _TS, _JC,
+            _KD }).rankShortDeck();
+    EXPECT_EQ(HandRanking::STRAIGHT, low_straight.getRanking());
+    EXPECT_LT(low_straight, straight);
+    EXPECT_LT(ace_high, low_straight);
+    ShortDeckRanking low_straight_flush = CardSet( { _AS, _6S, _7S, _8S, _9S,
+            _JC, _KD }).rankShortDeck();
+    EXPECT_EQ(HandRanking::STRAIGHT_FLUSH, low_straight_flush.getRanking());
+    EXPECT_LT(low_straight_flush, CardSet( { _TS, _6S, _7S, _8S, _9S, _JC,
+            _KD }).rankShortDeck());
+
+    // Flushes beat full houses, but not four of a kind.
+    ShortDeckRanking flush = CardSet( { _6S, _7S, _8S, _JS, _QS, _JC,
+            _KD }).rankShortDeck();
+    ShortDeckRanking full_house = CardSet( { _AS, _AC, _AD, _KH, _KS, _JC,
+            _QD }).rankShortDeck();
+    ShortDeckRanking four = CardSet( { _6S, _6C, _6D, _6H, _7S, _JC,
+            _QD }).rankShortDeck();
+    EXPECT_EQ(HandRanking::FLUSH, flush.getRanking());
+    EXPECT_EQ(HandRanking::FULL_HOUSE, full_house.getRanking());
+    EXPECT_LT(full_house, flush);
+    EXPECT_LT(flush, four);
+
+    EXPECT_THROW(CardSet( { _6S, _7S }).rankShortDeck(), std::runtime_error*);
+}
+
+// Random hands against the reference, on all kernels, one by one and in
+// batches.
+TEST(ShortDeck, MatchesReference) {
+    SimdLevel previous = getSimdLevel();
+    constexpr size_t count = 2000 + 5;
+    FastDeck deck = FastDeck::shortDeck(11);
+    std::vector<CardSet> hands(count);
+    std::vector<std::vector<int>> references(count);
+    for (size_t i = 0; i < count; ++i) {
+        deck.shuffle();
+        Card cards[7];
+        deck.dealN(cards, 7);
+        hands[i] = CardSet(cards);
+        references[i] = referenceSeven(std::vector<Card>(cards, cards + 7));
+    }
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return references[a] < references[b];
+    });
+
+    for (int level = 0; level <= static_cast<int>(detectSimdLevel());
+            ++level) {
+        setSimdLevel(static_cast<SimdLevel>(level));
+        std::vector<ShortDeckRanking> rankings(count);
+        CardSet::rankShortDeckBatch(hands.data(), rankings.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(hands[i].rankShortDeck(), rankings[i]);
+            ASSERT_EQ(category(references[i]), rankings[i].getRanking());
+        }
+        for (size_t i = 1; i < count; ++i) {
+            size_t a = order[i - 1], b = order[i];
+            if (references[a] == references[b]) {
+                ASSERT_EQ(rankings[a], rankings[b]);
+            } else {
+                ASSERT_LT(rankings[a], rankings[b]);
+            }
+        }
+    }
+    setSimdLevel(previous);
+}
+
+} /* namespace poker */
@@ -0,0 +1,91 @@
+#include "Showdown.h"
+#include "CpuDispatch.h"
+#include "AllCards.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+TEST(Showdown, Winner) {
+    CardSet board( { _2S, _7S, _QC, _JD, _3H });
+    HoleCards players[] = { HoleCards(_AS, _KS), HoleCards(_QH, _QD),
+            HoleCards(_7C, _2D) };
+    HandRanking rankings[3];
+    EXPECT_EQ(2, Showdown::resolve(board, players, 3, rankings));
+    for (int p = 0; p < 3; ++p) {
+        CardSet hand = board;
+        hand.addAll(players[p].toCardSet());
+        EXPECT_EQ(hand.rankTexasHoldem(), rankings[p]);
+    }
+    EXPECT_EQ(0, Showdown::resolve(board, players, 0));
+}
+
+TEST(Showdown, SplitPot) {
+    // The board plays for everyone but the last player, who holds a flush.
+    CardSet board( { _TS, _JS, _QC, _KD, _AH });
+    HoleCards players[] = { HoleCards(_2C, _3D), HoleCards(_4H, _5C),
+            HoleCards(_2S, _3S), HoleCards(_9S, _8S) };
+    EXPECT_EQ(0xf, Showdown::resolve(board, players, 4));
+    EXPECT_EQ(0x7, Showdown::resolve(board, players, 3));
+}
+
+// Random tables of every size, on all kernels and both backends.
+TEST(Showdown, MatchesRankings) {
+    SimdLevel previous_level = getSimdLevel();
+    RankBackend previous_backend = getRankBackend();
+    FastDeck deck(5);
+    for (int backend = 0; backend < 2; ++backend) {
+        setRankBackend(static_cast<RankBackend>(backend));
+        for (int level = 0; level <= static_cast<int>(detectSimdLevel());
+                ++level) {
+            setSimdLevel(static_cast<SimdLevel>(level));
+            for (int i = 0; i < 500; ++i) {
+                int n = 1 + i % 23;
+                deck.shuffle();
+                CardSet board;
+                for (int c = 0; c < 5; ++c) {
+                    board.add(deck.deal());
+                }
+                std::vector<HoleCards> players;
+                for (int p = 0; p < n; ++p) {
+                    Card first = deck.deal();
+                    players.push_back(HoleCards(first, deck.deal()));
+                }
+
+                HandRanking best;
+                std::vector<HandRanking> expected;
+                for (const HoleCards& player : players) {
+                    CardSet hand = board;
+                    hand.addAll(player.toCardSet());
+                    expected.push_back(hand.rankTexasHoldem());
+                    best = std::max(best, expected.back());
+                }
+                uint32_t winners = 0;
+                for (int p = 0; p < n; ++p) {
+                    winners |= expected[p] == best ? 1u << p : 0;
+                }
+
+                std::vector<HandRanking> rankings(n);
+                ASSERT_EQ(winners, Showdown::resolve(board, players.data(), n,
+                        rankings.data()));
+                ASSERT_EQ(expected, rankings);
+                ASSERT_EQ(winners, Showdown::resolve(board, players.data(), n));
+            }
+        }
+    }
+    setSimdLevel(previous_level);
+    setRankBackend(previous_backend);
+}
+
+#ifdef CARD_CHECKS
+TEST(Showdown, Checks) {
+    HoleCards players[] = { HoleCards(_AS, _KS), HoleCards(_QH, _QD) };
+    EXPECT_THROW(Showdown::resolve(CardSet( { _2S, _7S, _QC }), players, 2),
+            std::runtime_error*);
+    EXPECT_THROW(Showdown::resolve(CardSet( { _2S, _7S, _QC, _JD, _3H }),
+            players, 24), std::runtime_error*);
+}
+#endif
+
+}
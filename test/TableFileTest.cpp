@@ -0,0 +1,154 @@
+#include "TableFile.h"
+#include "CpuDispatch.h"
+#include "RankTables.h"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+namespace {
+
+// Temporary table directory, set for the lifetime of the fixture.
+class TableFileTest: public testing::Test {
+protected:
+    void SetUp() override {
+        char path[] = "/tmp/table_file_testXXXXXX";
+        ASSERT_NE(nullptr, mkdtemp(path));
+        dir = path;
+        previous = getTableDirectory();
+    }
+
+    void TearDown() override {
+        setTableDirectory(previous);
+        for (const std::string& file : files) {
+            unlink((dir + "/" + file).c_str());
+        }
+        rmdir(dir.c_str());
+    }
+
+    std::string path(const std::string& file) {
+        files.push_back(file);
+        return dir + "/" + file;
+    }
+
+    // Overwrites one byte of the file.
+    void corrupt(const std::string& file, off_t offset) {
+        int fd = open(file.c_str(), O_RDWR);
+        ASSERT_GE(fd, 0);
+        char byte;
+        ASSERT_EQ(1, pread(fd, &byte, 1, offset));
+        byte ^= 1;
+        ASSERT_EQ(1, pwrite(fd, &byte, 1, offset));
+        close(fd);
+    }
+
+    std::string dir;
+    std::string previous;
+    std::vector<std::string> files;
+};
+
+std::vector<uint32_t> testData() {
+    std::vector<uint32_t> data;
+    for (uint32_t i = 0; i < 1000; ++i) {
+        data.push_back(i * i);
+    }
+    return data;
+}
+
+}
+
+TEST_F(TableFileTest, RoundTrip) {
+    std::vector<uint32_t> data = testData();
+    std::string file = path("squares.tbl");
+    TableData::write(file, "squares", 3, data.data(), 4 * data.size());
+
+    TableData table = TableData::map(file, "squares", 3);
+    EXPECT_TRUE(table.isMapped());
+    ASSERT_EQ(4 * data.size(), table.size());
+    EXPECT_EQ(0, memcmp(data.data(), table.data(), table.size()));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(table.data()) % 16);
+
+    TableData moved = std::move(table);
+    EXPECT_EQ(nullptr, table.data());
+    EXPECT_EQ(999u * 999u, moved.as<uint32_t>()[999]);
+}
+
+TEST_F(TableFileTest, Rejected) {
+    std::vector<uint32_t> data = testData();
+    std::string file = path("squares.tbl");
+    TableData::write(file, "squares", 3, data.data(), 4 * data.size());
+
+    EXPECT_THROW(TableData::map(file, "cubes", 3), std::runtime_error*);
+    EXPECT_THROW(TableData::map(file, "squares", 4), std::runtime_error*);
+    EXPECT_THROW(TableData::map(path("missing.tbl"), "squares", 3),
+            std::runtime_error*);
+
+    corrupt(file, sizeof(TableFileHeader) + 17);
+    EXPECT_THROW(TableData::map(file, "squares", 3), std::runtime_error*);
+
+    TableData::write(file, "squares", 3, data.data(), 4 * data.size());
+    corrupt(file, 0);
+    EXPECT_THROW(TableData::map(file, "squares", 3), std::runtime_error*);
+
+    TableData::write(file, "squares", 3, data.data(), 4 * data.size());
+    ASSERT_EQ(0, truncate(file.c_str(), sizeof(TableFileHeader) + 100));
+    EXPECT_THROW(TableData::map(file, "squares", 3), std::runtime_error*);
+}
+
+TEST_F(TableFileTest, LoadTable) {
+    std::vector<uint32_t> data = testData();
+    int fills = 0;
+    auto fill = [&](void* payload) {
+        memcpy(payload, data.data(), 4 * data.size());
+        ++fills;
+    };
+
+    setTableDirectory("");
+    TableData generated = loadTable("squares", 1, 4 * data.size(), fill);
+    EXPECT_FALSE(generated.isMapped());
+    EXPECT_EQ(1, fills);
+
+    setTableDirectory(dir);
+    path("squares.tbl");
+    TableData written = loadTable("squares", 1, 4 * data.size(), fill);
+    EXPECT_TRUE(written.isMapped());
+    EXPECT_EQ(2, fills);
+    TableData loaded = loadTable("squares", 1, 4 * data.size(), fill);
+    EXPECT_TRUE(loaded.isMapped());
+    EXPECT_EQ(2, fills);
+    EXPECT_EQ(0, memcmp(data.data(), loaded.data(), loaded.size()));
+
+    // A new version replaces the file.
+    TableData replaced = loadTable("squares", 2, 4 * data.size(), fill);
+    EXPECT_TRUE(replaced.isMapped());
+    EXPECT_EQ(3, fills);
+    EXPECT_THROW(TableData::map(dir + "/squares.tbl", "squares", 1),
+            std::runtime_error*);
+}
+
+TEST_F(TableFileTest, RankTables) {
+    setTableDirectory("");
+    detail::RankTables generated(detail::rankKernels().rankTexasHoldem);
+    EXPECT_FALSE(generated.isMapped());
+
+    setTableDirectory(dir);
+    path("rank_tables.tbl");
+    detail::RankTables written(detail::rankKernels().rankTexasHoldem);
+    detail::RankTables mapped(detail::rankKernels().rankTexasHoldem);
+    EXPECT_TRUE(mapped.isMapped());
+    ASSERT_EQ(generated.getClassCount(), mapped.getClassCount());
+    for (size_t c = 0; c < generated.getClassCount(); ++c) {
+        ASSERT_EQ(generated.getValue(c), mapped.getValue(c));
+    }
+}
+
+}
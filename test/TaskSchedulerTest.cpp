@@ -0,0 +1,172 @@
+#include "TaskScheduler.h"
+#include "Numa.h"
+#include "EquityCalculator.h"
+#include "RangeEquityCalculator.h"
+#include "AllCards.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace poker {
+
+TEST(ScratchArena, Allocate) {
+    ScratchArena arena(1024);
+    CardSet* cards = arena.allocate<CardSet>(10);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(cards) % 64);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(0, cards[i].size());
+    }
+    HandRanking* rankings = arena.allocate<HandRanking>(3);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(rankings) % 64);
+    EXPECT_GE(reinterpret_cast<char*>(rankings),
+            reinterpret_cast<char*>(cards + 10));
+
+    // Larger than a block.
+    uint64_t* large = arena.allocate<uint64_t>(1000);
+    large[999] = 1;
+    EXPECT_EQ(0, large[0]);
+}
+
+TEST(ScratchArena, Scope) {
+    ScratchArena arena(1024);
+    CardSet* first;
+    {
+        ScratchArena::Scope scope(arena);
+        first = arena.allocate<CardSet>(1);
+        {
+            ScratchArena::Scope inner(arena);
+            arena.allocate<CardSet>(100);
+        }
+        EXPECT_EQ(first + 4, arena.allocate<CardSet>(1));
+    }
+    EXPECT_EQ(first, arena.allocate<CardSet>(1));
+}
+
+TEST(TaskScheduler, CoversRange) {
+    TaskScheduler scheduler(4);
+    EXPECT_EQ(4, scheduler.getThreads());
+    for (uint64_t grain : { 1, 7, 100, 5000 }) {
+        std::vector<std::atomic<int>> visits(1000);
+        std::atomic<uint64_t> largest { 0 };
+        scheduler.parallelFor(0, visits.size(), grain,
+                [&](uint64_t begin, uint64_t end, ScratchArena&) {
+            for (uint64_t i = begin; i < end; ++i) {
+                visits[i]++;
+            }
+            uint64_t size = end - begin;
+            uint64_t seen = largest.load();
+            while (size > seen && !largest.compare_exchange_weak(seen, size)) {
+            }
+        });
+        for (const std::atomic<int>& v : visits) {
+            ASSERT_EQ(1, v.load());
+        }
+        EXPECT_LE(largest.load(), grain);
+    }
+    scheduler.parallelFor(5, 5, 1, [](uint64_t, uint64_t, ScratchArena&) {
+        FAIL();
+    });
+}
+
+// Requests from many threads at once and from within tasks.
+TEST(TaskScheduler, ConcurrentAndNested) {
+    TaskScheduler scheduler(3);
+    std::atomic<uint64_t> sum { 0 };
+    std::vector<std::thread> clients;
+    for (int c = 0; c < 8; ++c) {
+        clients.emplace_back([&]() {
+            for (int r = 0; r < 50; ++r) {
+                scheduler.parallelFor(0, 10, 1,
+                        [&](uint64_t begin, uint64_t end, ScratchArena&) {
+                    scheduler.parallelFor(0, 10 * (end - begin), 3,
+                            [&](uint64_t b, uint64_t e, ScratchArena&) {
+                        sum += e - b;
+                    });
+                });
+            }
+        });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    EXPECT_EQ(8 * 50 * 100, sum.load());
+}
+
+TEST(TaskScheduler, Exception) {
+    TaskScheduler scheduler(2);
+    std::atomic<int> calls { 0 };
+    EXPECT_THROW(scheduler.parallelFor(0, 1000, 1,
+            [&](uint64_t begin, uint64_t, ScratchArena&) {
+        calls++;
+        if (begin == 500) {
+            throw new std::runtime_error("Failed");
+        }
+    }), std::runtime_error*);
+    EXPECT_LE(calls.load(), 1000);
+
+    // Still usable.
+    std::atomic<uint64_t> items { 0 };
+    scheduler.parallelFor(0, 1000, 10,
+            [&](uint64_t begin, uint64_t end, ScratchArena&) {
+        items += end - begin;
+    });
+    EXPECT_EQ(1000, items.load());
+}
+
+TEST(TaskScheduler, WithScheduler) {
+    TaskScheduler shared(2);
+    EXPECT_EQ(&shared, withScheduler(&shared, [](TaskScheduler& workers) {
+        return &workers;
+    }));
+    EXPECT_EQ(3, withScheduler(nullptr, [&](TaskScheduler& workers) {
+        EXPECT_NE(&shared, &workers);
+        return workers.getThreads();
+    }, 3));
+}
+
+TEST(TaskScheduler, PinnedToNumaNodes) {
+    TaskScheduler scheduler(4, true);
+    std::vector<std::atomic<int>> nodes(MAX_NUMA_NODES);
+    scheduler.parallelFor(0, 1000, 1, [&](uint64_t, uint64_t, ScratchArena&) {
+        nodes[getThreadNumaNode()]++;
+    });
+    int tasks = 0;
+    for (uint32_t node = 0; node < MAX_NUMA_NODES; ++node) {
+        if (nodes[node].load()) {
+            EXPECT_FALSE(getNumaNodeCpus(node).empty());
+        }
+        tasks += nodes[node].load();
+    }
+    EXPECT_EQ(1000, tasks);
+}
+
+// The calculators give the same results on a shared scheduler as on their
+// own threads.
+TEST(TaskScheduler, SharedByCalculators) {
+    TaskScheduler scheduler(3);
+    EquityCalculator calc( { HoleCards(_AC, _AD), HoleCards(_KH, _KS) },
+            CardSet( { _2C, _7D, _9H }));
+    calc.setSeed(3);
+    calc.setMaxTrials(30000);
+    EquityResult sampled = calc.calculate();
+    EquityResult enumerated = calc.enumerate();
+    calc.setScheduler(&scheduler);
+    EXPECT_EQ(sampled.players[0].equity, calc.calculate().players[0].equity);
+    EXPECT_EQ(enumerated.players[0].equity,
+            calc.enumerate().players[0].equity);
+
+    RangeEquityCalculator range_calc( { Range::parse("QQ+"), Range::parse(
+            "AKs, 76s") }, CardSet( { _2C, _7D, _9H }));
+    EquityResult range_enumerated = range_calc.enumerate();
+    range_calc.setScheduler(&scheduler);
+    EquityResult shared = range_calc.enumerate();
+    EXPECT_EQ(range_enumerated.trials, shared.trials);
+    EXPECT_NEAR(range_enumerated.players[0].equity, shared.players[0].equity,
+            1e-12);
+}
+
+} /* namespace poker */